@@ -1,4 +1,6 @@
+#include <cctype>
 #include <iostream>
+#include <string>
 #include <vector> // Required for std::vector<Sprite>
 #include "Engine.h"
 #include "spdlog/spdlog.h"
@@ -16,12 +18,59 @@ static const std::vector<int> ALL_MONITORED_KEYS = {
     // Add any other specific keycodes here
 };
 
-int main() {
+// Command line:
+//   --headless [ticks]  Simulate without window, GPU or audio, as fast as possible (no count: until QuitGame)
+//   --input <file>      Inject input from a script of "<tick> <key> <down|up>" lines
+//   --dynamic-resolution [ms]  Scale the render resolution to hold the GPU frame time (default 14 ms)
+//   --audio-backend <auto|miniaudio|null>  Audio driver; null mixes into memory (implied by --headless)
+//   --audio-buffer <frames>  Audio buffer size, smaller for lower latency (default: the backend's)
+//   --audio-rate <hz>  Audio sample rate (default: the backend's)
+int main(int argc, char** argv) {
+    enDjinn::EngineConfig config;
+    uint64_t headless_ticks = 0;
+    std::string input_script;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless") {
+            config.headless = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                headless_ticks = std::stoull(argv[++i]);
+            }
+        }
+        else if (arg == "--input" && i + 1 < argc) {
+            input_script = argv[++i];
+        }
+        else if (arg == "--dynamic-resolution") {
+            config.dynamicResolution = true;
+            if (i + 1 < argc && std::isdigit(static_cast<unsigned char>(argv[i + 1][0]))) {
+                config.targetGpuFrameMs = std::stof(argv[++i]);
+            }
+        }
+        else if (arg == "--audio-backend" && i + 1 < argc) {
+            std::string backend = argv[++i];
+            if (backend == "miniaudio") config.audio.backend = enDjinn::AudioBackend::Miniaudio;
+            else if (backend == "null") config.audio.backend = enDjinn::AudioBackend::Null;
+            else if (backend != "auto") spdlog::warn("Unknown audio backend '{}', using auto.", backend);
+        }
+        else if (arg == "--audio-buffer" && i + 1 < argc) {
+            config.audio.bufferSize = static_cast<unsigned int>(std::stoul(argv[++i]));
+        }
+        else if (arg == "--audio-rate" && i + 1 < argc) {
+            config.audio.sampleRate = static_cast<unsigned int>(std::stoul(argv[++i]));
+        }
+        else {
+            spdlog::warn("Unknown argument '{}'.", arg);
+        }
+    }
+
     enDjinn::Engine engine;
-    engine.Startup();
+    engine.Startup(config);
 
     // The script manager is now updated inside the game loop.
     auto* input_manager = engine.GetInputManager();
+    if (input_manager && !input_script.empty()) {
+        input_manager->LoadInputScript(input_script);
+    }
 
     sol::state& lua_state = engine.GetScriptManager()->GetLuaState();
 
@@ -33,14 +82,19 @@ int main() {
         return 1;
     }
 
-
-    engine.RunGameLoop([&]() {
-
-        const float dt_fixed = 1.0f / 60.0f;
-        sol::protected_function_result result = master_update_func(dt_fixed);
-        engine.GetGraphicsManager()->Draw();
-        });
+    const float dt_fixed = static_cast<float>(enDjinn::Engine::SECONDS_PER_TICK);
+    if (engine.IsHeadless()) {
+        engine.RunHeadless([&]() {
+            master_update_func(dt_fixed);
+            }, headless_ticks);
+    }
+    else {
+        engine.RunGameLoop([&]() {
+            sol::protected_function_result result = master_update_func(dt_fixed);
+            engine.GetGraphicsManager()->Draw();
+            });
+    }
 
     engine.Shutdown();
     return 0;
-}
\ No newline at end of file
+}
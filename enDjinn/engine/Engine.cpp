@@ -5,8 +5,16 @@
 #include "GLFW/glfw3.h"
 #include <chrono>
 #include <thread>
+#include "utils/TaskGraph.h"
+#include "utils/ThreadPool.h"
+#include "utils/Stats.h"
+#include "utils/FrameArena.h"
+#include "utils/Log.h"
 
 namespace enDjinn {
+	// Batch the startup scripts load; decoded ahead of time while the GPU device is acquired
+    static constexpr const char* STARTUP_MANIFEST = "main.manifest";
+
 	// Constructor. Sets up unique pointers for various managers as needed
     Engine::Engine()
         : m_graphicsManager(std::make_unique<GraphicsManager>())
@@ -15,109 +23,144 @@ namespace enDjinn {
         , m_soundManager(nullptr)
         , m_scriptManager(nullptr)
     {
+        // Logging goes through a background thread from here on
+        Log::Startup();
     }
 	// Destructor
     Engine::~Engine() = default;
 
-	// Startup method implementation
-    void Engine::Startup() {
-		// Initialize GraphicsManager and set window size/title
-        m_graphicsManager->Startup(1280, 720, "enDjinn", false);
-
-		// Initialize ResourceManager, SoundManager, InputManager, and ScriptManager
-        GLFWwindow* window = m_graphicsManager->GetWindow();
-        if (m_resourceManager) {
-            m_resourceManager->SetAssetRoot("../../../engine/assets");
-            m_soundManager = std::make_unique<SoundManager>(*m_resourceManager);
-            m_soundManager->Startup();
-            m_graphicsManager->SetResourceManager(m_resourceManager.get());
-        }
-        else {
+	// Startup method implementation.
+	// Startup is a dependency graph: GPU device acquisition, audio device init, Lua setup and bytecode load,
+	// and decoding of the startup assets all overlap. Only the GLFW stages are pinned to the main thread.
+	// Headless runs keep the same graph but skip the window, device and image stages; audio runs on the null backend.
+    void Engine::Startup(const EngineConfig& config) {
+        TaskGraph startup;
+        using Affinity = TaskGraph::Affinity;
+        m_config = config;
+        const bool headless = config.headless;
+
+        if (!m_resourceManager) {
             spdlog::error("ResourceManager not initialized, SoundManager will be unusable.");
+            return;
         }
-
-		// Initialize InputManager and ScriptManager if window is valid
-        if (window) {
-			// Initialize InputManager with the GLFW window
-            m_inputManager = std::make_unique<InputManager>(window);
-
-			// Initialize ScriptManager and expose other managers to Lua
+        m_graphicsManager->SetResourceManager(m_resourceManager.get());
+        m_resourceManager->SetHeadless(headless);
+
+		// 1. Window and surface (main thread), then adapter, device and pipelines (worker)
+        TaskGraph::TaskId window = startup.Add("window", [this, headless]() {
+            if (headless) return true;
+            return m_graphicsManager->CreateWindowAndSurface(1280, 720, "enDjinn", false);
+            }, {}, Affinity::MainThread);
+
+        TaskGraph::TaskId device = startup.Add("gpu device", [this, headless]() {
+            if (headless) return true;
+            if (!m_graphicsManager->InitializeDevice()) return false;
+            if (m_config.dynamicResolution) m_graphicsManager->SetDynamicResolution(true, m_config.targetGpuFrameMs);
+            // Encode and present on a dedicated thread while the next tick simulates (falls back to inline rendering)
+            m_graphicsManager->StartRenderThread(2);
+            return true;
+            }, { window });
+
+		// 2. Asset root and cooked pack, which everything that reads assets depends on
+        TaskGraph::TaskId pack = startup.Add("asset pack", [this]() {
+            m_resourceManager->SetAssetRoot("../../../engine/assets");
+            // Use the cooked pack when asset_cooker has produced one; otherwise everything loads from loose files
+            m_resourceManager->LoadPack("assets.pak");
+            return true;
+            });
+
+		// 3. Audio device. A failure here only leaves the game silent, as before.
+		// Headless runs mix on the null backend, so sounds load and play, deterministically and silently.
+        TaskGraph::TaskId audio = startup.Add("audio", [this, headless]() {
+            m_soundManager = std::make_unique<SoundManager>(*m_resourceManager);
+            AudioConfig audioConfig = m_config.audio;
+            if (headless) audioConfig.backend = AudioBackend::Null; // Deterministic, and no device needed
+            m_soundManager->Startup(audioConfig);
+            m_resourceManager->SetSoundManager(m_soundManager.get());
+            return true;
+            });
+
+		// 4. Decode the startup assets while the device is still being acquired; the upload happens when the scripts load them
+        TaskGraph::TaskId prefetch = startup.Add("asset prefetch", [this, headless]() {
+            if (!headless) m_resourceManager->PrefetchBatch(STARTUP_MANIFEST);
+            return true;
+            }, { pack });
+
+		// 5. Lua state and script compilation (bytecode from the pack when available)
+        TaskGraph::TaskId lua = startup.Add("lua", [this]() {
             m_scriptManager = std::make_unique<ScriptManager>();
             m_scriptManager->Startup();
+            bool scriptLoaded = LoadEngineScript("main_script", "scripts/main_script.lua");
+            bool ECSLoaded = LoadEngineScript("ECS", "scripts/ecs.lua");
+            // Other scripts can be loaded here as needed
+            return scriptLoaded && ECSLoaded;
+            }, { pack });
+
+		// 6. Input and the Lua bindings. InputManager installs GLFW callbacks, so this stays on the main thread.
+		// Without a window (headless) the InputManager only reports injected keys.
+        TaskGraph::TaskId bindings = startup.Add("bindings", [this]() {
+            GLFWwindow* window = m_graphicsManager->GetWindow();
+            m_inputManager = std::make_unique<InputManager>(window);
 
 			// Link ScriptManager to GraphicsManager before exposure (Can be moved)
-			m_graphicsManager->SetScriptManager(m_scriptManager.get());
+            m_graphicsManager->SetScriptManager(m_scriptManager.get());
 
-            // --- BINDING FIX ---
             m_scriptManager->ExposeInputManager(m_inputManager.get());
             m_scriptManager->ExposeResourceManager(m_resourceManager.get());
             m_scriptManager->ExposeSoundManager(m_soundManager.get());
+            m_scriptManager->ExposeSwarmSystem(m_graphicsManager->GetSwarmSystem());
+            m_scriptManager->ExposeAnimationSystem(m_graphicsManager->GetAnimationSystem(), m_resourceManager.get());
+            m_scriptManager->ExposeTilemapSystem(m_graphicsManager->GetTilemapSystem());
+            m_scriptManager->ExposeParticleSystem(m_graphicsManager->GetParticleSystem());
+            m_scriptManager->ExposeTextSystem(m_graphicsManager->GetTextSystem(), m_resourceManager.get());
+            m_scriptManager->ExposeCollisionSystem(&m_collisionSystem);
+            m_scriptManager->ExposeWorldSnapshots(m_resourceManager.get());
+            m_scriptManager->ExposeStats();
+            m_scriptManager->ExposeCoroutines();
+            m_scriptManager->ExposeScriptShards(m_resourceManager.get());
 
-			// Load Scripts: ECS first, then main_script
-            bool scriptLoaded = m_scriptManager->LoadScript(
-                "main_script",
-                m_resourceManager->ResolvePath("scripts/main_script.lua").generic_string()
-            );
-
-            bool ECSLoaded = m_scriptManager->LoadScript(
-                "ECS",
-                m_resourceManager->ResolvePath("scripts/ecs.lua").generic_string()
-            );
-
-			// Other scripts can be loaded here as needed
+			// Bind the QuitGame function to Lua
+            m_scriptManager->GetLuaState().set_function("QuitGame", [this]() {
+                this->QuitGame();
+                });
+            return true;
+            }, { window, audio, lua }, Affinity::MainThread);
 
-			// Execute the loaded scripts
+		// 7. Execute the scripts. The setup script loads assets, so it needs the device and the prefetch.
+        startup.Add("run scripts", [this]() {
             sol::protected_function* setup_chunk = m_scriptManager->GetScript("main_script");
             sol::protected_function* ecs_chunk = m_scriptManager->GetScript("ECS");
+            if (!setup_chunk || !ecs_chunk) return false;
 
 			// Execute ECS script first to define ECS table, then main script
 			// THIS ORDER IS CRUCIAL. Main script depends on ECS being defined.
-            if (setup_chunk && ecs_chunk) {
-                // 1. EXECUTE THE ECS SCRIPT FIRST
-                sol::protected_function_result ecs_result = (*ecs_chunk)();
-
-				// Check for errors during ECS script execution
-                if (!ecs_result.valid()) {
-                    sol::error err = ecs_result;
-                    spdlog::error("Lua Runtime Error during ECS script execution: {}", err.what());
-                    // Handle critical failure
-                    return;
-                }
-                else {
-                    spdlog::info("ECS script executed successfully, ECS table is now defined.");
-                }
-
-                // 2. NOW EXECUTE THE MAIN SCRIPT
-                sol::protected_function_result result = (*setup_chunk)();
-
-				// Check for errors during main script execution
-                if (!result.valid()) {
-                    sol::error err = result;
-                    spdlog::error("Lua Runtime Error during SETUP script execution: {}", err.what());
-                    // Handle critical failure
-                    return;
-                }
-                else {
-                    spdlog::info("Successfully executed setup script once.");
-                }
+            sol::protected_function_result ecs_result = (*ecs_chunk)();
+            if (!ecs_result.valid()) {
+                sol::error err = ecs_result;
+                spdlog::error("Lua Runtime Error during ECS script execution: {}", err.what());
+                return false;
             }
-			// --- END SCRIPT LOADING AND EXECUTION ---
-            sol::state& lua = m_scriptManager->GetLuaState();
+            spdlog::info("ECS script executed successfully, ECS table is now defined.");
 
-			// Bind the QuitGame function to Lua
-            lua.set_function("QuitGame", [this]() {
-                this->QuitGame();
-                });
-        }
-        else {
-            spdlog::error("GraphicsManager failed to create a window, InputManager will be unusable.");
+            sol::protected_function_result result = (*setup_chunk)();
+            if (!result.valid()) {
+                sol::error err = result;
+                spdlog::error("Lua Runtime Error during SETUP script execution: {}", err.what());
+                return false;
+            }
+            spdlog::info("Successfully executed setup script once.");
+            return true;
+            }, { bindings, device, prefetch }, Affinity::MainThread);
 
+		// 8. Run the graph and report where the time went
+        if (!startup.Run(ThreadPool::Get())) {
+            spdlog::error("Engine startup did not complete; see the errors above.");
         }
+        startup.LogTimings("Engine startup");
 
-        // Startup SoundManager if ResourceManager is started up
         stm_setup();
         m_lastTime = stm_now(); // Initialize the starting time
-        spdlog::info("Engine started up.");
+        spdlog::info("Engine started up{}.", headless ? " (headless)" : "");
     }
 
 	//  Shutdown method implementation
@@ -127,12 +170,12 @@ namespace enDjinn {
         }
         m_graphicsManager->Shutdown();
         spdlog::info("Engine shut down.");
+        Log::Shutdown();
     }
 
 	// Responsive game loop implementation
     void Engine::RunGameLoop(const UpdateCallback& update_callback) {
-        // We will run our game logic at a fixed 60 ticks per second.
-        const double SECONDS_PER_TICK = 1.0 / 60.0;
+        // We will run our game logic at a fixed 60 ticks per second (SECONDS_PER_TICK).
 
         // An "accumulator" to track how much real time has passed that we haven't simulated yet.
         double accumulated_time_s = 0.0;
@@ -142,7 +185,7 @@ namespace enDjinn {
         auto last_time = std::chrono::steady_clock::now();
 
         spdlog::info("Entering responsive game loop (using std::chrono).");
-        while (!m_graphicsManager->ShouldClose()) {
+        while (!m_quitRequested && !m_graphicsManager->ShouldClose()) {
             // 1. Calculate Delta Time
             auto current_time = std::chrono::steady_clock::now();
             // The duration is a special type; .count() gives us the value in seconds (because we specified <double>).
@@ -158,7 +201,7 @@ namespace enDjinn {
 			// 3. Fixed frame rate update loop
             // This loop ensures your game logic runs at a consistent rate.
             while (accumulated_time_s >= SECONDS_PER_TICK) {
-                update_callback();
+                Tick(update_callback);
                 accumulated_time_s -= SECONDS_PER_TICK;
             }
         }
@@ -166,6 +209,69 @@ namespace enDjinn {
         spdlog::info("Game loop terminated.");
     }
 
+	// Headless loop implementation. Each iteration is exactly one fixed tick; nothing waits on the clock.
+    uint64_t Engine::RunHeadless(const UpdateCallback& update_callback, uint64_t tickCount) {
+        if (!m_config.headless) {
+            spdlog::error("RunHeadless requires an engine started with EngineConfig::headless.");
+            return 0;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        uint64_t ticks = 0;
+        if (tickCount) spdlog::info("Entering headless loop for {} ticks.", tickCount);
+        else spdlog::info("Entering headless loop (runs until QuitGame).");
+        while (!m_quitRequested && (tickCount == 0 || ticks < tickCount)) {
+            Tick(update_callback);
+            ++ticks;
+        }
+
+        const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        const double simulated_s = ticks * SECONDS_PER_TICK;
+        spdlog::info("Headless loop simulated {} ticks ({:.1f} s of game time) in {:.3f} s, {:.1f}x real time.",
+            ticks, simulated_s, wall_s, wall_s > 0.0 ? simulated_s / wall_s : 0.0);
+        return ticks;
+    }
+
+	// One fixed simulation step, shared by both loops
+    void Engine::Tick(const UpdateCallback& update_callback) {
+        // Temporaries from two ticks ago are done with
+        FrameArena::Get().BeginFrame();
+
+        // Scripted input first, then native systems, so their events reach Lua within the same tick
+        if (m_inputManager) m_inputManager->AdvanceTick(m_tick);
+        m_graphicsManager->GetSwarmSystem()->Tick(static_cast<float>(SECONDS_PER_TICK));
+        m_graphicsManager->GetAnimationSystem()->Tick(static_cast<float>(SECONDS_PER_TICK));
+        m_graphicsManager->GetParticleSystem()->Tick(static_cast<float>(SECONDS_PER_TICK));
+        // Collision sees the positions the previous tick's scripts left behind
+        if (m_scriptManager) m_scriptManager->SyncColliders(m_collisionSystem);
+        m_collisionSystem.Step();
+        // Coroutines whose wait ended; the rest cost nothing this tick
+        if (m_scriptManager) m_scriptManager->UpdateCoroutines(SECONDS_PER_TICK);
+
+        // Sharded entity scripts run on the pool alongside the main update and are merged before the tick ends
+        if (m_scriptManager) m_scriptManager->DispatchShards(static_cast<float>(SECONDS_PER_TICK));
+        const auto start = std::chrono::steady_clock::now();
+        update_callback();
+        if (m_scriptManager) m_scriptManager->MergeShards();
+        Stats& stats = Stats::Get();
+        stats.Set("sim.tick_ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        // Without a device nothing else pulls audio, so the null backend mixes this tick's share here (audio.mix_ms)
+        if (m_soundManager) m_soundManager->AdvanceOffline(SECONDS_PER_TICK);
+
+        // The callback draws once per tick, so a tick is also a stats frame
+        stats.EndFrame();
+        ++m_tick;
+    }
+
+	// Loads a script from the cooked pack as bytecode when available, otherwise compiles the loose file
+    bool Engine::LoadEngineScript(const std::string& name, const std::string& partialPath) {
+        if (const PackedAsset* packed = m_resourceManager->FindPackedAsset(partialPath, PackAssetType::Script)) {
+            std::string_view bytecode(reinterpret_cast<const char*>(packed->data), packed->size);
+            return m_scriptManager->LoadScriptBuffer(name, bytecode, "@" + partialPath);
+        }
+        return m_scriptManager->LoadScript(name, m_resourceManager->ResolvePath(partialPath).generic_string());
+    }
+
 	// Getter methods for various managers
     GraphicsManager* Engine::GetGraphicsManager() const {
         return m_graphicsManager.get();
@@ -189,8 +295,12 @@ namespace enDjinn {
 
 	// QuitGame method implementation
     void Engine::QuitGame() {
+        m_quitRequested = true;
         GLFWwindow* window = m_graphicsManager->GetWindow();
-        if (window) {
+        if (m_config.headless) {
+            spdlog::info("QuitGame() called from Lua. Ending the headless run.");
+        }
+        else if (window) {
             spdlog::info("QuitGame() called from Lua. Setting window close flag.");
             // This is the CRITICAL line: it tells GLFW the window should close.
             glfwSetWindowShouldClose(window, GLFW_TRUE);
@@ -14,15 +14,34 @@ namespace enDjinn {
 
     typedef std::function<void()> UpdateCallback;
 
+    struct EngineConfig {
+        // No window, GPU or audio device: only input, Lua, the ECS and the in-memory audio mixer run. Drive it with RunHeadless.
+        bool headless = false;
+        // Render offscreen at a scale that keeps the GPU frame time near targetGpuFrameMs, then upscale
+        bool dynamicResolution = false;
+        float targetGpuFrameMs = 14.0f;
+        // Audio device settings. Headless runs always use the null backend, which mixes once per tick into memory.
+        AudioConfig audio;
+    };
+
     class Engine {
     public:
         Engine();
         ~Engine();
 
-        void Startup();
+        // Fixed simulation step, in windowed and headless runs alike
+        static constexpr double SECONDS_PER_TICK = 1.0 / 60.0;
+
+        void Startup(const EngineConfig& config = {});
         void RunGameLoop(const UpdateCallback& callback);
+        // Runs ticks back to back with no wall-clock pacing, for tickCount ticks or (0) until QuitGame.
+        // Returns the number of ticks simulated.
+        uint64_t RunHeadless(const UpdateCallback& callback, uint64_t tickCount = 0);
         void Shutdown();
 
+        bool IsHeadless() const { return m_config.headless; }
+        uint64_t GetTickCount() const { return m_tick; }
+
         float GetDeltaTime() const { return m_deltaTime; }
 
         GraphicsManager* GetGraphicsManager() const;
@@ -30,9 +49,17 @@ namespace enDjinn {
         ResourceManager* GetResourceManager() const;
         SoundManager* GetSoundManager() const;
         ScriptManager* GetScriptManager() const;
+        CollisionSystem* GetCollisionSystem() { return &m_collisionSystem; }
         void QuitGame();
 
     private:
+        bool LoadEngineScript(const std::string& name, const std::string& partialPath);
+        void Tick(const UpdateCallback& callback);
+
+        EngineConfig m_config;
+        uint64_t m_tick = 0; // Simulation ticks since startup
+        bool m_quitRequested = false;
+
         float m_deltaTime = 0.0f; // Stores the time between the last two frames (in seconds)
         uint64_t m_lastTime = 0;
 
@@ -41,6 +68,8 @@ namespace enDjinn {
         std::unique_ptr<ResourceManager> m_resourceManager;
         std::unique_ptr<SoundManager> m_soundManager;
 		std::unique_ptr<ScriptManager> m_scriptManager;
+        // Declared after the ScriptManager so it is destroyed first: its contact callback holds a Lua function
+        CollisionSystem m_collisionSystem;
     };
 
 } // namespace enDjinn
\ No newline at end of file
@@ -0,0 +1,166 @@
+#include "AssetPack.h"
+#include "spdlog/spdlog.h"
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace enDjinn {
+
+    AssetPack::~AssetPack() {
+        Close();
+    }
+
+	// Open method implementation. Maps the whole file read-only and builds the name index.
+    bool AssetPack::Open(const std::filesystem::path& path) {
+        Close();
+
+#ifdef _WIN32
+        HANDLE file = CreateFileW(path.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        LARGE_INTEGER fileSize{};
+        GetFileSizeEx(file, &fileSize);
+        HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping) {
+            spdlog::error("AssetPack: Failed to create a file mapping for '{}'.", path.string());
+            CloseHandle(file);
+            return false;
+        }
+
+        const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        if (!view) {
+            spdlog::error("AssetPack: Failed to map '{}'.", path.string());
+            CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_fileHandle = file;
+        m_mappingHandle = mapping;
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        struct stat st {};
+        if (fstat(fd, &st) != 0 || st.st_size == 0) {
+            spdlog::error("AssetPack: Failed to stat '{}'.", path.string());
+            close(fd);
+            return false;
+        }
+
+        void* view = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        // The mapping keeps its own reference to the file.
+        close(fd);
+        if (view == MAP_FAILED) {
+            spdlog::error("AssetPack: Failed to map '{}'.", path.string());
+            return false;
+        }
+
+        m_data = static_cast<const uint8_t*>(view);
+        m_size = static_cast<size_t>(st.st_size);
+#endif
+
+        if (!BuildIndex(path)) {
+            Close();
+            return false;
+        }
+
+        spdlog::info("AssetPack: Mapped '{}' ({} assets, {} bytes).", path.string(), m_index.size(), m_size);
+        return true;
+    }
+
+	// Close method implementation. Unmaps the file, invalidating every PackedAsset pointer.
+    void AssetPack::Close() {
+        m_index.clear();
+        if (!m_data) return;
+
+#ifdef _WIN32
+        UnmapViewOfFile(m_data);
+        CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+        CloseHandle(static_cast<HANDLE>(m_fileHandle));
+        m_mappingHandle = nullptr;
+        m_fileHandle = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+        m_data = nullptr;
+        m_size = 0;
+    }
+
+	// BuildIndex method implementation. Validates the header and every entry against the file size.
+    bool AssetPack::BuildIndex(const std::filesystem::path& path) {
+        if (m_size < sizeof(PackHeader)) {
+            spdlog::error("AssetPack: '{}' is too small to be a pack file.", path.string());
+            return false;
+        }
+
+        PackHeader header;
+        std::memcpy(&header, m_data, sizeof(PackHeader));
+        if (header.magic != PACK_MAGIC || header.version != PACK_VERSION) {
+            spdlog::error("AssetPack: '{}' has a bad magic or version ({}), re-run asset_cooker.", path.string(), header.version);
+            return false;
+        }
+
+        const uint64_t entriesEnd = sizeof(PackHeader) + uint64_t(header.entryCount) * sizeof(PackEntry);
+        const uint64_t stringsEnd = entriesEnd + header.stringTableSize;
+        if (stringsEnd > m_size) {
+            spdlog::error("AssetPack: '{}' is truncated.", path.string());
+            return false;
+        }
+
+        const char* strings = reinterpret_cast<const char*>(m_data + entriesEnd);
+        m_index.reserve(header.entryCount);
+
+        for (uint32_t i = 0; i < header.entryCount; ++i) {
+            PackEntry entry;
+            std::memcpy(&entry, m_data + sizeof(PackHeader) + uint64_t(i) * sizeof(PackEntry), sizeof(PackEntry));
+
+            // Written so that no sum can wrap on a corrupt or hostile pack
+            if (uint64_t(entry.nameOffset) + entry.nameLength > header.stringTableSize ||
+                entry.dataSize > m_size || entry.dataOffset > m_size - entry.dataSize) {
+                spdlog::error("AssetPack: Entry {} in '{}' points outside the file.", i, path.string());
+                return false;
+            }
+
+            PackedAsset asset;
+            asset.type = static_cast<PackAssetType>(entry.type);
+            asset.data = m_data + entry.dataOffset;
+            asset.size = entry.dataSize;
+            asset.width = entry.width;
+            asset.height = entry.height;
+            asset.mipCount = entry.mipCount;
+
+            m_index.emplace(std::string(strings + entry.nameOffset, entry.nameLength), asset);
+        }
+        return true;
+    }
+
+	// Find method implementation
+    const PackedAsset* AssetPack::Find(const std::string& partialPath) const {
+        if (m_index.empty()) return nullptr;
+
+        auto it = m_index.find(MakeKey(partialPath));
+        return it == m_index.end() ? nullptr : &it->second;
+    }
+
+	// MakeKey method implementation. The cooker uses the same function, so both sides agree on keys.
+    std::string AssetPack::MakeKey(const std::string& partialPath) {
+        return std::filesystem::path(partialPath).lexically_normal().generic_string();
+    }
+
+} // namespace enDjinn
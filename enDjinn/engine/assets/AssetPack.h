@@ -0,0 +1,94 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <filesystem>
+#include <unordered_map>
+
+namespace enDjinn {
+
+    // --- Cooked asset pack format ---
+    // Written offline by the asset_cooker tool, read at runtime by ResourceManager.
+    // Layout: [PackHeader][PackEntry * entryCount][string table][payloads...]
+    // Every payload starts on a PACK_ALIGNMENT boundary so it can be used straight from the mapping.
+    constexpr uint32_t PACK_MAGIC = 0x4B504A45; // "EJPK" in little endian
+    constexpr uint32_t PACK_VERSION = 1;
+    constexpr uint64_t PACK_ALIGNMENT = 16;
+
+    enum class PackAssetType : uint32_t {
+        Image = 1,  // RGBA8 sRGB pixels, full mip chain from largest to smallest, tightly packed
+        Sound = 2,  // 32-bit float PCM, channels stored one after another (SoLoud's layout)
+        Script = 3, // Precompiled Lua bytecode (lua_dump output)
+    };
+
+    struct PackHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t stringTableSize;
+    };
+
+    struct PackEntry {
+        uint32_t type;       // PackAssetType
+        uint32_t nameOffset; // Offset of the asset's partial path inside the string table
+        uint32_t nameLength;
+        uint32_t mipCount;   // Image: number of mip levels. Unused otherwise.
+        uint64_t dataOffset; // Absolute offset from the start of the file
+        uint64_t dataSize;
+        uint32_t width;      // Image: width of mip 0. Sound: channel count.
+        uint32_t height;     // Image: height of mip 0. Sound: sample rate.
+    };
+    static_assert(sizeof(PackHeader) == 16, "PackHeader layout is part of the file format");
+    static_assert(sizeof(PackEntry) == 40, "PackEntry layout is part of the file format");
+
+	// Size in bytes of one RGBA8 mip level
+    inline uint64_t PackMipSize(uint32_t width, uint32_t height, uint32_t level) {
+        uint64_t w = std::max<uint32_t>(1u, width >> level);
+        uint64_t h = std::max<uint32_t>(1u, height >> level);
+        return w * h * 4;
+    }
+
+	// A view of one asset inside a mapped pack. The pointer stays valid while the pack is open.
+    struct PackedAsset {
+        PackAssetType type;
+        const uint8_t* data = nullptr;
+        uint64_t size = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t mipCount = 0;
+    };
+
+	// Read-only, memory-mapped view of a cooked pack file
+    class AssetPack {
+    public:
+        AssetPack() = default;
+        ~AssetPack();
+
+        AssetPack(const AssetPack&) = delete;
+        AssetPack& operator=(const AssetPack&) = delete;
+
+        bool Open(const std::filesystem::path& path);
+        void Close();
+        bool IsOpen() const { return m_data != nullptr; }
+
+		// Looks up an asset by the same partial path the loose-file loaders use (e.g. "sprites/bg.jpg")
+        const PackedAsset* Find(const std::string& partialPath) const;
+        size_t GetEntryCount() const { return m_index.size(); }
+
+		// Normalizes a partial path into the key format used by the pack index
+        static std::string MakeKey(const std::string& partialPath);
+
+    private:
+        bool BuildIndex(const std::filesystem::path& path);
+
+        const uint8_t* m_data = nullptr;
+        size_t m_size = 0;
+#ifdef _WIN32
+        void* m_fileHandle = nullptr;
+        void* m_mappingHandle = nullptr;
+#endif
+        std::unordered_map<std::string, PackedAsset> m_index;
+    };
+
+} // namespace enDjinn
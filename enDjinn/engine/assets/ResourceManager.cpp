@@ -2,6 +2,18 @@
 #include "./managers/GraphicsManager.h"
 #include "spdlog/spdlog.h"
 #include <cstddef> // For offsetof, if needed later
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <future>
+#include <iterator>
+#include <sstream>
+#include <unordered_set>
+#include "./managers/SoundManager.h"
+#include "./utils/ThreadPool.h"
+#include "./utils/Stats.h"
+#include "./utils/Log.h"
 
 // --- STB_IMAGE Implementation ---
 #define STB_IMAGE_IMPLEMENTATION
@@ -13,6 +25,40 @@ template< typename T > constexpr const T* to_ptr(const T& val) { return &val; }
 
 namespace enDjinn {
 
+    namespace {
+        constexpr uint64_t RELOAD_RETRY_FRAMES = 300; // How long a texture that failed to reload waits before the next try
+
+        std::string LowerExtension(const std::string& partialPath) {
+            std::string ext = std::filesystem::path(partialPath).extension().string();
+            for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+            return ext;
+        }
+
+		// Matches a file name against a pattern where '*' is any run of characters and '?' is one character
+        bool WildcardMatch(const std::string& pattern, const std::string& text) {
+            size_t p = 0, t = 0, starP = std::string::npos, starT = 0;
+            while (t < text.size()) {
+                if (p < pattern.size() && (pattern[p] == '?' || pattern[p] == text[t])) {
+                    ++p;
+                    ++t;
+                }
+                else if (p < pattern.size() && pattern[p] == '*') {
+                    starP = p++;
+                    starT = t;
+                }
+                else if (starP != std::string::npos) {
+                    p = starP + 1;
+                    t = ++starT;
+                }
+                else {
+                    return false;
+                }
+            }
+            while (p < pattern.size() && pattern[p] == '*') ++p;
+            return p == pattern.size();
+        }
+    }
+
     ResourceManager::ResourceManager(GraphicsManager* gm)
         : m_graphicsManager(gm), // Initialize the new member
         m_assetRoot("assets")
@@ -22,6 +68,10 @@ namespace enDjinn {
 
     ResourceManager::~ResourceManager() {
         // The map destructor will automatically call the Texture destructor for every element.
+        // Prefetched images that were never loaded still own their pixels.
+        for (auto& [path, image] : m_prefetched) {
+            FreeDecodedImage(image);
+        }
     }
 
 
@@ -41,9 +91,27 @@ namespace enDjinn {
 		// Note: This was needed due to the nature of Visual Studio. However, it may still be useful for flexibility.
     }
 
+    // --- Cooked Pack Logic ---
+
+    bool ResourceManager::LoadPack(const std::string& partialPath) {
+        std::filesystem::path fullPath = ResolvePath(partialPath);
+        if (!std::filesystem::exists(fullPath)) {
+            spdlog::info("ResourceManager: No cooked pack at '{}', loading loose files.", fullPath.generic_string());
+            return false;
+        }
+        return m_pack.Open(fullPath);
+    }
+
+    const PackedAsset* ResourceManager::FindPackedAsset(const std::string& partialPath, PackAssetType type) const {
+        const PackedAsset* asset = m_pack.Find(partialPath);
+        return (asset && asset->type == type) ? asset : nullptr;
+    }
+
     // --- Texture Loading Logic ---
 
     bool ResourceManager::LoadTexture(const std::string& name, const std::string& partialPath) {
+        if (m_headless) return false;
+
 		// Validation of graphics context
         if (!m_graphicsManager || !m_graphicsManager->GetDevice() || !m_graphicsManager->GetQueue()) {
             spdlog::error("ResourceManager: Graphics context not initialized.");
@@ -56,7 +124,97 @@ namespace enDjinn {
             return true;
         }
 
-        // 1. Resolve path and load data from disk
+        // 1. Get the pixels, from a prefetch, the cooked pack or by decoding the file
+        DecodedImage image;
+        if (!TakePrefetched(partialPath, image) && !DecodeImage(partialPath, image)) {
+            return false;
+        }
+
+        // 2. Create the GPU texture and upload every level
+        WGPUTexture tex = CreateGPUTexture(partialPath, image.width, image.height, image.mipCount);
+        if (tex) {
+            UploadTextureLevels(tex, image);
+            RegisterTexture(name, partialPath, image, tex);
+        }
+
+        // 3. Free CPU memory
+        FreeDecodedImage(image);
+        return tex != nullptr;
+    }
+
+    bool ResourceManager::CreateTextureFromPixels(const std::string& name, uint32_t width, uint32_t height, const uint8_t* pixels) {
+        if (m_headless) return false;
+
+        if (!m_graphicsManager || !m_graphicsManager->GetDevice() || !m_graphicsManager->GetQueue()) {
+            spdlog::error("ResourceManager: Graphics context not initialized.");
+            return false;
+        }
+        if (m_textures.count(name)) {
+            spdlog::warn("ResourceManager: Texture with name '{}' already loaded.", name);
+            return false;
+        }
+
+        // A single level, registered without a source path so the budget never evicts it
+        DecodedImage image;
+        image.pixels = pixels;
+        image.width = width;
+        image.height = height;
+        WGPUTexture tex = CreateGPUTexture(name, width, height, 1);
+        if (!tex) return false;
+        UploadTextureLevels(tex, image);
+        RegisterTexture(name, "", image, tex);
+        return true;
+    }
+
+	// PrefetchBatch method. Decodes a batch's images without a GPU device, so it can overlap with device creation.
+    int ResourceManager::PrefetchBatch(const std::string& source) {
+        std::vector<AssetRequest> images;
+        for (AssetRequest& request : ExpandBatchSource(source)) {
+            if (IsImagePath(request.partialPath)) images.push_back(std::move(request));
+        }
+
+        std::vector<DecodedImage> decoded(images.size());
+        ThreadPool::Get().ParallelFor(images.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                DecodeImage(images[i].partialPath, decoded[i]);
+            }
+            });
+
+        int prefetched = 0;
+        std::lock_guard<std::mutex> lock(m_prefetchMutex);
+        for (size_t i = 0; i < images.size(); ++i) {
+            if (!decoded[i].pixels) continue;
+            auto [it, inserted] = m_prefetched.emplace(images[i].partialPath, decoded[i]);
+            if (!inserted) FreeDecodedImage(decoded[i]); // Listed twice
+            else ++prefetched;
+        }
+        spdlog::info("ResourceManager: Prefetched {} of {} images from '{}'.", prefetched, images.size(), source);
+        return prefetched;
+    }
+
+	// TakePrefetched method. Hands over (and forgets) the prefetched pixels for a path, if there are any.
+    bool ResourceManager::TakePrefetched(const std::string& partialPath, DecodedImage& image) {
+        std::lock_guard<std::mutex> lock(m_prefetchMutex);
+        auto it = m_prefetched.find(partialPath);
+        if (it == m_prefetched.end()) return false;
+        image = it->second;
+        m_prefetched.erase(it);
+        return true;
+    }
+
+	// Produces RGBA8 pixels for an image. Only reads shared state, so worker threads may call it.
+    bool ResourceManager::DecodeImage(const std::string& partialPath, DecodedImage& image) const {
+        // 1. Prefer the cooked pack: the pixels and mips are already decoded in the mapped pages
+        if (const PackedAsset* packed = FindPackedAsset(partialPath, PackAssetType::Image)) {
+            spdlog::info("Loading texture '{}' from cooked pack.", partialPath);
+            image.pixels = packed->data;
+            image.width = packed->width;
+            image.height = packed->height;
+            image.mipCount = packed->mipCount;
+            return true;
+        }
+
+        // 2. Resolve path and load data from disk
         std::filesystem::path fullPath = ResolvePath(partialPath);
         int width, height, channels;
 
@@ -74,14 +232,28 @@ namespace enDjinn {
             return false;
         }
 
-        // 2. Create WGPUTexture on GPU
+        image.owned = data;
+        image.pixels = data;
+        image.width = (uint32_t)width;
+        image.height = (uint32_t)height;
+        image.mipCount = 1;
+        return true;
+    }
+
+    void ResourceManager::FreeDecodedImage(DecodedImage& image) {
+        if (image.owned) stbi_image_free(image.owned);
+        image.owned = nullptr;
+        image.pixels = nullptr;
+    }
+
+    WGPUTexture ResourceManager::CreateGPUTexture(const std::string& label, uint32_t width, uint32_t height, uint32_t mipCount) {
         WGPUTextureDescriptor texDesc{};
-        texDesc.label = WGPUStringView(path_for_stbi.c_str(), WGPU_STRLEN);
+        texDesc.label = WGPUStringView(label.c_str(), WGPU_STRLEN);
         texDesc.usage = WGPUTextureUsage_TextureBinding | WGPUTextureUsage_CopyDst;
         texDesc.dimension = WGPUTextureDimension_2D;
-        texDesc.size = { (uint32_t)width, (uint32_t)height, 1 };
+        texDesc.size = { width, height, 1 };
         texDesc.format = WGPUTextureFormat_RGBA8UnormSrgb;
-        texDesc.mipLevelCount = 1;
+        texDesc.mipLevelCount = mipCount;
         texDesc.sampleCount = 1;
 
         WGPUTextureFormat viewFormat = WGPUTextureFormat_RGBA8UnormSrgb;
@@ -90,83 +262,473 @@ namespace enDjinn {
 
         WGPUTexture tex = wgpuDeviceCreateTexture(m_graphicsManager->GetDevice(), &texDesc);
         if (!tex) {
-            spdlog::error("ResourceManager: Failed to create WGPUTexture for '{}'.", name);
-            stbi_image_free(data);
-            return false;
+            spdlog::error("ResourceManager: Failed to create WGPUTexture for '{}'.", label);
+        }
+        return tex;
+    }
+
+	// Copies each mip level to the GPU. Levels are stored back to back, largest first.
+    void ResourceManager::UploadTextureLevels(WGPUTexture tex, const DecodedImage& image) {
+        uint64_t levelOffset = 0;
+        for (uint32_t level = 0; level < image.mipCount; ++level) {
+            uint32_t levelWidth = std::max(1u, image.width >> level);
+            uint32_t levelHeight = std::max(1u, image.height >> level);
+            size_t data_size = (size_t)PackMipSize(image.width, image.height, level);
+
+            // Prepare copy targets as local variables so pointers are stable
+            WGPUTexelCopyTextureInfo copyTextureInfo{};
+            copyTextureInfo.texture = tex;
+            copyTextureInfo.mipLevel = level;
+            copyTextureInfo.origin = WGPUOrigin3D{ 0, 0, 0 };
+
+		    // Buffer layout
+            WGPUTexelCopyBufferLayout bufferLayout{};
+            bufferLayout.offset = 0;
+            bufferLayout.bytesPerRow = levelWidth * 4; // 4 bytes per pixel (RGBA)
+            bufferLayout.rowsPerImage = levelHeight;
+
+		    // Define the extent of the texture to copy
+            WGPUExtent3D extent{};
+            extent.width = levelWidth;
+            extent.height = levelHeight;
+            extent.depthOrArrayLayers = 1;
+
+		    // Perform the texture data upload
+            wgpuQueueWriteTexture(
+                m_graphicsManager->GetQueue(),
+                &copyTextureInfo,
+                image.pixels + levelOffset,
+                data_size,
+                &bufferLayout,
+                &extent
+            );
+            levelOffset += data_size;
+        }
+    }
+
+	// Stores a freshly uploaded texture in the map and starts tracking its residency
+    bool ResourceManager::RegisterTexture(const std::string& name, const std::string& partialPath, const DecodedImage& image, WGPUTexture tex) {
+        Texture texture((int)image.width, (int)image.height, tex);
+        texture.mipCount = image.mipCount;
+        texture.sourcePath = partialPath;
+        texture.lastUsedFrame = m_frameIndex;
+        for (uint32_t level = 0; level < image.mipCount; ++level) {
+            texture.sizeBytes += PackMipSize(image.width, image.height, level);
+        }
+
+        const uint64_t sizeBytes = texture.sizeBytes;
+        auto [it, inserted] = m_textures.emplace(name, std::move(texture));
+        if (inserted) {
+            m_residentBytes += sizeBytes;
         }
+        return inserted;
+    }
+
+    // --- Residency Management ---
+
+    void ResourceManager::SetTextureBudget(uint64_t budgetBytes, uint32_t minIdleFrames) {
+        m_textureBudgetBytes = budgetBytes;
+        m_minIdleFrames = minIdleFrames;
+        spdlog::info("ResourceManager: Texture budget set to {} MiB, eviction after {} idle frames.", budgetBytes >> 20, minIdleFrames);
+    }
 
-        // 3. Copy image data to the GPU
-        WGPUExtent3D textureExtent = { (uint32_t)width, (uint32_t)height, 1 };
-        uint32_t bytesPerRow = (uint32_t)(width * 4); // 4 bytes per pixel (RGBA)
-        size_t data_size = (size_t)(width * height * 4);
-
-        // Prepare copy targets as local variables so pointers are stable
-        WGPUTexelCopyTextureInfo copyTextureInfo{};
-        copyTextureInfo.texture = tex;
-        copyTextureInfo.mipLevel = 0;
-        copyTextureInfo.origin = WGPUOrigin3D{ 0, 0, 0 };
-
-		// Buffer layout
-        WGPUTexelCopyBufferLayout bufferLayout{};
-        bufferLayout.offset = 0;
-        bufferLayout.bytesPerRow = bytesPerRow;
-        bufferLayout.rowsPerImage = (uint32_t)height;
-
-		// Define the extent of the texture to copy
-        WGPUExtent3D extent{};
-        extent.width = (uint32_t)width;
-        extent.height = (uint32_t)height;
-        extent.depthOrArrayLayers = 1;
-
-		// Perform the texture data upload
-        wgpuQueueWriteTexture(
-            m_graphicsManager->GetQueue(),
-            &copyTextureInfo,
-            data,
-            data_size,
-            &bufferLayout,
-            &extent
-        );
-
-		// Create a texture view (optional, depending on usage)
-        WGPUTextureViewDescriptor viewDesc{};
-        viewDesc.format = texDesc.format; // match texture format
-        viewDesc.dimension = WGPUTextureViewDimension_2D;
-        viewDesc.baseMipLevel = 0;
-        viewDesc.mipLevelCount = 1;
-        viewDesc.baseArrayLayer = 0;
-        viewDesc.arrayLayerCount = 1;
-        viewDesc.aspect = WGPUTextureAspect_All;
-
-        WGPUTextureView textureView = wgpuTextureCreateView(tex, &viewDesc);
-        if (!textureView) {
-            spdlog::error("ResourceManager: Failed to create texture view for '{}'", name);
-            wgpuTextureRelease(tex); // cleanup if desired
-            stbi_image_free(data);
+    void ResourceManager::EndFrame() {
+        ++m_frameIndex;
+        if (m_textureBudgetBytes > 0 && m_residentBytes > m_textureBudgetBytes) {
+            EnforceTextureBudget();
+        }
+
+        Stats& stats = Stats::Get();
+        stats.Set("textures.resident_bytes", static_cast<double>(m_residentBytes));
+        stats.Set("textures.evictions", static_cast<double>(m_evictionCount));
+        stats.Set("textures.reloads", static_cast<double>(m_reloadCount));
+    }
+
+	// Evicts idle textures, least recently used first, until the resident set fits the budget again.
+	// Textures drawn within the last m_minIdleFrames are never evicted, so the budget is soft.
+    void ResourceManager::EnforceTextureBudget() {
+        std::vector<Texture*> candidates;
+        for (auto& [name, texture] : m_textures) {
+            if (texture.texture && !texture.sourcePath.empty() && m_frameIndex - texture.lastUsedFrame >= m_minIdleFrames) {
+                candidates.push_back(&texture);
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(), [](const Texture* lhs, const Texture* rhs) {
+            return lhs->lastUsedFrame < rhs->lastUsedFrame;
+            });
+
+        for (Texture* texture : candidates) {
+            if (m_residentBytes <= m_textureBudgetBytes) break;
+
+            spdlog::debug("ResourceManager: Evicting texture '{}' ({} bytes).", texture->sourcePath, texture->sizeBytes);
+            wgpuTextureRelease(texture->texture);
+            texture->texture = nullptr;
+            m_residentBytes -= texture->sizeBytes;
+            ++m_evictionCount;
+        }
+    }
+
+	// Brings an evicted texture back from its source (pack or file) under the same name
+    bool ResourceManager::ReloadTexture(Texture& texture) {
+        DecodedImage image;
+        if (!DecodeImage(texture.sourcePath, image)) {
             return false;
         }
 
-        // 4. Free CPU memory
-        stbi_image_free(data);
+        texture.texture = CreateGPUTexture(texture.sourcePath, image.width, image.height, image.mipCount);
+        if (texture.texture) {
+            UploadTextureLevels(texture.texture, image);
+            m_residentBytes += texture.sizeBytes;
+            ++m_reloadCount;
+        }
+        FreeDecodedImage(image);
+        return texture.texture != nullptr;
+    }
 
-        // 5. Store the texture in the map
-        m_textures.emplace(name, Texture(
-            width,
-            height,
-            tex
-        ));
+    TextureStats ResourceManager::GetTextureStats() const {
+        TextureStats stats;
+        stats.residentBytes = m_residentBytes;
+        stats.budgetBytes = m_textureBudgetBytes;
+        stats.evictions = m_evictionCount;
+        stats.reloads = m_reloadCount;
+        for (const auto& [name, texture] : m_textures) {
+            if (texture.texture) {
+                ++stats.residentCount;
+            }
+            else {
+                ++stats.evictedCount;
+            }
+        }
+        return stats;
+    }
 
-        return true;
+    // --- Batch Loading Logic ---
+
+    bool ResourceManager::IsImagePath(const std::string& partialPath) {
+        std::string ext = LowerExtension(partialPath);
+        return ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp" || ext == ".tga";
+    }
+
+    bool ResourceManager::IsSoundPath(const std::string& partialPath) {
+        std::string ext = LowerExtension(partialPath);
+        return ext == ".wav" || ext == ".ogg" || ext == ".mp3" || ext == ".flac";
+    }
+
+	// Turns a manifest or directory glob into the list of assets it names
+    std::vector<AssetRequest> ResourceManager::ExpandBatchSource(const std::string& source) const {
+        std::vector<AssetRequest> requests;
+        std::filesystem::path fullPath = ResolvePath(source);
+        std::string ext = LowerExtension(source);
+
+        // 1. Manifest: one "name path" (or just "path", named after the file) per line, '#' starts a comment
+        if (ext == ".manifest" || ext == ".txt") {
+            std::ifstream manifest(fullPath);
+            if (!manifest) {
+                spdlog::error("ResourceManager: Could not open batch manifest '{}'.", fullPath.generic_string());
+                return requests;
+            }
+
+            std::string line;
+            while (std::getline(manifest, line)) {
+                std::istringstream fields(line.substr(0, line.find('#')));
+                std::string first, second;
+                if (!(fields >> first)) continue;
+
+                if (fields >> second) {
+                    requests.push_back({ first, second });
+                }
+                else {
+                    requests.push_back({ std::filesystem::path(first).stem().string(), first });
+                }
+            }
+            return requests;
+        }
+
+        // 2. Glob: a directory matches all of its files, otherwise the file name part may use '*' and '?'
+        std::filesystem::path directory = fullPath;
+        std::filesystem::path relativeDirectory = source;
+        std::string pattern = "*";
+        if (!std::filesystem::is_directory(fullPath)) {
+            directory = fullPath.parent_path();
+            relativeDirectory = std::filesystem::path(source).parent_path();
+            pattern = fullPath.filename().string();
+        }
+
+        std::error_code error;
+        for (const auto& entry : std::filesystem::directory_iterator(directory, error)) {
+            if (!entry.is_regular_file()) continue;
+
+            std::string fileName = entry.path().filename().string();
+            if (!WildcardMatch(pattern, fileName)) continue;
+
+            requests.push_back({ entry.path().stem().string(), (relativeDirectory / fileName).generic_string() });
+        }
+        if (error) {
+            spdlog::error("ResourceManager: Could not list '{}': {}", directory.generic_string(), error.message());
+        }
+
+        // Directory order is unspecified; keep batches deterministic
+        std::sort(requests.begin(), requests.end(), [](const AssetRequest& lhs, const AssetRequest& rhs) {
+            return lhs.partialPath < rhs.partialPath;
+            });
+        return requests;
+    }
+
+    int ResourceManager::LoadBatch(const std::string& source) {
+        std::vector<AssetRequest> requests = ExpandBatchSource(source);
+        if (requests.empty()) {
+            spdlog::warn("ResourceManager: Batch '{}' did not name any assets.", source);
+            return 0;
+        }
+        return LoadBatch(std::move(requests), source);
+    }
+
+    int ResourceManager::LoadBatch(std::vector<AssetRequest> requests, const std::string& label) {
+        if (m_headless) {
+            spdlog::info("ResourceManager: Headless, skipping batch '{}' ({} assets).", label, requests.size());
+            return 0;
+        }
+
+		// Validation of graphics context
+        if (!m_graphicsManager || !m_graphicsManager->GetDevice() || !m_graphicsManager->GetQueue()) {
+            spdlog::error("ResourceManager: Graphics context not initialized.");
+            return 0;
+        }
+
+        // 1. Split the batch by asset kind, skipping textures that are already loaded and names listed twice
+        std::vector<AssetRequest> images;
+        std::vector<AssetRequest> sounds;
+        std::unordered_set<std::string> imageNames;
+        int loadedCount = 0;
+        for (AssetRequest& request : requests) {
+            if (IsImagePath(request.partialPath)) {
+                if (m_textures.count(request.name)) {
+                    ++loadedCount;
+                    continue;
+                }
+                if (!imageNames.insert(request.name).second) {
+                    spdlog::warn("ResourceManager: Batch '{}' names texture '{}' more than once, skipping '{}'.", label, request.name, request.partialPath);
+                    continue;
+                }
+                images.push_back(std::move(request));
+            }
+            else if (IsSoundPath(request.partialPath)) {
+                sounds.push_back(std::move(request));
+            }
+            else {
+                spdlog::warn("ResourceManager: Batch entry '{}' is not an image or sound, skipping.", request.partialPath);
+            }
+        }
+
+        // 2. Sounds decode on a worker while this thread handles the images
+        ThreadPool& pool = ThreadPool::Get();
+        std::future<int> soundsLoaded;
+        if (!sounds.empty()) {
+            if (m_soundManager) {
+                soundsLoaded = pool.Submit([this, &sounds]() { return m_soundManager->LoadSoundBatch(sounds); });
+            }
+            else {
+                spdlog::error("ResourceManager: Batch '{}' lists sounds but no SoundManager is set.", label);
+            }
+        }
+
+        // 3. Decode all images in parallel. Cooked images are already decoded and point into the mapped pack.
+        std::vector<DecodedImage> decoded(images.size());
+        pool.ParallelFor(images.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                if (!TakePrefetched(images[i].partialPath, decoded[i])) {
+                    DecodeImage(images[i].partialPath, decoded[i]);
+                }
+            }
+            });
+
+        // 4. Lay every mip level of every image out in staging buffers no larger than the device allows.
+        // Buffer-to-texture copies need rows padded to a multiple of 256 bytes.
+        WGPUDevice device = m_graphicsManager->GetDevice();
+        WGPULimits limits{};
+        uint64_t maxStagingSize = 256ull << 20; // WebGPU's default maxBufferSize
+        if (wgpuDeviceGetLimits(device, &limits) == WGPUStatus_Success && limits.maxBufferSize > 0) {
+            maxStagingSize = limits.maxBufferSize;
+        }
+
+        struct StagedLevel {
+            size_t image;
+            uint32_t level;
+            uint32_t width;
+            uint32_t height;
+            uint32_t bytesPerRow;
+            uint64_t srcOffset;
+            size_t chunk;
+            uint64_t dstOffset;
+        };
+        std::vector<StagedLevel> levels;
+        std::vector<uint64_t> chunkSizes;
+        for (size_t i = 0; i < decoded.size(); ++i) {
+            if (!decoded[i].pixels) continue;
+
+            // Level 0 is the largest, so if it fits in a staging buffer every level does
+            uint64_t baseSize = uint64_t((decoded[i].width * 4 + 255) & ~255u) * decoded[i].height;
+            if (baseSize > maxStagingSize) {
+                spdlog::error("ResourceManager: Texture '{}' needs {} bytes of staging, more than the device's buffer limit of {}.",
+                    images[i].partialPath, baseSize, maxStagingSize);
+                FreeDecodedImage(decoded[i]);
+                continue;
+            }
+
+            uint64_t srcOffset = 0;
+            for (uint32_t level = 0; level < decoded[i].mipCount; ++level) {
+                uint32_t levelWidth = std::max(1u, decoded[i].width >> level);
+                uint32_t levelHeight = std::max(1u, decoded[i].height >> level);
+                uint32_t bytesPerRow = (levelWidth * 4 + 255) & ~255u;
+                uint64_t levelSize = uint64_t(bytesPerRow) * levelHeight;
+
+                if (chunkSizes.empty() || chunkSizes.back() + levelSize > maxStagingSize) {
+                    chunkSizes.push_back(0);
+                }
+                levels.push_back({ i, level, levelWidth, levelHeight, bytesPerRow, srcOffset, chunkSizes.size() - 1, chunkSizes.back() });
+                chunkSizes.back() += levelSize;
+                srcOffset += PackMipSize(decoded[i].width, decoded[i].height, level);
+            }
+        }
+
+        // Map every staging buffer up front. If one cannot be created or mapped, no image in the batch is uploaded.
+        std::vector<WGPUBuffer> staging(chunkSizes.size(), nullptr);
+        std::vector<uint8_t*> mapped(chunkSizes.size(), nullptr);
+        for (size_t c = 0; c < chunkSizes.size(); ++c) {
+            staging[c] = wgpuDeviceCreateBuffer(device, to_ptr(WGPUBufferDescriptor{
+                .label = WGPUStringView("Batch Staging Buffer", WGPU_STRLEN),
+                .usage = WGPUBufferUsage_MapWrite | WGPUBufferUsage_CopySrc,
+                .size = chunkSizes[c],
+                .mappedAtCreation = true
+                }));
+            if (staging[c]) {
+                mapped[c] = static_cast<uint8_t*>(wgpuBufferGetMappedRange(staging[c], 0, chunkSizes[c]));
+            }
+            if (!mapped[c]) {
+                spdlog::error("ResourceManager: Could not map a {} byte staging buffer, batch '{}' uploads no textures.", chunkSizes[c], label);
+                for (size_t r = 0; r <= c; ++r) {
+                    if (mapped[r]) wgpuBufferUnmap(staging[r]);
+                    if (staging[r]) wgpuBufferRelease(staging[r]);
+                }
+                staging.clear();
+                levels.clear();
+                break;
+            }
+        }
+
+        if (!levels.empty()) {
+            // Fill the staging buffers in parallel, one level per job
+            pool.ParallelFor(levels.size(), 1, [&](size_t begin, size_t end) {
+                for (size_t l = begin; l < end; ++l) {
+                    const StagedLevel& level = levels[l];
+                    const uint8_t* src = decoded[level.image].pixels + level.srcOffset;
+                    uint8_t* dst = mapped[level.chunk] + level.dstOffset;
+                    for (uint32_t row = 0; row < level.height; ++row) {
+                        std::memcpy(dst + size_t(row) * level.bytesPerRow, src + size_t(row) * level.width * 4, size_t(level.width) * 4);
+                    }
+                }
+                });
+            for (WGPUBuffer buffer : staging) {
+                wgpuBufferUnmap(buffer);
+            }
+
+            // 5. Create the textures and record every copy into a single command buffer
+            std::vector<WGPUTexture> textures(images.size(), nullptr);
+            for (size_t i = 0; i < images.size(); ++i) {
+                if (decoded[i].pixels) {
+                    textures[i] = CreateGPUTexture(images[i].partialPath, decoded[i].width, decoded[i].height, decoded[i].mipCount);
+                }
+            }
+
+            WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(device, nullptr);
+            for (const StagedLevel& level : levels) {
+                if (!textures[level.image]) continue;
+
+                WGPUTexelCopyBufferInfo copySource{};
+                copySource.buffer = staging[level.chunk];
+                copySource.layout.offset = level.dstOffset;
+                copySource.layout.bytesPerRow = level.bytesPerRow;
+                copySource.layout.rowsPerImage = level.height;
+
+                WGPUTexelCopyTextureInfo copyDestination{};
+                copyDestination.texture = textures[level.image];
+                copyDestination.mipLevel = level.level;
+                copyDestination.origin = WGPUOrigin3D{ 0, 0, 0 };
+
+                WGPUExtent3D extent{ level.width, level.height, 1 };
+                wgpuCommandEncoderCopyBufferToTexture(encoder, &copySource, &copyDestination, &extent);
+            }
+
+            WGPUCommandBuffer commands = wgpuCommandEncoderFinish(encoder, nullptr);
+            wgpuQueueSubmit(m_graphicsManager->GetQueue(), 1, &commands);
+            wgpuCommandBufferRelease(commands);
+            wgpuCommandEncoderRelease(encoder);
+            // The queue keeps the staging buffers alive until the copies have run
+            for (WGPUBuffer buffer : staging) {
+                wgpuBufferRelease(buffer);
+            }
+
+            // 6. Store the textures in the map
+            for (size_t i = 0; i < images.size(); ++i) {
+                if (!textures[i]) continue;
+                if (RegisterTexture(images[i].name, images[i].partialPath, decoded[i], textures[i])) {
+                    ++loadedCount;
+                }
+            }
+        }
+
+        // 7. Free CPU memory and collect the sound results
+        for (DecodedImage& image : decoded) {
+            FreeDecodedImage(image);
+        }
+        if (soundsLoaded.valid()) {
+            loadedCount += soundsLoaded.get();
+        }
+
+        spdlog::info("ResourceManager: Batch '{}' loaded {} of {} assets ({} images, {} sounds).",
+            label, loadedCount, requests.size(), images.size(), sounds.size());
+        return loadedCount;
     }
 
 	// --- Texture Retrieval Logic ---
-    const Texture* ResourceManager::GetTexture(const std::string& name) const {
+	// Marks the texture as used this frame and transparently reloads it if it was evicted
+    const Texture* ResourceManager::GetTexture(const std::string& name) {
         auto it = m_textures.find(name);
         if (it == m_textures.end()) {
-            spdlog::error("ResourceManager: Requested texture '{}' not found.", name);
+            ENDJINN_ERROR_EVERY(1000, "ResourceManager: Requested texture '{}' not found.", name);
             return nullptr;
         }
-        return &it->second;
+
+        Texture& texture = it->second;
+        texture.lastUsedFrame = m_frameIndex;
+        if (!texture.texture) {
+            // A source that just failed to load is not read from disk again on every draw
+            if (m_frameIndex < texture.reloadRetryFrame) return nullptr;
+            if (!ReloadTexture(texture)) {
+                texture.reloadRetryFrame = m_frameIndex + RELOAD_RETRY_FRAMES;
+                ENDJINN_WARN_EVERY(1000, "ResourceManager: Evicted texture '{}' could not be reloaded from '{}', retrying in {} frames.",
+                    name, texture.sourcePath, RELOAD_RETRY_FRAMES);
+                return nullptr;
+            }
+        }
+        return &texture;
+    }
+
+    std::vector<AssetRequest> ResourceManager::GetLoadedAssets() const {
+        std::vector<AssetRequest> assets;
+        assets.reserve(m_textures.size());
+        for (const auto& [name, texture] : m_textures) {
+            if (texture.sourcePath.empty()) continue; // Generated at runtime, nothing to load it from
+            assets.push_back({ name, texture.sourcePath });
+        }
+        std::sort(assets.begin(), assets.end(), [](const AssetRequest& lhs, const AssetRequest& rhs) { return lhs.name < rhs.name; });
+
+        if (m_soundManager) {
+            std::vector<AssetRequest> sounds = m_soundManager->GetLoadedSounds();
+            assets.insert(assets.end(), std::make_move_iterator(sounds.begin()), std::make_move_iterator(sounds.end()));
+        }
+        return assets;
     }
 
 } // namespace enDjinn
\ No newline at end of file
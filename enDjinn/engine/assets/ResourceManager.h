@@ -2,19 +2,38 @@
 
 #include <string>
 #include <filesystem>
+#include <mutex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 #include <webgpu/webgpu.h>
+#include "AssetPack.h"
 
 namespace enDjinn {
 
 	//Forward declaration from namespace enDjinn
     class GraphicsManager;
+    class SoundManager;
+
+	// One named asset to load, as listed by a batch manifest or found by a directory glob
+    struct AssetRequest {
+        std::string name;
+        std::string partialPath;
+    };
 
     struct Texture {
         int width = 0;
         int height = 0;
         WGPUTexture texture = nullptr;
 
+        // Residency tracking. An evicted texture keeps its entry with texture == nullptr
+        // and is reloaded from sourcePath the next time it is requested. Generated textures have no sourcePath.
+        uint32_t mipCount = 1;
+        uint64_t sizeBytes = 0;
+        uint64_t lastUsedFrame = 0;
+        uint64_t reloadRetryFrame = 0; // After a failed reload, the source is not read again before this frame
+        std::string sourcePath;
+
         Texture(int w, int h, WGPUTexture t)
             : width(w), height(h), texture(t) {
         }
@@ -22,8 +41,27 @@ namespace enDjinn {
 		Texture() = delete; // Disable default constructor
         Texture(const Texture&) = delete;
         Texture& operator=(const Texture&) = delete;
-        Texture(Texture&&) = default;
-        Texture& operator=(Texture&&) = default;
+
+        // Moves hand over the GPU handle, so only one Texture ever releases it
+        Texture(Texture&& other) noexcept
+            : width(other.width), height(other.height), texture(std::exchange(other.texture, nullptr)),
+            mipCount(other.mipCount), sizeBytes(other.sizeBytes), lastUsedFrame(other.lastUsedFrame),
+            reloadRetryFrame(other.reloadRetryFrame), sourcePath(std::move(other.sourcePath)) {
+        }
+        Texture& operator=(Texture&& other) noexcept {
+            if (this != &other) {
+                if (texture) wgpuTextureRelease(texture);
+                width = other.width;
+                height = other.height;
+                texture = std::exchange(other.texture, nullptr);
+                mipCount = other.mipCount;
+                sizeBytes = other.sizeBytes;
+                lastUsedFrame = other.lastUsedFrame;
+                reloadRetryFrame = other.reloadRetryFrame;
+                sourcePath = std::move(other.sourcePath);
+            }
+            return *this;
+        }
 
         // Destructor to ensure the resource is released
         ~Texture() {
@@ -31,6 +69,16 @@ namespace enDjinn {
         }
     };
 
+	// GPU texture memory accounting, readable from C++ and Lua
+    struct TextureStats {
+        uint64_t residentBytes = 0;
+        uint64_t budgetBytes = 0;
+        uint32_t residentCount = 0;
+        uint32_t evictedCount = 0;
+        uint64_t evictions = 0; // Totals since startup
+        uint64_t reloads = 0;
+    };
+
     class ResourceManager {
     public:
         ResourceManager(GraphicsManager* gm);
@@ -38,19 +86,83 @@ namespace enDjinn {
 
         // Asset Loading Functions
         bool LoadTexture(const std::string& name, const std::string& partialPath);
-  
+        // Registers a texture generated at runtime (e.g. a baked font atlas) from tightly packed RGBA8 pixels.
+        // Such textures have no source to reload from, so they are never evicted.
+        bool CreateTextureFromPixels(const std::string& name, uint32_t width, uint32_t height, const uint8_t* pixels);
+        // Loads every image and sound named by a manifest ("name path" per line) or matched by a glob
+        // such as "sprites/*.jpg". Decoding runs in parallel and all textures upload in one submission.
+        // Returns the number of assets that are loaded afterwards.
+        int LoadBatch(const std::string& source);
+        // Same, for an explicit list. 'label' only names the batch in the log.
+        int LoadBatch(std::vector<AssetRequest> requests, const std::string& label);
+        void SetSoundManager(SoundManager* sm) { m_soundManager = sm; }
+        // Headless runs have no GPU: image loads are skipped quietly instead of failing
+        void SetHeadless(bool headless) { m_headless = headless; }
+        // Decodes the images a batch names without touching the GPU, so startup can overlap decoding with device
+        // creation. The next LoadBatch or LoadTexture of those paths uploads the prefetched pixels. Thread-safe.
+        int PrefetchBatch(const std::string& source);
+        static bool IsImagePath(const std::string& partialPath);
+        static bool IsSoundPath(const std::string& partialPath);
+
+        // Cooked Pack Functions
+        // Once a pack is open, loads whose partial path is in the pack skip decoding and read the mapped data.
+        bool LoadPack(const std::string& partialPath);
+        const PackedAsset* FindPackedAsset(const std::string& partialPath, PackAssetType type) const;
+
         // Path Management
         std::filesystem::path ResolvePath(const std::string& partialPath) const;
         void SetAssetRoot(const std::filesystem::path& newRoot);
-        const Texture* GetTexture(const std::string& name) const;
+        const Texture* GetTexture(const std::string& name);
+        // Name and source of every loaded texture (evicted ones included, generated ones not) and sound, sorted by name within each kind
+        std::vector<AssetRequest> GetLoadedAssets() const;
+
+        // Residency Management
+        // EndFrame is called once per rendered frame. While resident bytes exceed the budget, textures idle for at
+        // least minIdleFrames are evicted least-recently-used first. A budget of 0 disables eviction.
+        void EndFrame();
+        void SetTextureBudget(uint64_t budgetBytes, uint32_t minIdleFrames);
+        TextureStats GetTextureStats() const;
 
 
     private:
+        // CPU-side image ready for upload. 'pixels' points into the cooked pack or at the stb_image memory in 'owned'.
+        struct DecodedImage {
+            const uint8_t* pixels = nullptr;
+            unsigned char* owned = nullptr;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            uint32_t mipCount = 1;
+        };
+
+        std::vector<AssetRequest> ExpandBatchSource(const std::string& source) const;
+        bool DecodeImage(const std::string& partialPath, DecodedImage& image) const;
+        static void FreeDecodedImage(DecodedImage& image);
+        bool TakePrefetched(const std::string& partialPath, DecodedImage& image);
+        WGPUTexture CreateGPUTexture(const std::string& label, uint32_t width, uint32_t height, uint32_t mipCount);
+        void UploadTextureLevels(WGPUTexture tex, const DecodedImage& image);
+        // Returns false, releasing 'tex', if a texture with that name is already registered
+        bool RegisterTexture(const std::string& name, const std::string& partialPath, const DecodedImage& image, WGPUTexture tex);
+        bool ReloadTexture(Texture& texture);
+        void EnforceTextureBudget();
+
         GraphicsManager* m_graphicsManager;
+        SoundManager* m_soundManager = nullptr;
         std::filesystem::path m_assetRoot;
+        AssetPack m_pack;
+        bool m_headless = false;
 
         // Asset Storage
         std::unordered_map<std::string, Texture> m_textures;
+        std::mutex m_prefetchMutex;
+        std::unordered_map<std::string, DecodedImage> m_prefetched; // Keyed by partial path
+
+        // Residency state
+        uint64_t m_frameIndex = 0;
+        uint64_t m_textureBudgetBytes = 256ull << 20;
+        uint32_t m_minIdleFrames = 120;
+        uint64_t m_residentBytes = 0;
+        uint64_t m_evictionCount = 0;
+        uint64_t m_reloadCount = 0;
     };
 
 } // namespace enDjinn
\ No newline at end of file
@@ -1,14 +1,28 @@
+#pragma once
+
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <string>
 
 namespace enDjinn {
 
+    // How a sprite's color combines with what is already drawn. Each mode is its own pipeline variant.
+    enum class BlendMode : uint8_t {
+        Alpha,    // Standard transparency
+        Additive, // Glows, fire, projectiles
+        Multiply, // Shadows and tinting overlays
+        Opaque    // No blending
+    };
+
     // Forward declaration if needed, or put inside GraphicsManager/Engine namespace
     struct Sprite {
         std::string textureName; // Name used to look up in ResourceManager
         glm::vec2 position = { 0.0f, 0.0f }; // Translation (x, y)
         glm::vec2 scale = { 1.0f, 1.0f };     // Scale factor
         float z = 0.0f;                    // Z-depth for sorting (0.0=front, 1.0=back)
+        BlendMode blend = BlendMode::Alpha;
+        glm::vec4 uvRect = { 0.0f, 0.0f, 1.0f, 1.0f }; // Part of the texture to draw: x, y, width, height in UVs
+        uint32_t animation = 0; // AnimationSystem id. When set, the animation picks the texture and uvRect.
     };
 
 }
\ No newline at end of file
@@ -1,84 +1,444 @@
 -- Create the ECS table
 ECS = {}
 
+-- Entity handles are a slot in the low 24 bits plus a generation above them. Freed slots are reused (most
+-- recently freed first), so everything keyed by slot stays in the array part of its table no matter how many
+-- entities come and go. Destroying an entity bumps its slot's generation, which turns old handles stale.
+local SLOT_BITS = 24
+local SLOT_MASK = (1 << SLOT_BITS) - 1
+local math_type = math.type
+
 -- Initialize internal state
-ECS._nextEntityID = 1
+ECS._slotCount = 0      -- Slots handed out so far
+ECS._freeSlots = {}     -- Stack of destroyed slots, ready for reuse
+ECS._generations = {}   -- slot -> generation of the entity living there (or of the next one)
 ECS.Components = {}
-ECS.LiveEntities = {} -- Keep track of currently active entities for easy iteration
+ECS.LiveEntities = {}   -- slot -> handle of the live entity in it, for easy iteration
 
--- Function: Create a new entity ID
-function ECS.CreateEntity()
-    local e = ECS._nextEntityID
-    ECS._nextEntityID = ECS._nextEntityID + 1
-    ECS.LiveEntities[e] = true -- Mark as live
-    return e
+-- Storage behind ECS.Components. Each component type is a pool: its values keyed by slot, plus a dense
+-- slot set for fast iteration. ECS.Components.X is an empty proxy, so every access goes through the ECS,
+-- which keeps the indices below current and ignores stale handles.
+ECS._pools = {}            -- component name -> pool
+ECS._entityComponents = {} -- slot -> { [component name] = true }, so destroying only touches the entity's own components
+ECS._views = {}            -- query signature ("A|B") -> cached view, the set of entities that have every component
+
+-- Query tables seen before, so hoisted query tables skip building the signature
+local viewsByQuery = setmetatable({}, { __mode = "k" })
+
+-- Native resources owned by a component value, released when the value leaves its pool (dropped, replaced
+-- or destroyed with its entity). A Sprite owns the animation Animation_Play gave it, unless its replacement
+-- carries the same one on. World imports swap values without releasing, as restored sprites keep their ids.
+local releasers = {
+    Sprite = function(sprite, replacement)
+        local animation = sprite.animation
+        if not animation or animation == 0 or Animation_Destroy == nil then return end
+        if replacement and replacement.animation == animation then return end
+        Animation_Destroy(animation)
+    end,
+}
+
+local handles = ECS.LiveEntities -- Also the liveness check: a handle is current only if it is stored in its slot
+
+-- Function: Turn a handle into its slot, or nil if the handle is stale or not an entity
+local function Resolve(e)
+    if math_type(e) ~= "integer" then
+        e = math.tointeger(e)
+        if e == nil then return nil end
+    end
+    local slot = e & SLOT_MASK
+    if handles[slot] ~= e then return nil end
+    return slot
 end
 
--- Function: Destroy an entity
-function ECS.DestroyEntity(e)
-    if e == nil then return end
+-- Dense slot sets. Slots live in an array (1..size) with a reverse index, so adding and removing are O(1)
+-- and iteration walks an array instead of a hash. While a set is being iterated, removals leave a hole (false)
+-- instead of swapping, so the running loop neither skips nor repeats entities; holes are compacted afterwards.
+local function NewSet()
+    return { dense = {}, index = {}, size = 0, holes = 0, iterating = 0 }
+end
+
+local function SetCount(set)
+    return set.size - set.holes
+end
+
+local function SetAdd(set, slot)
+    if set.index[slot] then return end
+    local n = set.size + 1
+    set.size = n
+    set.dense[n] = slot
+    set.index[slot] = n
+end
+
+local function SetRemove(set, slot)
+    local i = set.index[slot]
+    if i == nil then return end
+    set.index[slot] = nil
+
+    if set.iterating > 0 then
+        set.dense[i] = false
+        set.holes = set.holes + 1
+        return
+    end
+
+    -- Swap the last entry into the freed position
+    local n = set.size
+    local last = set.dense[n]
+    set.dense[n] = nil
+    set.size = n - 1
+    if i ~= n then
+        set.dense[i] = last
+        set.index[last] = i
+    end
+end
+
+local function SetCompact(set)
+    if set.holes == 0 then return end
+    local dense, index = set.dense, set.index
+    local n = 0
+    for i = 1, set.size do
+        local slot = dense[i]
+        if slot then
+            n = n + 1
+            dense[n] = slot
+            index[slot] = n
+        end
+    end
+    for i = n + 1, set.size do
+        dense[i] = nil
+    end
+    set.size = n
+    set.holes = 0
+end
+
+local function IterateDense(dense, count, callback)
+    for i = 1, count do
+        local slot = dense[i]
+        if slot then callback(handles[slot]) end
+    end
+end
+
+-- ForEach calls currently running, and a world import waiting for them to return (see ECS.Import)
+local activeIterations = 0
+local ApplyImport
+
+local function SetForEach(set, callback)
+    -- Entities added by the callback land past 'size' and are not visited in this pass
+    set.iterating = set.iterating + 1
+    activeIterations = activeIterations + 1
+    local ok, err = pcall(IterateDense, set.dense, set.size, callback)
+    set.iterating = set.iterating - 1
+    activeIterations = activeIterations - 1
+    if set.iterating == 0 then SetCompact(set) end
+
+    local pending = ECS._pendingImport
+    if activeIterations == 0 and pending then
+        ECS._pendingImport = nil
+        ApplyImport(pending)
+    end
+    if not ok then error(err, 0) end
+end
 
-    -- Remove the entity from the active list
-    ECS.LiveEntities[e] = nil 
-    
-    -- Remove the entity's components from all component tables
-    for _, component_table in pairs(ECS.Components) do
-        component_table[e] = nil
+-- Function: Check whether an entity has every component of a view
+local function Matches(view, slot)
+    for _, pool in ipairs(view.pools) do
+        if pool.data[slot] == nil then return false end
     end
+    return true
 end
 
--- Function: The __index metamethod to dynamically create component tables
+local function RemoveComponent(pool, slot)
+    local value = pool.data[slot]
+    if value == nil then return end
+    pool.data[slot] = nil
+    if pool.release then pool.release(value) end
+    SetRemove(pool.set, slot)
+
+    local owned = ECS._entityComponents[slot]
+    if owned then owned[pool.name] = nil end
+
+    for _, view in ipairs(pool.views) do
+        SetRemove(view.set, slot)
+    end
+end
+
+local function SetComponent(pool, slot, value)
+    if value == nil then
+        RemoveComponent(pool, slot)
+        return
+    end
+
+    local data = pool.data
+    local previous = data[slot]
+    if previous ~= nil then
+        -- Replacing a value does not change which queries the entity belongs to
+        data[slot] = value
+        if pool.release and previous ~= value then pool.release(previous, value) end
+        return
+    end
+    data[slot] = value
+    SetAdd(pool.set, slot)
+
+    local owned = ECS._entityComponents[slot]
+    if owned == nil then
+        owned = {}
+        ECS._entityComponents[slot] = owned
+    end
+    owned[pool.name] = true
+
+    for _, view in ipairs(pool.views) do
+        if Matches(view, slot) then SetAdd(view.set, slot) end
+    end
+end
+
+-- Function: Write a component through a handle. Writes through stale handles are dropped, so a late write
+-- to a destroyed entity cannot land on whatever reuses its slot.
+local function SetComponentByHandle(pool, e, value)
+    local slot = Resolve(e)
+    if slot then SetComponent(pool, slot, value) end
+end
+
+-- Function: Iterator behind pairs(ECS.Components.X), yielding handles rather than slots
+local function NextComponent(data, e)
+    local slot = e and (e & SLOT_MASK)
+    local value
+    slot, value = next(data, slot)
+    if slot == nil then return nil end
+    return handles[slot], value
+end
+
+-- Function: Get (or lazily create) the pool of a component type
+local function GetPool(name)
+    local pool = ECS._pools[name]
+    if pool then return pool end
+
+    pool = { name = name, data = {}, set = NewSet(), views = {}, release = releasers[name] }
+    local data = pool.data
+    pool.proxy = setmetatable({}, {
+        __index = function(_, e)
+            local slot = Resolve(e)
+            return slot and data[slot]
+        end,
+        __newindex = function(_, e, value) SetComponentByHandle(pool, e, value) end,
+        __pairs = function() return NextComponent, data, nil end,
+    })
+    ECS._pools[name] = pool
+    -- Stored raw, so later ECS.Components.X lookups are plain table reads
+    rawset(ECS.Components, name, pool.proxy)
+    return pool
+end
+
+-- Function: The metamethods that create component pools on first use.
+-- Assigning a table to a new component name (ECS.Components.X = {}) creates the pool and adds the table's entries.
 local component_metatable = {
-    __index = function(table, component_name)
-        -- If a component type is accessed for the first time, create a new table for it.
-        table[component_name] = {}
-        return table[component_name]
+    __index = function(_, component_name)
+        return GetPool(component_name).proxy
+    end,
+    __newindex = function(_, component_name, initial)
+        local pool = GetPool(component_name)
+        if type(initial) == "table" then
+            for e, value in pairs(initial) do
+                SetComponentByHandle(pool, e, value)
+            end
+        end
     end
 }
 setmetatable(ECS.Components, component_metatable)
 
+-- Function: Fill an empty view from the smallest of its pools; from then on adds and drops keep it current
+local function SeedView(view)
+    local smallest = nil
+    for _, pool in ipairs(view.pools) do
+        if smallest == nil or SetCount(pool.set) < SetCount(smallest.set) then
+            smallest = pool
+        end
+    end
+
+    local dense = smallest.set.dense
+    for i = 1, smallest.set.size do
+        local slot = dense[i]
+        if slot and Matches(view, slot) then SetAdd(view.set, slot) end
+    end
+end
+
+-- Function: Get the cached view for a set of components, building it the first time it's queried
+local function GetView(components)
+    local view = viewsByQuery[components]
+    if view then return view end
+
+    local names = {}
+    for i = 1, #components do
+        names[i] = components[i]
+    end
+    table.sort(names)
+    local signature = table.concat(names, "|")
+
+    view = ECS._views[signature]
+    if view == nil then
+        view = { signature = signature, pools = {}, set = NewSet() }
+        for i, name in ipairs(names) do
+            local pool = GetPool(name)
+            view.pools[i] = pool
+            table.insert(pool.views, view)
+        end
+        SeedView(view)
+        ECS._views[signature] = view
+    end
+
+    viewsByQuery[components] = view
+    return view
+end
+
+-- Function: Create a new entity, reusing a freed slot when there is one
+function ECS.CreateEntity()
+    local free = ECS._freeSlots
+    local slot = free[#free]
+    if slot then
+        free[#free] = nil
+    else
+        slot = ECS._slotCount + 1
+        if slot > SLOT_MASK then
+            error("ECS.CreateEntity: more than " .. SLOT_MASK .. " live entities")
+        end
+        ECS._slotCount = slot
+        ECS._generations[slot] = 0
+    end
+
+    local e = (ECS._generations[slot] << SLOT_BITS) | slot
+    handles[slot] = e -- Mark as live
+    return e
+end
+
+-- Function: Destroy an entity. Destroying a stale handle does nothing.
+function ECS.DestroyEntity(e)
+    if e == nil then return end
+    local slot = Resolve(e)
+    if slot == nil then return end
+
+    -- Remove the entity's components, visiting only the pools it is in
+    local owned = ECS._entityComponents[slot]
+    if owned then
+        for component_name in pairs(owned) do
+            RemoveComponent(ECS._pools[component_name], slot)
+        end
+        ECS._entityComponents[slot] = nil
+    end
+
+    -- Remove the entity from the active list and retire its handle
+    handles[slot] = nil
+    ECS._generations[slot] = ECS._generations[slot] + 1
+    ECS._freeSlots[#ECS._freeSlots + 1] = slot
+end
+
+-- Function: Check whether a handle still refers to a live entity
+function ECS.IsAlive(e)
+    return e ~= nil and Resolve(e) ~= nil
+end
+
+-- Function: Number of live entities
+function ECS.EntityCount()
+    return ECS._slotCount - #ECS._freeSlots
+end
 
 -- Function: Iterate over entities with a specific set of components
+-- Single-component queries walk the pool's dense set. Multi-component queries walk a cached view, which holds
+-- exactly the matching entities, so their cost no longer depends on the size of the largest component table.
+-- Entities created during the iteration are visited from the next call on.
 function ECS.ForEach(components, callback)
     -- Lua uses 1-indexing for the components array
     local required_count = #components
     if required_count == 0 then return end -- No components specified
 
-    -- 1. Find the component table for the first component (candidate pool)
-    local first_component_name = components[1]
-    local candidate_pool = ECS.Components[first_component_name]
-
-    if candidate_pool == nil then
-        -- This component type hasn't been added to any entity yet
-        return 
-    end
-
-    -- 2. Iterate over all entities in the candidate pool
-    for entity_id, _ in pairs(candidate_pool) do
-        local has_all_components = true
-        
-        -- 3. Check if the entity has all other required components
-        for i = 2, required_count do
-            local current_component_name = components[i]
-            
-            -- Check if the entity_id exists in the current component table
-            if ECS.Components[current_component_name][entity_id] == nil then
-                has_all_components = false
-                break -- Exit the inner loop early, this entity doesn't match
-            end
-        end
-
-        -- 4. If the entity has all required components, run the callback
-        if has_all_components then
-            callback(entity_id)
-        end
+    if required_count == 1 then
+        SetForEach(GetPool(components[1]).set, callback)
+    else
+        SetForEach(GetView(components).set, callback)
     end
 end
 
+-- Function: Number of entities that have a component
+function ECS.Count(component_name)
+    local pool = ECS._pools[component_name]
+    return pool and SetCount(pool.set) or 0
+end
+
 -- Expose utility function for dropping a component (setting to nil)
 -- ECS.DropComponent("sprite", my_entity),
 function ECS.DropComponent(component_name, entity_id)
-    if ECS.Components[component_name] then
-        ECS.Components[component_name][entity_id] = nil
+    local pool = ECS._pools[component_name]
+    local slot = entity_id and Resolve(entity_id)
+    if pool and slot then
+        RemoveComponent(pool, slot)
+    end
+end
+
+-- Function: The whole world as plain tables, for WorldSnapshot. These are the live tables, not copies.
+-- components maps each component name to its values keyed by slot; live maps each used slot to its handle.
+function ECS.Export()
+    local components = {}
+    for name, pool in pairs(ECS._pools) do
+        components[name] = pool.data
+    end
+    return {
+        slotCount = ECS._slotCount,
+        generations = ECS._generations,
+        freeSlots = ECS._freeSlots,
+        live = handles,
+        components = components,
+    }
+end
+
+-- Function: Replace every entity and component with an exported world in one pass per pool.
+-- Tables are cleared in place, since the component proxies (and anything scripts cached from them) refer to them.
+ApplyImport = function(state)
+    for slot in pairs(handles) do
+        handles[slot] = nil
     end
-end
\ No newline at end of file
+    for slot, e in pairs(state.live) do
+        handles[slot] = e
+    end
+    ECS._slotCount = state.slotCount
+    ECS._generations = state.generations
+    ECS._freeSlots = state.freeSlots
+
+    local owners = {}
+    ECS._entityComponents = owners
+    for _, pool in pairs(ECS._pools) do
+        local data = pool.data
+        for slot in pairs(data) do
+            data[slot] = nil
+        end
+        pool.set = NewSet()
+    end
+
+    for name, values in pairs(state.components) do
+        local pool = GetPool(name)
+        local data, set = pool.data, pool.set
+        for slot, value in pairs(values) do
+            if handles[slot] then
+                data[slot] = value
+                SetAdd(set, slot)
+                local owned = owners[slot]
+                if owned == nil then
+                    owned = {}
+                    owners[slot] = owned
+                end
+                owned[name] = true
+            end
+        end
+    end
+
+    for _, view in pairs(ECS._views) do
+        view.set = NewSet()
+        SeedView(view)
+    end
+end
+
+-- Function: Load an exported world. Called from inside an ECS.ForEach callback, the import waits until the
+-- outermost ForEach returns, so running iterations never see half a world.
+function ECS.Import(state)
+    if activeIterations > 0 then
+        ECS._pendingImport = state
+        return
+    end
+    ApplyImport(state)
+end
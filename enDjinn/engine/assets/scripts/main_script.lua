@@ -14,11 +14,10 @@ local SHIFT_KEY_SOUND_NAME = "ding_sound"
 
 -- 1. Asset loading and Entity Creation (Executed once at startup)
 print("--- Lua ECS Setup Started ---")
-ResourceManager_LoadImage("player_texture", "sprites/player_sprite.jpg")
-ResourceManager_LoadImage("background_texture", "sprites/bg.jpg")
-SoundManager_LoadSound(SHIFT_KEY_SOUND_NAME, "sounds/ding.wav")
+-- All images and sounds listed in the manifest are decoded in parallel and uploaded together.
+-- A glob works too, e.g. ResourceManager_LoadBatch("sprites/*.jpg") names each texture after its file.
+ResourceManager_LoadBatch("main.manifest")
 -- Note: Though the current sprites and sounds are jokey, they work with any type of image as long as it's described correctly in the path.
--- I would change it to find all assets in a folder, but that requires C++ changes too close to the deadline
 
 print("Assets loading requested.")
 
@@ -46,6 +45,10 @@ ECS.Components.script[player_entity] = { name = "PlayerUpdate" }
 
 print("--- Lua ECS Setup Complete ---")
 
+-- Remember the freshly built level; restarting restores it in bulk instead of re-running this script
+local LEVEL_START_SNAPSHOT = "level_start"
+World_Snapshot(LEVEL_START_SNAPSHOT)
+
 
 -- 2. Define the PlayerUpdate system (function)
 -- This function will be called by the C++ ScriptManager for every entity with a 'script' component whose name is 'PlayerUpdate'
@@ -80,6 +83,10 @@ function PlayerUpdate(entity_id, dt)
         SoundManager_PlaySound(SHIFT_KEY_SOUND_NAME, 0.8, 0.0, 0)
     end
     
+    if IsKeyTriggered(KEYBOARD.ENTER) then
+        World_Restore(LEVEL_START_SNAPSHOT)
+    end
+
     if IsKeyPressed(KEYBOARD.ESCAPE) then
         QuitGame()
     end
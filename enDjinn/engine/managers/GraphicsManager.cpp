@@ -7,6 +7,11 @@
 #include "GraphicsManager.h"
 #include "ScriptManager.h"
 #include "./utils/Types.h"
+#include "./utils/SimdMath.h"
+#include "./utils/ThreadPool.h"
+#include "./utils/FrameArena.h"
+#include "./utils/Stats.h"
+#include "./utils/Log.h"
 #include "spdlog/spdlog.h"
 #include <iostream>
 #include <functional>
@@ -15,6 +20,10 @@
 #include <glm/gtc/matrix_transform.hpp>
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <type_traits>
 
 struct GLFWwindow;
 
@@ -27,6 +36,9 @@ struct Uniforms {
 template< typename T > constexpr const T* to_ptr(const T& val) { return &val; }
 template< typename T, std::size_t N > constexpr const T* to_ptr(const T(&& arr)[N]) { return arr; }
 
+// Timestamp writes for one pass (WGPURenderPassTimestampWrites, WGPUPassTimestampWrites in newer headers)
+using PassTimestampWrites = std::remove_cvref_t<decltype(*WGPURenderPassDescriptor{}.timestampWrites)>;
+
 // Utility function to get the preferred format of a WGPUSurface for a given WGPUAdapter
 WGPUTextureFormat wgpuSurfaceGetPreferredFormat(WGPUSurface surface, WGPUAdapter adapter) {
     WGPUSurfaceCapabilities capabilities{};
@@ -36,6 +48,42 @@ WGPUTextureFormat wgpuSurfaceGetPreferredFormat(WGPUSurface surface, WGPUAdapter
     return result;
 }
 
+// Blocks until a WebGPU request completes. Dawn delivers callbacks while events are processed, so pump them
+// between short waits on the future rather than spinning flat out.
+template< typename T > T WaitForWebGPU(WGPUInstance instance, std::future<T>& future) {
+    while (future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready) {
+        wgpuInstanceProcessEvents(instance);
+    }
+    return future.get();
+}
+
+// Draws the offscreen scene target over the whole swapchain image, using the shared quad
+static constexpr const char* UPSCALE_SHADER = R"(
+    @group(0) @binding(0) var sceneSampler: sampler;
+    @group(0) @binding(1) var sceneTexture: texture_2d<f32>;
+
+    struct VertexInput {
+        @location(0) position: vec2f,
+        @location(1) texcoords: vec2f,
+    };
+
+    struct VertexOutput {
+        @builtin(position) position: vec4f,
+        @location(0) texcoords: vec2f,
+    };
+
+    @vertex fn vertex_shader_main(in: VertexInput) -> VertexOutput {
+        var out: VertexOutput;
+        out.position = vec4f(in.position, 0.0, 1.0);
+        out.texcoords = in.texcoords;
+        return out;
+    }
+
+    @fragment fn fragment_shader_main(in: VertexOutput) -> @location(0) vec4f {
+        return textureSample(sceneTexture, sceneSampler, in.texcoords);
+    }
+    )";
+
 namespace enDjinn {
 	// Background color components
     float red = 0.0f;
@@ -47,31 +95,42 @@ namespace enDjinn {
     GraphicsManager::~GraphicsManager() {
     }
 
-	// Startup method implementation
+	// Startup method implementation. Runs both startup stages back to back on the calling thread.
     void GraphicsManager::Startup(int width, int height, const std::string& title, bool fullscreen) {
+        if (CreateWindowAndSurface(width, height, title, fullscreen)) {
+            InitializeDevice();
+        }
+    }
+
+	// CreateWindowAndSurface method implementation. GLFW requires this stage to run on the main thread.
+    bool GraphicsManager::CreateWindowAndSurface(int width, int height, const std::string& title, bool fullscreen) {
 		// 0. Initialize GLFW
         if (!glfwInit()) {
             spdlog::error("Failed to initialize GLFW.");
-            return;
+            return false;
         }
 
 		// Configure GLFW for WebGPU
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
-        glfwWindowHint(GLFW_RESIZABLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_RESIZABLE, GLFW_TRUE);
 
 		// Create the window
         m_window = glfwCreateWindow(width, height, title.c_str(), fullscreen ? glfwGetPrimaryMonitor() : nullptr, nullptr);
+        m_windowTitle = title;
         if (!m_window) {
             spdlog::error("Failed to create a window.");
             glfwTerminate();
-            return;
+            return false;
         }
 
 		// Show the window
         glfwShowWindow(m_window);
 
-		// Set aspect ratio
-        glfwSetWindowAspectRatio(m_window, width, height);
+		// Remember the drawable size, since the device stage may run on another thread, and follow it from now on.
+		// The projection adapts to any aspect ratio, so the window is free to resize.
+        glfwGetFramebufferSize(m_window, &m_framebufferWidth, &m_framebufferHeight);
+        glfwSetWindowUserPointer(m_window, this);
+        glfwSetFramebufferSizeCallback(m_window, FramebufferSizeCallback);
 
         // 1. Initialize WebGPU
         WGPUInstanceDescriptor instanceDesc{};
@@ -79,7 +138,7 @@ namespace enDjinn {
         if (!m_instance) {
             spdlog::error("Failed to create WebGPU instance.");
             glfwTerminate();
-            return;
+            return false;
         }
 
         // 2. Create the Surface
@@ -89,28 +148,39 @@ namespace enDjinn {
             spdlog::error("Failed to create WebGPU surface.");
             // Properly terminate the previous steps
             if (m_instance) wgpuInstanceRelease(m_instance);
+            m_instance = nullptr;
             glfwTerminate();
-            return; // Stop initialization
+            return false; // Stop initialization
         }
+        spdlog::info("Window created successfully.");
+        return true;
+    }
 
-        // 3. Request an Adapter
+	// InitializeDevice method implementation. Touches no GLFW state, so it can run on a worker
+	// while the main thread carries on with other startup stages.
+    bool GraphicsManager::InitializeDevice() {
+        if (!m_instance || !m_surface) return false;
+
+        // 3. Request an Adapter. The callback fulfils a promise instead of writing the member directly.
+        std::promise<WGPUAdapter> adapterPromise;
+        std::future<WGPUAdapter> adapterFuture = adapterPromise.get_future();
         wgpuInstanceRequestAdapter(
             m_instance,
             to_ptr(WGPURequestAdapterOptions{ .compatibleSurface = m_surface }),
             WGPURequestAdapterCallbackInfo{
                 .mode = WGPUCallbackMode_AllowSpontaneous,
-                .callback = [](WGPURequestAdapterStatus status, WGPUAdapter adapter, WGPUStringView message, void* adapter_ptr, void*) {
+                .callback = [](WGPURequestAdapterStatus status, WGPUAdapter adapter, WGPUStringView message, void* promise_ptr, void*) {
                     if (status != WGPURequestAdapterStatus_Success) {
-                        std::cerr << "Failed to get a WebGPU adapter: " << std::string_view(message.data, message.length) << std::endl;
-                        glfwTerminate();
+                        spdlog::error("Failed to get a WebGPU adapter: {}", std::string_view(message.data, message.length));
+                        adapter = nullptr;
                     }
-                    *static_cast<WGPUAdapter*>(adapter_ptr) = adapter;
+                    static_cast<std::promise<WGPUAdapter>*>(promise_ptr)->set_value(adapter);
                 },
-                .userdata1 = &m_adapter
+                .userdata1 = &adapterPromise
             }
         );
-        while (!m_adapter) wgpuInstanceProcessEvents(m_instance);
-        assert(m_adapter);
+        m_adapter = WaitForWebGPU(m_instance, adapterFuture);
+        if (!m_adapter) return false;
 
         // 4. Request a Device
         WGPUDeviceDescriptor deviceDesc{};
@@ -119,26 +189,48 @@ namespace enDjinn {
             };
         deviceDesc.uncapturedErrorCallbackInfo.userdata1 = nullptr;
 
+        std::vector<WGPUFeatureName> requiredFeatures;
+#ifdef WEBGPU_BACKEND_DAWN
+        // Lets the render thread encode while the main thread uploads assets (see StartRenderThread)
+        if (wgpuAdapterHasFeature(m_adapter, WGPUFeatureName_ImplicitDeviceSynchronization)) {
+            requiredFeatures.push_back(WGPUFeatureName_ImplicitDeviceSynchronization);
+            m_deviceIsThreadSafe = true;
+        }
+#endif
+        // Pass timestamps, which dynamic resolution steers by
+        if (wgpuAdapterHasFeature(m_adapter, WGPUFeatureName_TimestampQuery)) {
+            requiredFeatures.push_back(WGPUFeatureName_TimestampQuery);
+            m_timestampsSupported = true;
+        }
+        deviceDesc.requiredFeatureCount = requiredFeatures.size();
+        deviceDesc.requiredFeatures = requiredFeatures.data();
+
+        // Persist compiled pipelines between runs (Dawn only)
+        m_pipelineRegistry.AttachDiskCache(deviceDesc, "pipeline_cache");
+
+        std::promise<WGPUDevice> devicePromise;
+        std::future<WGPUDevice> deviceFuture = devicePromise.get_future();
         wgpuAdapterRequestDevice(
             m_adapter,
             to_ptr(deviceDesc),
             WGPURequestDeviceCallbackInfo{
                 .mode = WGPUCallbackMode_AllowSpontaneous,
-                .callback = [](WGPURequestDeviceStatus status, WGPUDevice device, WGPUStringView message, void* device_ptr, void*) {
+                .callback = [](WGPURequestDeviceStatus status, WGPUDevice device, WGPUStringView message, void* promise_ptr, void*) {
                     if (status != WGPURequestDeviceStatus_Success) {
-                        std::cerr << "Failed to get a WebGPU device: " << std::string_view(message.data, message.length) << std::endl;
-                        glfwTerminate();
+                        spdlog::error("Failed to get a WebGPU device: {}", std::string_view(message.data, message.length));
+                        device = nullptr;
                     }
-                    *static_cast<WGPUDevice*>(device_ptr) = device;
+                    static_cast<std::promise<WGPUDevice>*>(promise_ptr)->set_value(device);
                 },
-                .userdata1 = &m_device
+                .userdata1 = &devicePromise
             }
         );
-        while (!m_device) wgpuInstanceProcessEvents(m_instance);
-        assert(m_device);
+        m_device = WaitForWebGPU(m_instance, deviceFuture);
+        if (!m_device) return false;
 
         // 5. Get the Queue
         m_queue = wgpuDeviceGetQueue(m_device);
+        m_pipelineRegistry.Startup(m_instance, m_device);
 
         m_uniformBuffer = wgpuDeviceCreateBuffer(m_device, to_ptr(WGPUBufferDescriptor{
             .label = WGPUStringView("Uniform Buffer", WGPU_STRLEN),
@@ -146,36 +238,16 @@ namespace enDjinn {
             .size = sizeof(Uniforms)
             }));
 
-		// Calculate initial projection matrix
-        int windowWidth, windowHeight;
-
-		// Get the current framebuffer size
-        glfwGetFramebufferSize(m_window, &windowWidth, &windowHeight);
-
-		// Calculate the projection matrix
-        Uniforms uniforms;
-        uniforms.projection = glm::mat4(1.0f); // Start with identity
-
-        // Scale x and y by 1/100 (World coordinates -100 to 100)
-        uniforms.projection[0][0] = uniforms.projection[1][1] = 1.0f / 100.0f;
-
-        // Apply aspect ratio correction (scaling the long edge down)
-        if (windowWidth < windowHeight) {
-            uniforms.projection[1][1] *= (float)windowWidth / (float)windowHeight;
-        }
-        else {
-            uniforms.projection[0][0] *= (float)windowHeight / (float)windowWidth;
-        }
-
-		// Upload the projection matrix to the uniform buffer
-        wgpuQueueWriteBuffer(m_queue, m_uniformBuffer, 0, &uniforms, sizeof(Uniforms));
-
 		// Create the Sampler
         m_sampler = wgpuDeviceCreateSampler(m_device, to_ptr(WGPUSamplerDescriptor{
              .addressModeU = WGPUAddressMode_ClampToEdge,
              .addressModeV = WGPUAddressMode_ClampToEdge,
              .magFilter = WGPUFilterMode_Linear,
              .minFilter = WGPUFilterMode_Linear,
+             // Cooked textures carry a full mip chain; loose textures only have level 0 and are unaffected
+             .mipmapFilter = WGPUMipmapFilterMode_Linear,
+             .lodMinClamp = 0.0f,
+             .lodMaxClamp = 32.0f,
              .maxAnisotropy = 1
             }));
         assert(m_sampler);
@@ -195,6 +267,7 @@ namespace enDjinn {
                 @location(1) texcoords: vec2f,
                 @location(2) translation: vec3f,
                 @location(3) scale: vec2f,
+                @location(4) uvRect: vec4f,
             };
     
             struct VertexOutput {
@@ -205,7 +278,7 @@ namespace enDjinn {
             @vertex fn vertex_shader_main(in: VertexInput) -> VertexOutput {
                 var out: VertexOutput;
                 out.position = uniforms.projection * vec4f(vec3f(in.scale * in.position, 0.0) + in.translation, 1.0);
-                out.texcoords = in.texcoords;
+                out.texcoords = in.uvRect.xy + in.texcoords * in.uvRect.zw;
                 return out;
             }
     
@@ -215,16 +288,7 @@ namespace enDjinn {
             }
             )";
 
-        // 7. Create the Shader Module
-        WGPUShaderSourceWGSL source_desc = {};
-        source_desc.chain.sType = WGPUSType_ShaderSourceWGSL;
-        source_desc.code = WGPUStringView(source, std::string_view(source).length());
-        // Point to the code descriptor from the shader descriptor.
-        WGPUShaderModuleDescriptor shader_desc = {};
-        shader_desc.nextInChain = &source_desc.chain;
-        WGPUShaderModule shader_module = wgpuDeviceCreateShaderModule(m_device, &shader_desc);
-
-        // 8. Create the Vertex Buffer
+        // 7. Create the Vertex Buffer
         const struct {
             float x, y;
             float u, v;
@@ -248,130 +312,65 @@ namespace enDjinn {
         }
         wgpuQueueWriteBuffer(m_queue, m_vertexBuffer, 0, vertices, sizeof(vertices));
 
-		// 9. Create the Render Pipeline
-        struct InstanceData {
-            vec3 translation;
-            vec2 scale;
-            // rotation? Would add if I decide to support the engine
-        };
-
-		// Configure the surface
-        glfwGetFramebufferSize(m_window, &width, &height);
-        wgpuSurfaceConfigure(m_surface, to_ptr(WGPUSurfaceConfiguration{
-            .device = m_device,
-            .format = wgpuSurfaceGetPreferredFormat(m_surface, m_adapter),
-            .usage = WGPUTextureUsage_RenderAttachment,
-            .width = (uint32_t)width,
-            .height = (uint32_t)height,
-            .presentMode = WGPUPresentMode_Fifo // Explicitly set this because of a Dawn bug
-            }));
-
-		// Create the render pipeline
-        m_renderPipeline = wgpuDeviceCreateRenderPipeline(m_device, to_ptr(WGPURenderPipelineDescriptor{
-            // Describe the vertex shader inputs
-            .vertex = {
-                .module = shader_module,
-                .entryPoint = WGPUStringView{ "vertex_shader_main", std::string_view("vertex_shader_main").length() },
-                // Vertex attributes.
-                .bufferCount = 2,
-                .buffers = to_ptr<WGPUVertexBufferLayout>({
-				// First buffer: static quad vertices
-                {
-                    .stepMode = WGPUVertexStepMode_Vertex,
-                    .arrayStride = 4 * sizeof(float),
-                    .attributeCount = 2,
-                    .attributes = to_ptr<WGPUVertexAttribute>({
-                        // Position x,y are first.
-                        {
-                            .format = WGPUVertexFormat_Float32x2,
-                            .offset = 0,
-                            .shaderLocation = 0
-                        },
-                        // Texture coordinates u,v are second.
-                        {
-                            .format = WGPUVertexFormat_Float32x2,
-                            .offset = 2 * sizeof(float),
-                            .shaderLocation = 1
-                        }
-                        })
-                },
-                    // We will use a second buffer with our per-sprite translation and scale. This data will be set in our draw function.
-                    {
-                        .stepMode = WGPUVertexStepMode_Instance,
-                        .arrayStride = sizeof(InstanceData),
-                        .attributeCount = 2,
-                        .attributes = to_ptr<WGPUVertexAttribute>({
-                        // Translation as a 3D vector.
-                        {
-                            .format = WGPUVertexFormat_Float32x3,
-                            .offset = offsetof(InstanceData, translation),
-                            .shaderLocation = 2
-                        },
-                            // Scale as a 2D vector for non-uniform scaling.
-                            {
-                                .format = WGPUVertexFormat_Float32x2,
-                                .offset = offsetof(InstanceData, scale),
-                                .shaderLocation = 3
-                            }
-                            })
-                    }
-                    })
-                },
-
-            // Interpret our 4 vertices as a triangle strip
-            .primitive = WGPUPrimitiveState{
-                .topology = WGPUPrimitiveTopology_TriangleStrip,
-                },
+		// Configure the surface for the framebuffer size captured with the window; this also uploads the projection
+        m_surfaceFormat = wgpuSurfaceGetPreferredFormat(m_surface, m_adapter);
+        ConfigureSurface(static_cast<uint32_t>(m_framebufferWidth), static_cast<uint32_t>(m_framebufferHeight));
+
+		// 8. Request the sprite pipeline variants. They compile in parallel in the background (or come from the
+		// pipeline cache); only the default Alpha variant is needed before the first frame.
+        const WGPUTextureFormat surfaceFormat = m_surfaceFormat;
+        const std::array<std::pair<BlendMode, const char*>, 4> blendModes = { {
+            { BlendMode::Alpha, "Sprite Pipeline (Alpha)" },
+            { BlendMode::Additive, "Sprite Pipeline (Additive)" },
+            { BlendMode::Multiply, "Sprite Pipeline (Multiply)" },
+            { BlendMode::Opaque, "Sprite Pipeline (Opaque)" }
+        } };
+        for (const auto& [blend, label] : blendModes) {
+            RenderPipelineDesc desc;
+            desc.label = label;
+            desc.shaderSource = source;
+            desc.vertexLayout = VertexLayout::QuadInstanced;
+            desc.blend = blend;
+            desc.format = surfaceFormat;
+            m_spritePipelines[static_cast<size_t>(blend)] = m_pipelineRegistry.Request(desc);
+        }
+        if (!m_pipelineRegistry.Wait(m_spritePipelines[static_cast<size_t>(BlendMode::Alpha)])) {
+            spdlog::error("Failed to create the sprite render pipeline.");
+        }
 
-                // No multi-sampling (1 sample per pixel, all bits on).
-                .multisample = WGPUMultisampleState{
-                    .count = 1,
-                    .mask = ~0u
-                    },
-
-            // Describe the fragment shader and its output
-            .fragment = to_ptr(WGPUFragmentState{
-                .module = shader_module,
-                .entryPoint = WGPUStringView{ "fragment_shader_main", std::string_view("fragment_shader_main").length() },
-
-                // Our fragment shader outputs a single color value per pixel.
-                .targetCount = 1,
-                .targets = to_ptr<WGPUColorTargetState>({
-                    {
-						// The format must match the surface's preferred format.
-                        .format = wgpuSurfaceGetPreferredFormat(m_surface, m_adapter),
-						// The images we want to draw may have transparency, so alpha blending is needed.
-                        // This will blend with whatever has already been drawn.
-                        .blend = to_ptr(WGPUBlendState{
-                        // Over blending for color
-                        .color = {
-                            .operation = WGPUBlendOperation_Add,
-                            .srcFactor = WGPUBlendFactor_SrcAlpha,
-                            .dstFactor = WGPUBlendFactor_OneMinusSrcAlpha
-                            },
-                            // Leave destination alpha alone
-                            .alpha = {
-                                .operation = WGPUBlendOperation_Add,
-                                .srcFactor = WGPUBlendFactor_Zero,
-                                .dstFactor = WGPUBlendFactor_One
-                                }
-                            }),
-                        .writeMask = WGPUColorWriteMask_All
-                    }})
-                })
-            }));
-        // Release the shader module
-        wgpuShaderModuleRelease(shader_module);
+		// The dynamic resolution upscale. Frames render at full resolution until it has compiled.
+        RenderPipelineDesc upscaleDesc;
+        upscaleDesc.label = "Upscale Pipeline";
+        upscaleDesc.shaderSource = UPSCALE_SHADER;
+        upscaleDesc.vertexLayout = VertexLayout::Quad;
+        upscaleDesc.blend = BlendMode::Opaque;
+        upscaleDesc.format = surfaceFormat;
+        m_upscalePipeline = m_pipelineRegistry.Request(upscaleDesc);
+
+		// 9. Start the GPU-driven sprite swarms, which share the surface format and quad
+        m_swarmSystem.Startup(m_device, m_queue, m_pipelineRegistry, surfaceFormat);
+        m_tilemapSystem.Startup(m_device);
+        m_particleSystem.Startup(m_device);
+        m_textSystem.Startup(m_device, m_pipelineRegistry, surfaceFormat);
+        CreateGpuTimers();
 
 		// Log successful startup messages
-        spdlog::info("Window created successfully.");
         spdlog::info("WebGPU initialized and pipeline created.");
 		spdlog::info("Graphics manager started up.");
+        return true;
     }
 
 	//  Shutdown method implementation
     void GraphicsManager::Shutdown() {
-        if (m_renderPipeline) wgpuRenderPipelineRelease(m_renderPipeline);
+        StopRenderThread();
+        ReleaseSceneTarget();
+        m_swarmSystem.Shutdown();
+        m_tilemapSystem.Shutdown();
+        m_particleSystem.Shutdown();
+        m_textSystem.Shutdown();
+        m_pipelineRegistry.Shutdown();
+        ReleaseGpuTimers();
+
         if (m_sampler) wgpuSamplerRelease(m_sampler);
         if (m_uniformBuffer) wgpuBufferRelease(m_uniformBuffer);
         if (m_vertexBuffer) wgpuBufferRelease(m_vertexBuffer);
@@ -391,10 +390,81 @@ namespace enDjinn {
 
 	// Draw method implementation
     void GraphicsManager::Draw() {
+        if (!m_device) return; // Headless, or startup failed
+		// 1. Wait for a free snapshot slot. Inline rendering has one slot, which is always free here.
+        std::unique_lock<std::mutex> lock(m_frameMutex);
+        m_frameRetired.wait(lock, [this]() { return m_queuedFrames < m_frames.size(); });
+        FrameSnapshot& frame = m_frames[(m_readIndex + m_queuedFrames) % m_frames.size()];
+        lock.unlock();
+
+		// 2. Capture the frame on this (the simulation) thread
+        BuildFrame(frame);
+
+		// 3. Hand it off, or render it right away
+        if (IsRenderThreadRunning()) {
+            lock.lock();
+            ++m_queuedFrames;
+            lock.unlock();
+            m_frameQueued.notify_one();
+        }
+        else {
+            RenderFrame(frame);
+            ReleaseFrame(frame);
+        }
+
+		// 4. Let the ResourceManager age and evict idle textures
+        m_resourceManager->EndFrame();
+
+		// 5. Stats overlay. Shown in the title bar, refreshed a few times per second.
+        if (Stats::Get().IsOverlayEnabled()) {
+            if (++m_overlayFrame % STATS_OVERLAY_INTERVAL == 0) {
+                glfwSetWindowTitle(m_window, (m_windowTitle + "  |  " + Stats::Get().FormatSummary()).c_str());
+                m_overlayShown = true;
+            }
+        }
+        else if (m_overlayShown) {
+            glfwSetWindowTitle(m_window, m_windowTitle.c_str());
+            m_overlayShown = false;
+        }
+    }
+
+	// GetSpritePipeline method implementation. Variants still compiling fall back to the Alpha pipeline.
+    WGPURenderPipeline GraphicsManager::GetSpritePipeline(BlendMode blend) const {
+        if (WGPURenderPipeline pipeline = m_pipelineRegistry.Get(m_spritePipelines[static_cast<size_t>(blend)])) {
+            return pipeline;
+        }
+        return m_pipelineRegistry.Get(m_spritePipelines[static_cast<size_t>(BlendMode::Alpha)]);
+    }
+
+	// BuildFrame method implementation. Queries the ECS and turns the sprites into instance data and draw batches.
+	// Touches Lua and the ResourceManager, so it must run on the main thread.
+    void GraphicsManager::BuildFrame(FrameSnapshot& frame) {
+        frame.instanceBuffer = nullptr;
+        frame.instanceCount = 0;
+        frame.batches.clear();
+        frame.width = static_cast<uint32_t>(std::max(m_framebufferWidth, 0));
+        frame.height = static_cast<uint32_t>(std::max(m_framebufferHeight, 0));
+
+		// 0. Swarms are captured first so they keep moving even when the ECS cannot be queried.
+		// Tilemaps are culled against the visible world area, which CalculateProjection fixes at 100 units
+		// from the center along the short edge.
+        if (m_resourceManager) {
+            m_swarmSystem.Capture(frame.swarms, *m_resourceManager);
+            m_particleSystem.Capture(frame.particles, *m_resourceManager);
+            for (ParticleFrame& particles : frame.particles) particles.pipeline = GetSpritePipeline(particles.blend);
+            m_textSystem.Capture(frame.texts, *m_resourceManager);
+            if (frame.width > 0 && frame.height > 0) {
+                glm::vec2 halfView(100.0f);
+                if (frame.width > frame.height) halfView.x *= static_cast<float>(frame.width) / frame.height;
+                else halfView.y *= static_cast<float>(frame.height) / frame.width;
+                m_tilemapSystem.Capture(frame.tilemaps, *m_resourceManager, glm::vec4(-halfView.x, -halfView.y, halfView.x, halfView.y));
+            }
+        }
+
 		// 1. Pre draw checks
         // We cannot draw if we don't have access to the script manager to query the ECS.
         if (!m_scriptManager) {
-            spdlog::warn("GraphicsManager::Draw: ScriptManager is not set. Cannot render entities.");
+            ENDJINN_WARN_EVERY(1000, "GraphicsManager::Draw: ScriptManager is not set. Cannot render entities.");
             return;
         }
 
@@ -404,21 +474,21 @@ namespace enDjinn {
         sol::protected_function ecs_foreach = lua["ECS"]["ForEach"];
 
         if (!ecs_foreach.valid()) {
-            spdlog::warn("GraphicsManager::Draw: ECS.ForEach not found in Lua. Cannot draw entities.");
+            ENDJINN_WARN_EVERY(1000, "GraphicsManager::Draw: ECS.ForEach not found in Lua. Cannot draw entities.");
             return;
         }
 
 		// 2. ECS Querying
         // This is the core change: Instead of receiving a vector, we build one
         // by querying the ECS for all entities that have a "Sprite" component.
-        std::vector<Sprite> sprites_from_ecs;
-        std::vector<std::string> components_to_query = { "Sprite" };
+        // The list lives in the frame arena and points at the components in Lua, so nothing is copied.
+        std::pmr::vector<const Sprite*> sprites_from_ecs(FrameArena::Get().Resource());
 
         // This C++ lambda is called from Lua for each entity that matches the query.
-        ecs_foreach(sol::as_table(components_to_query), [&](int entity_id) {
+        ecs_foreach(m_scriptManager->GetComponentQuery("Sprite"), [&](EntityId entity_id) {
             // Safely retrieve the Sprite component from the Lua table.
-            sol::optional<Sprite> sprite_comp = lua["ECS"]["Components"]["Sprite"][entity_id];
-            if (sprite_comp) {
+            sol::optional<Sprite*> sprite_comp = lua["ECS"]["Components"]["Sprite"][entity_id];
+            if (sprite_comp && *sprite_comp) {
                 sprites_from_ecs.push_back(*sprite_comp);
             }
             });
@@ -426,44 +496,203 @@ namespace enDjinn {
 		// 3. Sorting Sprites by Z-Order
         // Sort the collected sprites from back-to-front based on their Z-value.
         // This ensures correct alpha blending for transparent images.
-        std::sort(sprites_from_ecs.begin(), sprites_from_ecs.end(), [](const Sprite& lhs, const Sprite& rhs) {
-            return lhs.z > rhs.z; // Higher Z is farther away, so it's drawn first.
+        std::sort(sprites_from_ecs.begin(), sprites_from_ecs.end(), [](const Sprite* lhs, const Sprite* rhs) {
+            return lhs->z > rhs->z; // Higher Z is farther away, so it's drawn first.
+            });
+
+		// 4. Resolve textures and gather the sprites into structure-of-arrays form.
+        // Lookups touch the ResourceManager, so this pass is serial; it only looks up once per run of equal textures.
+        InstanceScratch& soa = m_instanceScratch;
+        soa.Resize(sprites_from_ecs.size());
+        size_t count = 0;
+        const std::string* currentTextureName = nullptr;
+        WGPUTexture currentTexture = nullptr;
+        BlendMode currentBlend = BlendMode::Alpha;
+        glm::vec2 textureSize(1.0f);
+
+        for (const Sprite* spritePtr : sprites_from_ecs) {
+            const Sprite& sprite = *spritePtr;
+            // An animated sprite draws its clip's sheet, at the current frame's rect
+            glm::vec4 uvRect = sprite.uvRect;
+            const std::string* textureName = &sprite.textureName;
+            if (sprite.animation) {
+                if (const AnimationClip* clip = m_animationSystem.Resolve(sprite.animation, uvRect)) {
+                    textureName = &clip->textureName;
+                }
+            }
+
+            bool newBatch = false;
+            if (!currentTextureName || *textureName != *currentTextureName) {
+                const Texture* loadedTexture = m_resourceManager->GetTexture(*textureName);
+                if (!loadedTexture || !loadedTexture->texture) {
+                    ENDJINN_WARN_EVERY(1000, "Skipping sprite with missing texture: '{}'", *textureName);
+                    continue; // Skip this sprite if its texture isn't loaded.
+                }
+                currentTextureName = textureName;
+                currentTexture = loadedTexture->texture;
+                textureSize = glm::vec2(static_cast<float>(loadedTexture->width), static_cast<float>(loadedTexture->height));
+                newBatch = true;
+            }
+
+            // Correct the sprite's scale based on the aspect ratio of the part of the image it shows.
+            const float rectWidth = textureSize.x * uvRect.z;
+            const float rectHeight = textureSize.y * uvRect.w;
+            glm::vec2 aspect_scale(1.0f);
+            if (rectWidth < rectHeight) {
+                aspect_scale.x = rectWidth / rectHeight;
+            }
+            else if (rectWidth > 0.0f) {
+                aspect_scale.y = rectHeight / rectWidth;
+            }
+
+            // Start a new batch whenever the texture or the blend mode changes. The snapshot holds its own reference
+            // to the texture, so eviction on the main thread cannot free it while the render thread still uses it.
+            if (newBatch || sprite.blend != currentBlend) {
+                currentBlend = sprite.blend;
+                wgpuTextureAddRef(currentTexture);
+                frame.batches.push_back({ currentTexture, GetSpritePipeline(currentBlend), static_cast<uint32_t>(count), 0 });
+            }
+
+            frame.batches.back().instanceCount++;
+            soa.x[count] = sprite.position.x;
+            soa.y[count] = sprite.position.y;
+            soa.z[count] = sprite.z;
+            soa.scaleX[count] = sprite.scale.x;
+            soa.scaleY[count] = sprite.scale.y;
+            soa.aspectX[count] = aspect_scale.x;
+            soa.aspectY[count] = aspect_scale.y;
+            soa.uvRect[count] = uvRect;
+            ++count;
+        }
+
+        if (count == 0) return;
+
+		// 5. Create the instance buffer mapped, so the instance data is written straight into upload memory
+        const uint64_t bufferSize = sizeof(InstanceData) * count;
+        frame.instanceCount = static_cast<uint32_t>(count);
+        frame.instanceBuffer = wgpuDeviceCreateBuffer(m_device, to_ptr<WGPUBufferDescriptor>({
+            .label = WGPUStringView("Instance Buffer", WGPU_STRLEN),
+            .usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Vertex,
+            .size = bufferSize,
+            .mappedAtCreation = true
+            }));
+        InstanceData* mapped = frame.instanceBuffer
+            ? static_cast<InstanceData*>(wgpuBufferGetMappedRange(frame.instanceBuffer, 0, bufferSize)) : nullptr;
+        if (!mapped) {
+            // Out of memory or device lost: drop this frame's sprites instead of writing through null
+            ENDJINN_ERROR_EVERY(1000, "GraphicsManager: Could not map the {} byte instance buffer, skipping this frame's sprites.", bufferSize);
+            if (frame.instanceBuffer) {
+                wgpuBufferUnmap(frame.instanceBuffer);
+                wgpuBufferRelease(frame.instanceBuffer);
+            }
+            frame.instanceBuffer = nullptr;
+            frame.instanceCount = 0;
+            for (const DrawBatch& batch : frame.batches) {
+                wgpuTextureRelease(batch.texture);
+            }
+            frame.batches.clear();
+            return;
+        }
+
+		// 6. Apply the aspect correction with SIMD and interleave into InstanceData, in chunks across the pool
+        ThreadPool::Get().ParallelFor(count, 4096, [&soa, mapped](size_t begin, size_t end) {
+            const size_t n = end - begin;
+            simd::Multiply(soa.scaleX.data() + begin, soa.aspectX.data() + begin, soa.scaleX.data() + begin, n);
+            simd::Multiply(soa.scaleY.data() + begin, soa.aspectY.data() + begin, soa.scaleY.data() + begin, n);
+
+            for (size_t i = begin; i < end; ++i) {
+                mapped[i].translation = glm::vec3(soa.x[i], soa.y[i], soa.z[i]);
+                mapped[i].scale = glm::vec2(soa.scaleX[i], soa.scaleY[i]);
+                mapped[i].uvRect = soa.uvRect[i];
+            }
             });
+        wgpuBufferUnmap(frame.instanceBuffer);
+
+        Stats& stats = Stats::Get();
+        stats.Add("gpu.instances", static_cast<double>(count));
+        stats.Add("gpu.upload_bytes", static_cast<double>(bufferSize));
+    }
 
-        size_t instanceCount = sprites_from_ecs.size();
+	// RenderFrame method implementation. Only uses WebGPU, so it can run on the render thread.
+    void GraphicsManager::RenderFrame(const FrameSnapshot& frame) {
+        size_t instanceCount = frame.instanceCount;
 
-		// 4. Render Pass Setup
+		// 1. Render Pass Setup
         // Create an encoder to build the command buffer.
         WGPUCommandEncoder encoder = wgpuDeviceCreateCommandEncoder(m_device, nullptr);
 
+        // Integrate the swarms before the render pass that draws them
+        m_swarmSystem.Encode(encoder, frame.swarms);
+
+        // Frames that cannot be presented still submit, so the swarms keep integrating
+        auto submitWithoutPresenting = [this, encoder]() {
+            WGPUCommandBuffer command_buffer = wgpuCommandEncoderFinish(encoder, nullptr);
+            wgpuQueueSubmit(m_queue, 1, &command_buffer);
+            wgpuCommandBufferRelease(command_buffer);
+            wgpuCommandEncoderRelease(encoder);
+            };
+
+        // Follow the window size. A minimized window has nothing to present.
+        if (frame.width == 0 || frame.height == 0) {
+            submitWithoutPresenting();
+            return;
+        }
+        if (frame.width != m_surfaceWidth || frame.height != m_surfaceHeight) {
+            ConfigureSurface(frame.width, frame.height);
+        }
+
         // Get the texture view from the window's surface that we will draw into.
         WGPUSurfaceTexture surface_texture{};
         wgpuSurfaceGetCurrentTexture(m_surface, &surface_texture);
+        if (surface_texture.status != WGPUSurfaceGetCurrentTextureStatus_SuccessOptimal &&
+            surface_texture.status != WGPUSurfaceGetCurrentTextureStatus_SuccessSuboptimal) {
+            // Outdated or lost, typically mid-resize: configure again and skip presenting this frame
+            if (surface_texture.texture) wgpuTextureRelease(surface_texture.texture);
+            ConfigureSurface(frame.width, frame.height);
+            submitWithoutPresenting();
+            return;
+        }
         WGPUTextureView current_texture_view = wgpuTextureCreateView(surface_texture.texture, nullptr);
 
+        // Under dynamic resolution the scene goes to the scaled offscreen target and is upscaled afterwards
+        WGPUTextureView scene_view = current_texture_view;
+        bool upscale = false;
+        if (m_dynamicResolution) {
+            upscale = PrepareSceneTarget(frame.width, frame.height);
+            if (upscale) scene_view = m_sceneView;
+        }
+        else if (m_sceneTexture) {
+            ReleaseSceneTarget();
+        }
+
+        // Time the scene pass, and the upscale after it, when a timing slot is free
+        const int timingSlot = BeginGpuTiming();
+        const PassTimestampWrites sceneTimestamps = {
+            .querySet = m_timestampQuerySet,
+            .beginningOfPassWriteIndex = static_cast<uint32_t>(timingSlot) * 2,
+            .endOfPassWriteIndex = upscale ? WGPU_QUERY_SET_INDEX_UNDEFINED : static_cast<uint32_t>(timingSlot) * 2 + 1
+        };
+
         // Begin the render pass. This clears the screen to our background color.
         WGPURenderPassEncoder render_pass = wgpuCommandEncoderBeginRenderPass(encoder, to_ptr<WGPURenderPassDescriptor>({
             .colorAttachmentCount = 1,
             .colorAttachments = to_ptr<WGPURenderPassColorAttachment>({{
-                .view = current_texture_view,
+                .view = scene_view,
                 .depthSlice = WGPU_DEPTH_SLICE_UNDEFINED,
                 .loadOp = WGPULoadOp_Clear,
                 .storeOp = WGPUStoreOp_Store,
                 .clearValue = WGPUColor{red, green, blue, 1.0} // Background color
-            }})
+            }}),
+            .timestampWrites = timingSlot >= 0 ? &sceneTimestamps : nullptr
             }));
 
+        // Tilemaps are the background, so they go first
+        m_tilemapSystem.Draw(render_pass, frame.tilemaps, GetSpritePipeline(BlendMode::Alpha), m_uniformBuffer, sizeof(Uniforms), m_sampler, m_vertexBuffer);
+
         // If there are no sprites, we still need to clear the screen, but we can skip the drawing logic.
         if (instanceCount > 0) {
-            // Create a GPU buffer large enough to hold the instance data for every sprite.
-            WGPUBuffer instance_buffer = wgpuDeviceCreateBuffer(m_device, to_ptr<WGPUBufferDescriptor>({
-                .label = WGPUStringView("Instance Buffer", WGPU_STRLEN),
-                .usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Vertex,
-                .size = sizeof(InstanceData) * instanceCount
-                }));
-
-            // Set the rendering pipeline that defines our shaders and vertex layouts.
-            wgpuRenderPassEncoderSetPipeline(render_pass, m_renderPipeline);
+            // The instance buffer was filled on the main thread when the snapshot was built.
+            WGPUBuffer instance_buffer = frame.instanceBuffer;
 
             // Set the static vertex buffer (the quad) to shader location slot 0.
             wgpuRenderPassEncoderSetVertexBuffer(render_pass, 0, m_vertexBuffer, 0, 4 * 4 * sizeof(float));
@@ -471,102 +700,420 @@ namespace enDjinn {
             // Set the dynamic instance buffer (translations/scales) to shader location slot 1.
             wgpuRenderPassEncoderSetVertexBuffer(render_pass, 1, instance_buffer, 0, sizeof(InstanceData) * instanceCount);
 
-			// 5. Main Draw Loop
-            std::string currentTextureName = ""; // Track the last used texture to optimize bind group changes.
-            WGPUBindGroup currentBindGroup = nullptr; // The currently active bind group.
-
-            for (size_t i = 0; i < instanceCount; ++i) {
-                const Sprite& sprite = sprites_from_ecs[i];
-
-				// A. Update Instance Data
-                InstanceData instance_data;
-                instance_data.translation = glm::vec3(sprite.position, sprite.z);
-
-                const Texture* loadedTexture = m_resourceManager->GetTexture(sprite.textureName);
-                if (!loadedTexture || !loadedTexture->texture) {
-                    spdlog::warn("Skipping sprite with missing texture: '{}'", sprite.textureName);
-                    continue; // Skip this sprite if its texture isn't loaded.
+			// 2. Main Draw Loop: one bind group and one instanced draw per batch
+            WGPURenderPipeline currentPipeline = nullptr;
+            uint32_t pipelineSwitches = 0;
+            WGPUBindGroupLayout layout = nullptr;
+            for (const DrawBatch& batch : frame.batches) {
+                if (!batch.pipeline) continue;
+
+                // Switch pipelines only when the blend mode changes. Each variant derives its own bind group layout.
+                if (batch.pipeline != currentPipeline) {
+                    currentPipeline = batch.pipeline;
+                    ++pipelineSwitches;
+                    wgpuRenderPassEncoderSetPipeline(render_pass, currentPipeline);
+                    if (layout) wgpuBindGroupLayoutRelease(layout);
+                    layout = wgpuRenderPipelineGetBindGroupLayout(currentPipeline, 0);
                 }
 
-                // Correct the sprite's scale based on the image's aspect ratio.
-                glm::vec2 aspect_scale(1.0f);
-                if (loadedTexture->width < loadedTexture->height) {
-                    aspect_scale.x = static_cast<float>(loadedTexture->width) / loadedTexture->height;
-                }
-                else {
-                    aspect_scale.y = static_cast<float>(loadedTexture->height) / loadedTexture->width;
-                }
-                instance_data.scale = sprite.scale * aspect_scale;
+                WGPUTextureView textureView = wgpuTextureCreateView(batch.texture, nullptr);
 
-                // Write this sprite's instance data to the GPU buffer at the correct offset.
-                wgpuQueueWriteBuffer(m_queue, instance_buffer, i * sizeof(InstanceData), &instance_data, sizeof(InstanceData));
+                std::array<WGPUBindGroupEntry, 3> entries{};
+                entries[0] = { .binding = 0, .buffer = m_uniformBuffer, .size = sizeof(Uniforms) };
+                entries[1] = { .binding = 1, .sampler = m_sampler };
+                entries[2] = { .binding = 2, .textureView = textureView };
 
-				// B. Update Bind Group if Texture Changed
-                if (sprite.textureName != currentTextureName) {
-                    if (currentBindGroup) {
-                        wgpuBindGroupRelease(currentBindGroup); // Release the old one.
-                    }
+                WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(m_device, to_ptr(WGPUBindGroupDescriptor{
+                    .layout = layout,
+                    .entryCount = entries.size(),
+                    .entries = entries.data()
+                    }));
 
-                    currentTextureName = sprite.textureName;
-                    WGPUTexture tex = loadedTexture->texture;
+                // The bind group now holds a reference to the view, so we can release our handle to it.
+                wgpuTextureViewRelease(textureView);
 
-                    WGPUBindGroupLayout layout = wgpuRenderPipelineGetBindGroupLayout(m_renderPipeline, 0);
-                    WGPUTextureView textureView = wgpuTextureCreateView(tex, nullptr);
+                wgpuRenderPassEncoderSetBindGroup(render_pass, 0, bindGroup, 0, nullptr);
+                // Draw 4 vertices (our quad) for every instance in the batch.
+                wgpuRenderPassEncoderDraw(render_pass, 4, batch.instanceCount, 0, batch.firstInstance);
 
-                    std::array<WGPUBindGroupEntry, 3> entries{};
-                    entries[0] = { .binding = 0, .buffer = m_uniformBuffer, .size = sizeof(Uniforms) };
-                    entries[1] = { .binding = 1, .sampler = m_sampler };
-                    entries[2] = { .binding = 2, .textureView = textureView };
+                // The render pass keeps the bind group alive until the commands have executed.
+                wgpuBindGroupRelease(bindGroup);
+            }
 
-                    currentBindGroup = wgpuDeviceCreateBindGroup(m_device, to_ptr(WGPUBindGroupDescriptor{
-                        .layout = layout,
-                        .entryCount = entries.size(),
-                        .entries = entries.data()
-                        }));
+			// 3. Cleanup after drawing all sprites
+            if (layout) wgpuBindGroupLayoutRelease(layout);
 
-                    // The bind group now holds a reference to the view, so we can release our handle to it.
-                    wgpuTextureViewRelease(textureView);
-                    wgpuBindGroupLayoutRelease(layout);
+            // Every batch is one draw with its own bind group, so draw calls also count the bind group changes
+            Stats& stats = Stats::Get();
+            stats.Add("gpu.draw_calls", static_cast<double>(frame.batches.size()));
+            stats.Add("gpu.pipeline_switches", pipelineSwitches);
+        }
 
-                    // Set the newly created bind group for subsequent draw calls.
-                    wgpuRenderPassEncoderSetBindGroup(render_pass, 0, currentBindGroup, 0, nullptr);
-                }
+        // Particles next, one instanced draw per emitter
+        m_particleSystem.Draw(render_pass, frame.particles, m_uniformBuffer, sizeof(Uniforms), m_sampler, m_vertexBuffer);
 
-				// C. Issue the Draw Call
-                // Draw 4 vertices (our quad) using 1 instance, starting at vertex 0 and instance `i`.
-                wgpuRenderPassEncoderDraw(render_pass, 4, 1, 0, static_cast<uint32_t>(i));
-            }
+        // Swarm sprites go on top; each swarm is one instanced draw reading the storage buffer
+        m_swarmSystem.Draw(render_pass, frame.swarms, m_uniformBuffer, sizeof(Uniforms), m_sampler, m_vertexBuffer);
 
-			// 6. Cleanup after drawing all sprites
-            if (currentBindGroup) {
-                wgpuBindGroupRelease(currentBindGroup);
-            }
-            wgpuBufferRelease(instance_buffer);
-        }
+        // Text last, one instanced draw per font
+        m_textSystem.Draw(render_pass, frame.texts, m_uniformBuffer, sizeof(Uniforms), m_sampler, m_vertexBuffer);
 
-		// 7. Finalize the Render Pass
+		// 4. Finalize the Render Pass, then upscale into the swapchain image if the scene went offscreen
         wgpuRenderPassEncoderEnd(render_pass);
+        if (upscale) EncodeUpscale(encoder, current_texture_view, timingSlot);
+        if (timingSlot >= 0) ResolveGpuTiming(encoder, timingSlot);
         WGPUCommandBuffer command_buffer = wgpuCommandEncoderFinish(encoder, nullptr);
         wgpuQueueSubmit(m_queue, 1, &command_buffer);
+        if (timingSlot >= 0) ReadGpuTiming(timingSlot);
         wgpuSurfacePresent(m_surface);
 
-		// 8. Release temporary resources
+        // Delivers the timestamp readbacks of earlier frames that have finished on the GPU
+        wgpuInstanceProcessEvents(m_instance);
+
+		// 5. Release temporary resources
+        wgpuRenderPassEncoderRelease(render_pass);
         wgpuTextureViewRelease(current_texture_view);
         wgpuTextureRelease(surface_texture.texture);
         wgpuCommandEncoderRelease(encoder);
         wgpuCommandBufferRelease(command_buffer);
     }
 
+	// ReleaseFrame method implementation. Drops the snapshot's GPU references; the batch vector keeps its capacity.
+    void GraphicsManager::ReleaseFrame(FrameSnapshot& frame) {
+        for (const DrawBatch& batch : frame.batches) {
+            wgpuTextureRelease(batch.texture);
+        }
+        frame.batches.clear();
+        SwarmSystem::Release(frame.swarms);
+        TilemapSystem::Release(frame.tilemaps);
+        ParticleSystem::Release(frame.particles);
+        TextSystem::Release(frame.texts);
+
+        if (frame.instanceBuffer) wgpuBufferRelease(frame.instanceBuffer);
+        frame.instanceBuffer = nullptr;
+        frame.instanceCount = 0;
+    }
+
+	// SetDynamicResolution method implementation. Takes effect from the next rendered frame.
+    void GraphicsManager::SetDynamicResolution(bool enabled, float targetGpuMs, float minScale) {
+        m_targetGpuMs = std::max(targetGpuMs, 1.0f);
+        m_minRenderScale = std::clamp(minScale, 0.25f, 1.0f);
+        m_dynamicResolution = enabled;
+        if (!enabled) m_renderScale = 1.0f;
+        spdlog::info("GraphicsManager: Dynamic resolution {} (target {:.1f} ms GPU, scale down to {:.2f}).",
+            enabled ? "on" : "off", m_targetGpuMs.load(), m_minRenderScale.load());
+    }
+
+	// FramebufferSizeCallback method implementation. GLFW calls it on the main thread while polling events;
+	// the size travels to the render side with the next frame snapshot.
+    void GraphicsManager::FramebufferSizeCallback(GLFWwindow* window, int width, int height) {
+        auto* graphics = static_cast<GraphicsManager*>(glfwGetWindowUserPointer(window));
+        if (!graphics) return;
+        graphics->m_framebufferWidth = width;
+        graphics->m_framebufferHeight = height;
+    }
+
+	// ConfigureSurface method implementation. Sizes the swapchain and recomputes the projection to match.
+    void GraphicsManager::ConfigureSurface(uint32_t width, uint32_t height) {
+        if (width == 0 || height == 0) return;
+
+        wgpuSurfaceConfigure(m_surface, to_ptr(WGPUSurfaceConfiguration{
+            .device = m_device,
+            .format = m_surfaceFormat,
+            .usage = WGPUTextureUsage_RenderAttachment,
+            .width = width,
+            .height = height,
+            .presentMode = WGPUPresentMode_Fifo // Explicitly set this because of a Dawn bug
+            }));
+        m_surfaceWidth = width;
+        m_surfaceHeight = height;
+
+        Uniforms uniforms;
+        CalculateProjection(uniforms.projection, width, height);
+        wgpuQueueWriteBuffer(m_queue, m_uniformBuffer, 0, &uniforms, sizeof(Uniforms));
+    }
+
+	// UpdateRenderScale method implementation. Steps down while the smoothed GPU time is over budget and back up
+	// once it is well under, at most once per cooldown so the target is not rebuilt every frame.
+    void GraphicsManager::UpdateRenderScale() {
+        const float gpuMs = m_gpuFrameMs;
+        if (gpuMs <= 0.0f) return; // Nothing measured yet
+        m_gpuFrameMsAverage = m_gpuFrameMsAverage > 0.0f ? m_gpuFrameMsAverage * 0.9f + gpuMs * 0.1f : gpuMs;
+        if (++m_framesSinceScaleChange < RENDER_SCALE_COOLDOWN) return;
+
+        const float target = m_targetGpuMs;
+        float scale = m_renderScale;
+        if (m_gpuFrameMsAverage > target) {
+            scale -= RENDER_SCALE_STEP;
+        }
+        else if (m_gpuFrameMsAverage < target * 0.75f) {
+            scale += RENDER_SCALE_STEP;
+        }
+        scale = std::clamp(scale, m_minRenderScale.load(), 1.0f);
+        if (scale != m_renderScale) {
+            m_renderScale = scale;
+            m_framesSinceScaleChange = 0;
+        }
+    }
+
+	// PrepareSceneTarget method implementation. Returns false when the frame should go straight to the swapchain:
+	// at full scale, or while the upscale pipeline is still compiling.
+    bool GraphicsManager::PrepareSceneTarget(uint32_t width, uint32_t height) {
+        UpdateRenderScale();
+        const float scale = m_renderScale;
+        Stats::Get().Set("gpu.render_scale", scale);
+
+        WGPURenderPipeline pipeline = m_pipelineRegistry.Get(m_upscalePipeline);
+        if (scale >= 1.0f || !pipeline) {
+            if (m_sceneTexture) ReleaseSceneTarget();
+            return false;
+        }
+
+        const uint32_t sceneWidth = std::max(1u, static_cast<uint32_t>(width * scale + 0.5f));
+        const uint32_t sceneHeight = std::max(1u, static_cast<uint32_t>(height * scale + 0.5f));
+        if (m_sceneTexture && sceneWidth == m_sceneWidth && sceneHeight == m_sceneHeight) return true;
+
+		// 1. (Re)create the target. Frames still in flight keep the old one alive through their command buffers.
+        ReleaseSceneTarget();
+        WGPUTextureDescriptor textureDesc{};
+        textureDesc.label = WGPUStringView("Scene Target", WGPU_STRLEN);
+        textureDesc.usage = WGPUTextureUsage_RenderAttachment | WGPUTextureUsage_TextureBinding;
+        textureDesc.dimension = WGPUTextureDimension_2D;
+        textureDesc.size = { sceneWidth, sceneHeight, 1 };
+        textureDesc.format = m_surfaceFormat;
+        textureDesc.mipLevelCount = 1;
+        textureDesc.sampleCount = 1;
+        m_sceneTexture = wgpuDeviceCreateTexture(m_device, &textureDesc);
+        if (!m_sceneTexture) return false;
+        m_sceneView = wgpuTextureCreateView(m_sceneTexture, nullptr);
+        m_sceneWidth = sceneWidth;
+        m_sceneHeight = sceneHeight;
+
+		// 2. The upscale reads it through a bind group that only changes with the target
+        WGPUBindGroupLayout layout = wgpuRenderPipelineGetBindGroupLayout(pipeline, 0);
+        std::array<WGPUBindGroupEntry, 2> entries{};
+        entries[0] = { .binding = 0, .sampler = m_sampler };
+        entries[1] = { .binding = 1, .textureView = m_sceneView };
+        m_upscaleBindGroup = wgpuDeviceCreateBindGroup(m_device, to_ptr(WGPUBindGroupDescriptor{
+            .layout = layout,
+            .entryCount = entries.size(),
+            .entries = entries.data()
+            }));
+        wgpuBindGroupLayoutRelease(layout);
+        return true;
+    }
+
+	// ReleaseSceneTarget method implementation
+    void GraphicsManager::ReleaseSceneTarget() {
+        if (m_upscaleBindGroup) wgpuBindGroupRelease(m_upscaleBindGroup);
+        if (m_sceneView) wgpuTextureViewRelease(m_sceneView);
+        if (m_sceneTexture) wgpuTextureRelease(m_sceneTexture);
+        m_upscaleBindGroup = nullptr;
+        m_sceneView = nullptr;
+        m_sceneTexture = nullptr;
+        m_sceneWidth = 0;
+        m_sceneHeight = 0;
+    }
+
+	// EncodeUpscale method implementation. One full-screen quad with linear filtering. A timed frame's end
+	// timestamp goes here, so the measurement covers the scene pass and the upscale.
+    void GraphicsManager::EncodeUpscale(WGPUCommandEncoder encoder, WGPUTextureView target, int timingSlot) {
+        const PassTimestampWrites timestamps = {
+            .querySet = m_timestampQuerySet,
+            .beginningOfPassWriteIndex = WGPU_QUERY_SET_INDEX_UNDEFINED,
+            .endOfPassWriteIndex = static_cast<uint32_t>(timingSlot) * 2 + 1
+        };
+        WGPURenderPassEncoder pass = wgpuCommandEncoderBeginRenderPass(encoder, to_ptr<WGPURenderPassDescriptor>({
+            .colorAttachmentCount = 1,
+            .colorAttachments = to_ptr<WGPURenderPassColorAttachment>({{
+                .view = target,
+                .depthSlice = WGPU_DEPTH_SLICE_UNDEFINED,
+                .loadOp = WGPULoadOp_Clear,
+                .storeOp = WGPUStoreOp_Store,
+                .clearValue = WGPUColor{red, green, blue, 1.0}
+            }}),
+            .timestampWrites = timingSlot >= 0 ? &timestamps : nullptr
+            }));
+        wgpuRenderPassEncoderSetPipeline(pass, m_pipelineRegistry.Get(m_upscalePipeline));
+        wgpuRenderPassEncoderSetBindGroup(pass, 0, m_upscaleBindGroup, 0, nullptr);
+        wgpuRenderPassEncoderSetVertexBuffer(pass, 0, m_vertexBuffer, 0, 4 * 4 * sizeof(float));
+        wgpuRenderPassEncoderDraw(pass, 4, 1, 0, 0);
+        wgpuRenderPassEncoderEnd(pass);
+        wgpuRenderPassEncoderRelease(pass);
+    }
+
+	// CreateGpuTimers method implementation. Without timestamp queries nothing is measured, and dynamic resolution
+	// keeps full scale rather than guess from CPU-side timings.
+    void GraphicsManager::CreateGpuTimers() {
+        if (!m_timestampsSupported) {
+            spdlog::warn("GraphicsManager: The adapter has no timestamp queries, so GPU frame time is not measured.");
+            return;
+        }
+
+        m_timestampQuerySet = wgpuDeviceCreateQuerySet(m_device, to_ptr(WGPUQuerySetDescriptor{
+            .label = WGPUStringView("GPU Timing Queries", WGPU_STRLEN),
+            .type = WGPUQueryType_Timestamp,
+            .count = GPU_TIMING_SLOTS * 2
+            }));
+        m_timestampResolveBuffer = wgpuDeviceCreateBuffer(m_device, to_ptr(WGPUBufferDescriptor{
+            .label = WGPUStringView("GPU Timing Resolve Buffer", WGPU_STRLEN),
+            .usage = WGPUBufferUsage_QueryResolve | WGPUBufferUsage_CopySrc,
+            .size = GPU_TIMING_STRIDE * GPU_TIMING_SLOTS
+            }));
+        for (uint32_t slot = 0; slot < GPU_TIMING_SLOTS; ++slot) {
+            m_timestampReadback[slot] = wgpuDeviceCreateBuffer(m_device, to_ptr(WGPUBufferDescriptor{
+                .label = WGPUStringView("GPU Timing Readback Buffer", WGPU_STRLEN),
+                .usage = WGPUBufferUsage_MapRead | WGPUBufferUsage_CopyDst,
+                .size = 2 * sizeof(uint64_t)
+                }));
+            m_timestampPending[slot] = false;
+        }
+        m_nextTimingSlot = 0;
+    }
+
+	// ReleaseGpuTimers method implementation. Pending readbacks complete with an error status and are dropped.
+    void GraphicsManager::ReleaseGpuTimers() {
+        for (WGPUBuffer& buffer : m_timestampReadback) {
+            if (buffer) wgpuBufferRelease(buffer);
+            buffer = nullptr;
+        }
+        if (m_timestampResolveBuffer) wgpuBufferRelease(m_timestampResolveBuffer);
+        if (m_timestampQuerySet) wgpuQuerySetRelease(m_timestampQuerySet);
+        m_timestampResolveBuffer = nullptr;
+        m_timestampQuerySet = nullptr;
+    }
+
+	// BeginGpuTiming method implementation. Returns the slot this frame writes its timestamps to, or -1.
+    int GraphicsManager::BeginGpuTiming() {
+        if (!m_timestampQuerySet) return -1;
+        const uint32_t slot = m_nextTimingSlot;
+        if (m_timestampPending[slot]) return -1; // The GPU is more than a ring behind; skip rather than stall
+        m_nextTimingSlot = (slot + 1) % GPU_TIMING_SLOTS;
+        return static_cast<int>(slot);
+    }
+
+	// ResolveGpuTiming method implementation. Encoded after the timed passes, in the same command buffer.
+    void GraphicsManager::ResolveGpuTiming(WGPUCommandEncoder encoder, int slot) {
+        const uint64_t offset = GPU_TIMING_STRIDE * slot;
+        wgpuCommandEncoderResolveQuerySet(encoder, m_timestampQuerySet, static_cast<uint32_t>(slot) * 2, 2, m_timestampResolveBuffer, offset);
+        wgpuCommandEncoderCopyBufferToBuffer(encoder, m_timestampResolveBuffer, offset, m_timestampReadback[slot], 0, 2 * sizeof(uint64_t));
+    }
+
+	// ReadGpuTiming method implementation. The map completes once the frame has finished on the GPU; its callback
+	// publishes the time between the two timestamps (nanoseconds) and frees the slot.
+    void GraphicsManager::ReadGpuTiming(int slot) {
+        m_timestampPending[slot] = true;
+        wgpuBufferMapAsync(m_timestampReadback[slot], WGPUMapMode_Read, 0, 2 * sizeof(uint64_t), WGPUBufferMapCallbackInfo{
+            .mode = WGPUCallbackMode_AllowSpontaneous,
+            .callback = [](WGPUMapAsyncStatus status, WGPUStringView, void* manager_ptr, void* slot_ptr) {
+                auto* graphics = static_cast<GraphicsManager*>(manager_ptr);
+                const size_t slot = reinterpret_cast<uintptr_t>(slot_ptr);
+                if (status == WGPUMapAsyncStatus_Success) {
+                    WGPUBuffer buffer = graphics->m_timestampReadback[slot];
+                    const auto* timestamps = static_cast<const uint64_t*>(wgpuBufferGetConstMappedRange(buffer, 0, 2 * sizeof(uint64_t)));
+                    // Timestamps can come back equal or reordered on some drivers; such samples are dropped
+                    if (timestamps && timestamps[1] > timestamps[0]) {
+                        const float gpuMs = static_cast<float>((timestamps[1] - timestamps[0]) * 1e-6);
+                        graphics->m_gpuFrameMs = gpuMs;
+                        Stats::Get().Set("gpu.frame_ms", gpuMs);
+                    }
+                    wgpuBufferUnmap(buffer);
+                }
+                graphics->m_timestampPending[slot] = false;
+            },
+            .userdata1 = this,
+            .userdata2 = reinterpret_cast<void*>(static_cast<uintptr_t>(slot))
+            });
+    }
+
+	// StartRenderThread method implementation
+    bool GraphicsManager::StartRenderThread(unsigned int framesInFlight) {
+        if (IsRenderThreadRunning()) return true;
+
+        // The main thread keeps uploading textures and buffers while the render thread encodes,
+        // which is only safe when the device serializes access itself.
+        if (!m_device || !m_deviceIsThreadSafe) {
+            spdlog::warn("GraphicsManager: Device is not thread-safe, rendering stays on the main thread.");
+            return false;
+        }
+
+        m_frames.clear();
+        m_frames.resize(std::clamp(framesInFlight, 1u, 3u));
+        m_readIndex = 0;
+        m_queuedFrames = 0;
+        m_stopRenderThread = false;
+        m_renderThread = std::thread([this]() { RenderThreadLoop(); });
+
+        spdlog::info("GraphicsManager: Render thread started with {} frame(s) in flight.", m_frames.size());
+        return true;
+    }
+
+	// StopRenderThread method implementation. Renders whatever is still queued, then joins.
+    void GraphicsManager::StopRenderThread() {
+        if (!IsRenderThreadRunning()) return;
+
+        {
+            std::lock_guard<std::mutex> lock(m_frameMutex);
+            m_stopRenderThread = true;
+        }
+        m_frameQueued.notify_one();
+        m_renderThread.join();
+
+        m_frames.clear();
+        m_frames.resize(1);
+        m_readIndex = 0;
+        m_queuedFrames = 0;
+        spdlog::info("GraphicsManager: Render thread stopped.");
+    }
+
+	// RenderThreadLoop method implementation
+    void GraphicsManager::RenderThreadLoop() {
+        std::unique_lock<std::mutex> lock(m_frameMutex);
+        for (;;) {
+            m_frameQueued.wait(lock, [this]() { return m_queuedFrames > 0 || m_stopRenderThread; });
+            if (m_queuedFrames == 0) return; // Stopping with nothing left to draw
+
+            FrameSnapshot& frame = m_frames[m_readIndex];
+            lock.unlock();
+
+            RenderFrame(frame);
+            ReleaseFrame(frame);
+
+            lock.lock();
+            m_readIndex = (m_readIndex + 1) % m_frames.size();
+            --m_queuedFrames;
+            m_frameRetired.notify_one();
+        }
+    }
+
 	// ShouldClose method implementation. Needed to close window from input
     bool GraphicsManager::ShouldClose() const {
         if (!m_window) {
-            spdlog::info("GraphicsManager::ShouldClose called before window was created.");
+            ENDJINN_INFO_EVERY(1000, "GraphicsManager::ShouldClose called before window was created.");
             return true;
         }
         return glfwWindowShouldClose(m_window);
     }
 
-	// CalculateProjection method implementation. Helper method to calculate projection matrix
+	// CalculateProjection method implementation. World coordinates run from -100 to 100 along the short edge
+	// of the framebuffer; the long edge shows proportionally more.
+    void GraphicsManager::CalculateProjection(glm::mat4& projection, unsigned int width, unsigned int height) {
+        projection = glm::mat4(1.0f); // Start with identity
+
+        // Scale x and y by 1/100 (World coordinates -100 to 100)
+        projection[0][0] = projection[1][1] = 1.0f / 100.0f;
+        if (width == 0 || height == 0) return;
+
+        // Apply aspect ratio correction (scaling the long edge down)
+        if (width < height) {
+            projection[1][1] *= (float)width / (float)height;
+        }
+        else {
+            projection[0][0] *= (float)height / (float)width;
+        }
+    }
+
+	// GetWindowDimensions method implementation
     void GraphicsManager::GetWindowDimensions(int& width, int& height) const {
         if (m_window) {
             // Use the GLFW function to get the current framebuffer size
@@ -577,7 +1124,7 @@ namespace enDjinn {
             // Fallback or error state
             width = 0;
             height = 0;
-            spdlog::warn("GraphicsManager::GetWindowDimensions called before window was created.");
+            ENDJINN_WARN_EVERY(1000, "GraphicsManager::GetWindowDimensions called before window was created.");
         }
     }
 
@@ -1,15 +1,29 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include "./assets/Sprite.h"
 #include <webgpu/webgpu.h>
 #include "./assets/ResourceManager.h"
+#include "./systems/SwarmSystem.h"
+#include "./systems/AnimationSystem.h"
+#include "./systems/TilemapSystem.h"
+#include "./systems/ParticleSystem.h"
+#include "./systems/TextSystem.h"
+#include "PipelineRegistry.h"
+#include <array>
 
 struct InstanceData {
     // Location 2 in WGSL: translation: vec3f
     glm::vec3 translation;
     // Location 3 in WGSL: scale: vec2f
     glm::vec2 scale;
+    // Location 4 in WGSL: uvRect: vec4f
+    glm::vec4 uvRect;
 };
 
 struct GLFWwindow;
@@ -18,30 +32,105 @@ namespace enDjinn {
 	// Forward declarations
     class ScriptManager;
 
+	// A run of consecutive instances that share one texture and blend mode, drawn with a single call
+    struct DrawBatch {
+        WGPUTexture texture = nullptr; // Referenced (AddRef) for as long as the snapshot is in flight
+        WGPURenderPipeline pipeline = nullptr; // Owned by the PipelineRegistry, which outlives every snapshot
+        uint32_t firstInstance = 0;
+        uint32_t instanceCount = 0;
+    };
+
+	// Everything the renderer needs for one frame, captured on the main thread.
+	// Once submitted it is immutable and owned by the render thread until it has been presented.
+    struct FrameSnapshot {
+        WGPUBuffer instanceBuffer = nullptr; // Written while mapped and unmapped before submission
+        uint32_t instanceCount = 0;
+        std::vector<DrawBatch> batches;
+        std::vector<SwarmFrame> swarms; // GPU-integrated sprites, drawn after the ECS sprites
+        std::vector<TilemapFrame> tilemaps; // Visible tilemap chunks, drawn before the ECS sprites
+        std::vector<ParticleFrame> particles; // One instanced draw per emitter, between the ECS sprites and the swarms
+        std::vector<TextFrame> texts; // One instanced draw per font, on top of everything
+        uint32_t width = 0;  // Framebuffer size when the frame was captured. Zero while minimized.
+        uint32_t height = 0;
+    };
+
     class GraphicsManager {
     public:
         GraphicsManager();
         ~GraphicsManager();
 
         void Startup(int width, int height, const std::string& title, bool fullscreen);
+        // Startup in two stages, for callers that overlap device acquisition with other work.
+        // CreateWindowAndSurface must run on the main thread; InitializeDevice may run on any thread.
+        bool CreateWindowAndSurface(int width, int height, const std::string& title, bool fullscreen);
+        bool InitializeDevice();
         void Shutdown();
 
+        // Captures the ECS sprites into a frame snapshot, then renders it here or hands it to the render thread
         void Draw();
 
+        // Render Thread
+        // Encoding, submission and presentation move to a dedicated thread while the next tick simulates.
+        // Up to 'framesInFlight' snapshots may be queued; Draw blocks when all of them are, bounding latency.
+        bool StartRenderThread(unsigned int framesInFlight = 2);
+        void StopRenderThread();
+        bool IsRenderThreadRunning() const { return m_renderThread.joinable(); }
+
+        // Dynamic resolution
+        // The scene renders into an offscreen target scaled from the framebuffer size and is upscaled to the
+        // swapchain in a final blit. The scale steps down while the GPU frame time is over targetGpuMs and back
+        // up when there is headroom, never below minScale.
+        void SetDynamicResolution(bool enabled, float targetGpuMs = 14.0f, float minScale = 0.5f);
+        bool IsDynamicResolutionEnabled() const { return m_dynamicResolution; }
+        float GetRenderScale() const { return m_renderScale; }
+
         void SetResourceManager(ResourceManager* rm) { m_resourceManager = rm; }
         void SetScriptManager(ScriptManager* sm) { m_scriptManager = sm; }
         bool ShouldClose() const;
         void CalculateProjection(glm::mat4& projection, unsigned int width, unsigned int height);
         GLFWwindow* GetWindow() const;
+        SwarmSystem* GetSwarmSystem() { return &m_swarmSystem; }
+        AnimationSystem* GetAnimationSystem() { return &m_animationSystem; }
+        TilemapSystem* GetTilemapSystem() { return &m_tilemapSystem; }
+        ParticleSystem* GetParticleSystem() { return &m_particleSystem; }
+        TextSystem* GetTextSystem() { return &m_textSystem; }
+        PipelineRegistry* GetPipelineRegistry() { return &m_pipelineRegistry; }
 
         WGPUDevice GetDevice() const;
         WGPUQueue GetQueue() const;
 
     private:
+        WGPURenderPipeline GetSpritePipeline(BlendMode blend) const;
+        void BuildFrame(FrameSnapshot& frame);
+        void RenderFrame(const FrameSnapshot& frame);
+        void ReleaseFrame(FrameSnapshot& frame);
+        void RenderThreadLoop();
         void GetWindowDimensions(int& width, int& height) const;
+        static void FramebufferSizeCallback(GLFWwindow* window, int width, int height);
+
+        // Render side. Called from whichever thread renders.
+        void ConfigureSurface(uint32_t width, uint32_t height);
+        void UpdateRenderScale();
+        bool PrepareSceneTarget(uint32_t width, uint32_t height);
+        void ReleaseSceneTarget();
+        void EncodeUpscale(WGPUCommandEncoder encoder, WGPUTextureView target, int timingSlot);
+        // GPU pass timing from timestamp queries. A slot is -1 when this frame goes untimed.
+        void CreateGpuTimers();
+        void ReleaseGpuTimers();
+        int BeginGpuTiming();
+        void ResolveGpuTiming(WGPUCommandEncoder encoder, int slot);
+        void ReadGpuTiming(int slot);
         ResourceManager* m_resourceManager = nullptr;
 		ScriptManager* m_scriptManager = nullptr;
         GLFWwindow* m_window = nullptr;
+        int m_framebufferWidth = 0;
+        int m_framebufferHeight = 0;
+        std::string m_windowTitle;
+
+        // Stats overlay (Stats::SetOverlayEnabled), shown in the title bar since the engine bundles no font
+        static constexpr uint64_t STATS_OVERLAY_INTERVAL = 15; // Frames between refreshes
+        uint64_t m_overlayFrame = 0;
+        bool m_overlayShown = false;
 
         // WebGPU objects
         WGPUInstance m_instance = nullptr;
@@ -54,7 +143,69 @@ namespace enDjinn {
         WGPUBuffer m_vertexBuffer = nullptr;
         WGPUBuffer m_uniformBuffer = nullptr;
         WGPUSampler m_sampler = nullptr;
-        WGPURenderPipeline m_renderPipeline = nullptr;
+        WGPUTextureFormat m_surfaceFormat = WGPUTextureFormat_Undefined;
+        uint32_t m_surfaceWidth = 0; // Size the surface is configured for
+        uint32_t m_surfaceHeight = 0;
+
+        // Dynamic resolution. The settings may change from any thread; the rest belongs to the render side.
+        static constexpr float RENDER_SCALE_STEP = 0.05f;
+        static constexpr uint32_t RENDER_SCALE_COOLDOWN = 10; // Frames between scale changes, so measurements settle
+        std::atomic<bool> m_dynamicResolution{ false };
+        std::atomic<float> m_targetGpuMs{ 14.0f };
+        std::atomic<float> m_minRenderScale{ 0.5f };
+        std::atomic<float> m_renderScale{ 1.0f };
+        std::atomic<float> m_gpuFrameMs{ 0.0f }; // Render and upscale passes of the last timed frame
+        float m_gpuFrameMsAverage = 0.0f;
+        uint32_t m_framesSinceScaleChange = 0;
+        WGPUTexture m_sceneTexture = nullptr;
+        WGPUTextureView m_sceneView = nullptr;
+        WGPUBindGroup m_upscaleBindGroup = nullptr;
+        uint32_t m_sceneWidth = 0;
+        uint32_t m_sceneHeight = 0;
+        PipelineHandle m_upscalePipeline = INVALID_PIPELINE;
+
+        // GPU timing ring. Each slot owns a begin and an end timestamp and a readback buffer; a slot is reused once
+        // its readback has been mapped and read, and frames that find the next slot still in flight go untimed.
+        static constexpr uint32_t GPU_TIMING_SLOTS = 4;
+        static constexpr uint64_t GPU_TIMING_STRIDE = 256; // Query resolve offsets must be 256-byte aligned
+        WGPUQuerySet m_timestampQuerySet = nullptr;
+        WGPUBuffer m_timestampResolveBuffer = nullptr;
+        std::array<WGPUBuffer, GPU_TIMING_SLOTS> m_timestampReadback{};
+        std::array<std::atomic<bool>, GPU_TIMING_SLOTS> m_timestampPending{};
+        uint32_t m_nextTimingSlot = 0;
+        bool m_timestampsSupported = false;
+
+        // Pipelines. Every sprite blend mode is requested at startup; only Alpha is waited for.
+        PipelineRegistry m_pipelineRegistry;
+        std::array<PipelineHandle, 4> m_spritePipelines{};
+
+        // Structure-of-arrays scratch for instance building, reused every frame
+        struct InstanceScratch {
+            std::vector<float> x, y, z, scaleX, scaleY, aspectX, aspectY;
+            std::vector<glm::vec4> uvRect;
+            void Resize(size_t count) {
+                for (std::vector<float>* column : { &x, &y, &z, &scaleX, &scaleY, &aspectX, &aspectY }) column->resize(count);
+                uvRect.resize(count);
+            }
+        };
+        InstanceScratch m_instanceScratch;
+
+        SwarmSystem m_swarmSystem;
+        AnimationSystem m_animationSystem;
+        TilemapSystem m_tilemapSystem;
+        ParticleSystem m_particleSystem;
+        TextSystem m_textSystem;
+
+        // Frame snapshot ring. Slots [m_readIndex, m_readIndex + m_queuedFrames) are owned by the render thread.
+        std::vector<FrameSnapshot> m_frames = std::vector<FrameSnapshot>(1);
+        size_t m_readIndex = 0;
+        size_t m_queuedFrames = 0;
+        bool m_stopRenderThread = false;
+        bool m_deviceIsThreadSafe = false;
+        std::thread m_renderThread;
+        std::mutex m_frameMutex;
+        std::condition_variable m_frameQueued;
+        std::condition_variable m_frameRetired;
     };
 
 } // namespace enDjinn
\ No newline at end of file
@@ -2,6 +2,10 @@
 #include <iostream>
 #include <GLFW/glfw3.h>
 #include <spdlog/spdlog.h>
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
 
 namespace enDjinn {
 
@@ -10,8 +14,10 @@ namespace enDjinn {
 
 	// IsKeyPressed method implementation. Checks if a key is currently pressed and/or held down
     bool InputManager::IsKeyPressed(int key) const {
-		if (!m_window) { //Safety check and logs
-            spdlog::info("InputManager: Window is null, cannot check key.");
+        if (m_injectedKeys.count(key)) {
+            return true;
+        }
+		if (!m_window) { // Headless: injected keys are the only input
             return false;
         }
 
@@ -24,4 +30,75 @@ namespace enDjinn {
         return false;
     }
 
-} // namespace enDjinn
\ No newline at end of file
+    void InputManager::InjectKey(int key, bool pressed) {
+        if (pressed) {
+            m_injectedKeys.insert(key);
+        }
+        else {
+            m_injectedKeys.erase(key);
+        }
+    }
+
+    void InputManager::ClearInjectedKeys() {
+        m_injectedKeys.clear();
+    }
+
+	// ParseKey helper. Accepts GLFW key codes, single letters and digits (GLFW uses their ASCII codes) and a few names.
+    static int ParseKey(const std::string& token) {
+        if (token.size() == 1 && std::isalnum(static_cast<unsigned char>(token[0]))) {
+            return std::toupper(static_cast<unsigned char>(token[0]));
+        }
+        if (!token.empty() && std::all_of(token.begin(), token.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })) {
+            return std::stoi(token);
+        }
+        if (token == "SPACE") return GLFW_KEY_SPACE;
+        if (token == "ENTER") return GLFW_KEY_ENTER;
+        if (token == "ESCAPE") return GLFW_KEY_ESCAPE;
+        if (token == "LEFT_SHIFT") return GLFW_KEY_LEFT_SHIFT;
+        return GLFW_KEY_UNKNOWN;
+    }
+
+	// LoadInputScript method implementation. Replaces any previous script; playback starts at tick 0.
+    bool InputManager::LoadInputScript(const std::string& path) {
+        std::ifstream file(path);
+        if (!file) {
+            spdlog::error("InputManager: Failed to open input script '{}'.", path);
+            return false;
+        }
+
+        std::vector<InputEvent> events;
+        std::string line;
+        int lineNumber = 0;
+        while (std::getline(file, line)) {
+            ++lineNumber;
+            std::istringstream fields(line);
+            std::string tick, key, action;
+            if (!(fields >> tick) || tick[0] == '#') continue;
+
+            fields >> key >> action;
+            const int keyCode = ParseKey(key);
+            const bool valid = std::all_of(tick.begin(), tick.end(), [](char c) { return std::isdigit(static_cast<unsigned char>(c)); })
+                && keyCode != GLFW_KEY_UNKNOWN && (action == "down" || action == "up");
+            if (!valid) {
+                spdlog::warn("InputManager: {}:{}: expected '<tick> <key> <down|up>', skipping.", path, lineNumber);
+                continue;
+            }
+            events.push_back({ std::stoull(tick), keyCode, action == "down" });
+        }
+
+        // Stable, so events on the same tick apply in file order
+        std::stable_sort(events.begin(), events.end(), [](const InputEvent& a, const InputEvent& b) { return a.tick < b.tick; });
+        m_script = std::move(events);
+        m_nextEvent = 0;
+        spdlog::info("InputManager: Loaded {} input events from '{}'.", m_script.size(), path);
+        return true;
+    }
+
+    void InputManager::AdvanceTick(uint64_t tick) {
+        while (m_nextEvent < m_script.size() && m_script[m_nextEvent].tick <= tick) {
+            const InputEvent& event = m_script[m_nextEvent++];
+            InjectKey(event.key, event.pressed);
+        }
+    }
+
+} // namespace enDjinn
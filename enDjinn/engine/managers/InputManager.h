@@ -1,6 +1,10 @@
 #pragma once
 
 #include <GLFW/glfw3.h>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
 
 namespace enDjinn {
 
@@ -8,12 +12,32 @@ namespace enDjinn {
 
 
     public:
+        // The window may be null (headless runs); then only injected keys read as pressed
         InputManager(GLFWwindow* window);
 
         bool IsKeyPressed(int key) const;
 
+        // Injected keys count as pressed on top of the real keyboard
+        void InjectKey(int key, bool pressed);
+        void ClearInjectedKeys();
+
+        // Input script: one "<tick> <key> <down|up>" event per line, where key is a GLFW key code, a letter or
+        // digit, or SPACE/ENTER/ESCAPE/LEFT_SHIFT. Lines starting with '#' are comments.
+        bool LoadInputScript(const std::string& path);
+        // Applies the scripted events due at the start of this simulation tick
+        void AdvanceTick(uint64_t tick);
+
     private:
+        struct InputEvent {
+            uint64_t tick;
+            int key;
+            bool pressed;
+        };
+
         GLFWwindow* m_window;
+        std::unordered_set<int> m_injectedKeys;
+        std::vector<InputEvent> m_script; // Sorted by tick
+        size_t m_nextEvent = 0;
     };
 
 } // namespace enDjinn
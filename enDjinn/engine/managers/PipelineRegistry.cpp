@@ -0,0 +1,383 @@
+#include "PipelineRegistry.h"
+#include "GraphicsManager.h"
+#include "spdlog/spdlog.h"
+#include "spdlog/fmt/fmt.h"
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <thread>
+
+namespace {
+    WGPUStringView ToStringView(const std::string& text) {
+        return WGPUStringView{ text.data(), text.length() };
+    }
+
+	// FNV-1a, used to turn arbitrary cache keys into file names
+    uint64_t HashBytes(const void* data, size_t size) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        uint64_t hash = 14695981039346656037ull;
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+	// Blend state for each mode. Destination alpha is always left alone, as for the original sprite pipeline.
+    bool GetBlendState(enDjinn::BlendMode mode, WGPUBlendState& state) {
+        const WGPUBlendComponent keepAlpha = { WGPUBlendOperation_Add, WGPUBlendFactor_Zero, WGPUBlendFactor_One };
+        switch (mode) {
+        case enDjinn::BlendMode::Alpha:
+            state = { { WGPUBlendOperation_Add, WGPUBlendFactor_SrcAlpha, WGPUBlendFactor_OneMinusSrcAlpha }, keepAlpha };
+            return true;
+        case enDjinn::BlendMode::Additive:
+            state = { { WGPUBlendOperation_Add, WGPUBlendFactor_SrcAlpha, WGPUBlendFactor_One }, keepAlpha };
+            return true;
+        case enDjinn::BlendMode::Multiply:
+            state = { { WGPUBlendOperation_Add, WGPUBlendFactor_Dst, WGPUBlendFactor_Zero }, keepAlpha };
+            return true;
+        case enDjinn::BlendMode::Opaque:
+        default:
+            return false;
+        }
+    }
+}
+
+namespace enDjinn {
+
+    PipelineRegistry::~PipelineRegistry() {
+        Shutdown();
+    }
+
+	// AttachDiskCache method. Chains Dawn's cache descriptor so the device loads and stores compiled blobs through us.
+    void PipelineRegistry::AttachDiskCache(WGPUDeviceDescriptor& deviceDesc, const std::filesystem::path& directory) {
+#ifdef WEBGPU_BACKEND_DAWN
+        std::error_code ec;
+        std::filesystem::create_directories(directory, ec);
+        if (ec) {
+            spdlog::warn("PipelineRegistry: Cannot create pipeline cache directory '{}': {}", directory.string(), ec.message());
+            return;
+        }
+
+        m_diskCache = std::make_unique<DiskCache>();
+        m_diskCache->directory = directory;
+
+        m_cacheDescriptor = {};
+        m_cacheDescriptor.chain.sType = WGPUSType_DawnCacheDeviceDescriptor;
+        m_cacheDescriptor.chain.next = deviceDesc.nextInChain;
+        m_cacheDescriptor.isolationKey = WGPUStringView{ "enDjinn", WGPU_STRLEN };
+        m_cacheDescriptor.loadDataFunction = &DiskCache::Load;
+        m_cacheDescriptor.storeDataFunction = &DiskCache::Store;
+        m_cacheDescriptor.functionUserdata = m_diskCache.get();
+        deviceDesc.nextInChain = &m_cacheDescriptor.chain;
+        spdlog::info("PipelineRegistry: Pipeline cache at '{}'.", directory.string());
+#else
+        (void)deviceDesc;
+        (void)directory;
+#endif
+    }
+
+    void PipelineRegistry::Startup(WGPUInstance instance, WGPUDevice device) {
+        m_instance = instance;
+        m_device = device;
+    }
+
+	// Shutdown method. Lets in-flight compilations finish so no callback outlives the registry.
+    void PipelineRegistry::Shutdown() {
+        if (m_device) WaitAll();
+
+        for (std::unique_ptr<Entry>& entry : m_entries) {
+            if (entry->render) wgpuRenderPipelineRelease(entry->render);
+            if (entry->compute) wgpuComputePipelineRelease(entry->compute);
+        }
+        m_entries.clear();
+        m_byKey.clear();
+
+        for (auto& [source, module] : m_shaderModules) {
+            wgpuShaderModuleRelease(module);
+        }
+        m_shaderModules.clear();
+
+        if (m_diskCache) {
+            spdlog::info("PipelineRegistry: Pipeline cache {} hit(s), {} miss(es), {} blob(s) written.",
+                m_diskCache->hits.load(), m_diskCache->misses.load(), m_diskCache->stores.load());
+        }
+        m_instance = nullptr;
+        m_device = nullptr;
+    }
+
+	// Request method. Deduplicates on the full descriptor, then starts an asynchronous compilation.
+    PipelineHandle PipelineRegistry::Request(const RenderPipelineDesc& desc) {
+        if (!m_device) return INVALID_PIPELINE;
+
+		// 1. The key covers everything that affects the compiled pipeline; the label does not
+        const std::string key = fmt::format("render|{:016x}|{}|{}|{}|{}|{}|{:x}",
+            HashBytes(desc.shaderSource.data(), desc.shaderSource.size()), desc.vertexEntry, desc.fragmentEntry,
+            static_cast<int>(desc.vertexLayout), static_cast<int>(desc.blend), static_cast<int>(desc.format),
+            reinterpret_cast<uintptr_t>(desc.layout));
+        if (PipelineHandle existing = Find(key)) return existing;
+
+        const PipelineHandle handle = AddEntry(key, desc.label);
+        Entry* entry = m_entries[handle - 1].get();
+        WGPUShaderModule module = GetShaderModule(desc.shaderSource);
+
+		// 2. Vertex inputs: the quad, optionally followed by the per-instance translation, scale and UV rect
+        const std::vector<WGPUVertexAttribute> quadAttributes = {
+            { .format = WGPUVertexFormat_Float32x2, .offset = 0, .shaderLocation = 0 },
+            { .format = WGPUVertexFormat_Float32x2, .offset = 2 * sizeof(float), .shaderLocation = 1 }
+        };
+        const std::vector<WGPUVertexAttribute> instanceAttributes = {
+            { .format = WGPUVertexFormat_Float32x3, .offset = offsetof(InstanceData, translation), .shaderLocation = 2 },
+            { .format = WGPUVertexFormat_Float32x2, .offset = offsetof(InstanceData, scale), .shaderLocation = 3 },
+            { .format = WGPUVertexFormat_Float32x4, .offset = offsetof(InstanceData, uvRect), .shaderLocation = 4 }
+        };
+        std::vector<WGPUVertexBufferLayout> buffers = {
+            { .stepMode = WGPUVertexStepMode_Vertex, .arrayStride = 4 * sizeof(float),
+              .attributeCount = quadAttributes.size(), .attributes = quadAttributes.data() }
+        };
+        if (desc.vertexLayout == VertexLayout::QuadInstanced) {
+            buffers.push_back({ .stepMode = WGPUVertexStepMode_Instance, .arrayStride = sizeof(InstanceData),
+                .attributeCount = instanceAttributes.size(), .attributes = instanceAttributes.data() });
+        }
+
+		// 3. Fragment output and blending
+        WGPUBlendState blend{};
+        const bool blended = GetBlendState(desc.blend, blend);
+        const WGPUColorTargetState target = {
+            .format = desc.format,
+            .blend = blended ? &blend : nullptr,
+            .writeMask = WGPUColorWriteMask_All
+        };
+        const WGPUFragmentState fragment = {
+            .module = module,
+            .entryPoint = ToStringView(desc.fragmentEntry),
+            .targetCount = 1,
+            .targets = &target
+        };
+
+        const WGPURenderPipelineDescriptor pipelineDesc = {
+            .label = ToStringView(entry->label),
+            .layout = desc.layout,
+            .vertex = {
+                .module = module,
+                .entryPoint = ToStringView(desc.vertexEntry),
+                .bufferCount = buffers.size(),
+                .buffers = buffers.data()
+            },
+            .primitive = { .topology = WGPUPrimitiveTopology_TriangleStrip },
+            .multisample = { .count = 1, .mask = ~0u },
+            .fragment = &fragment
+        };
+
+		// 4. Compile off the calling thread. The callback may fire spontaneously on a Dawn worker.
+        m_pending++;
+        wgpuDeviceCreateRenderPipelineAsync(m_device, &pipelineDesc, WGPUCreateRenderPipelineAsyncCallbackInfo{
+            .mode = WGPUCallbackMode_AllowSpontaneous,
+            .callback = [](WGPUCreatePipelineAsyncStatus status, WGPURenderPipeline pipeline, WGPUStringView message, void* registry_ptr, void* entry_ptr) {
+                auto* registry = static_cast<PipelineRegistry*>(registry_ptr);
+                auto* entry = static_cast<Entry*>(entry_ptr);
+                {
+                    std::lock_guard<std::mutex> lock(registry->m_mutex);
+                    entry->render = pipeline;
+                    entry->failed = status != WGPUCreatePipelineAsyncStatus_Success;
+                    entry->done = true;
+                }
+                if (entry->failed) {
+                    spdlog::error("PipelineRegistry: Failed to create pipeline '{}': {}", entry->label, std::string_view(message.data, message.length));
+                }
+                registry->m_pending--;
+            },
+            .userdata1 = this,
+            .userdata2 = entry
+            });
+        return handle;
+    }
+
+	// RequestCompute method. Same as Request, for compute pipelines.
+    PipelineHandle PipelineRegistry::RequestCompute(const ComputePipelineDesc& desc) {
+        if (!m_device) return INVALID_PIPELINE;
+
+        const std::string key = fmt::format("compute|{:016x}|{}|{:x}",
+            HashBytes(desc.shaderSource.data(), desc.shaderSource.size()), desc.entryPoint,
+            reinterpret_cast<uintptr_t>(desc.layout));
+        if (PipelineHandle existing = Find(key)) return existing;
+
+        const PipelineHandle handle = AddEntry(key, desc.label);
+        Entry* entry = m_entries[handle - 1].get();
+
+        const WGPUComputePipelineDescriptor pipelineDesc = {
+            .label = ToStringView(entry->label),
+            .layout = desc.layout,
+            .compute = {
+                .module = GetShaderModule(desc.shaderSource),
+                .entryPoint = ToStringView(desc.entryPoint)
+            }
+        };
+
+        m_pending++;
+        wgpuDeviceCreateComputePipelineAsync(m_device, &pipelineDesc, WGPUCreateComputePipelineAsyncCallbackInfo{
+            .mode = WGPUCallbackMode_AllowSpontaneous,
+            .callback = [](WGPUCreatePipelineAsyncStatus status, WGPUComputePipeline pipeline, WGPUStringView message, void* registry_ptr, void* entry_ptr) {
+                auto* registry = static_cast<PipelineRegistry*>(registry_ptr);
+                auto* entry = static_cast<Entry*>(entry_ptr);
+                {
+                    std::lock_guard<std::mutex> lock(registry->m_mutex);
+                    entry->compute = pipeline;
+                    entry->failed = status != WGPUCreatePipelineAsyncStatus_Success;
+                    entry->done = true;
+                }
+                if (entry->failed) {
+                    spdlog::error("PipelineRegistry: Failed to create compute pipeline '{}': {}", entry->label, std::string_view(message.data, message.length));
+                }
+                registry->m_pending--;
+            },
+            .userdata1 = this,
+            .userdata2 = entry
+            });
+        return handle;
+    }
+
+    WGPURenderPipeline PipelineRegistry::Get(PipelineHandle handle) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Entry* entry = GetEntry(handle);
+        return entry ? entry->render : nullptr;
+    }
+
+    WGPUComputePipeline PipelineRegistry::GetCompute(PipelineHandle handle) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Entry* entry = GetEntry(handle);
+        return entry ? entry->compute : nullptr;
+    }
+
+	// Wait method. Returns whether the pipeline compiled successfully.
+    bool PipelineRegistry::Wait(PipelineHandle handle) {
+        if (handle == INVALID_PIPELINE) return false;
+        while (!IsDone(handle)) {
+            wgpuInstanceProcessEvents(m_instance);
+            std::this_thread::yield();
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Entry* entry = GetEntry(handle);
+        return entry && !entry->failed;
+    }
+
+    void PipelineRegistry::WaitAll() {
+        while (m_pending > 0) {
+            wgpuInstanceProcessEvents(m_instance);
+            std::this_thread::yield();
+        }
+    }
+
+    size_t PipelineRegistry::GetPipelineCount() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+    PipelineHandle PipelineRegistry::Find(const std::string& key) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_byKey.find(key);
+        return it != m_byKey.end() ? it->second : INVALID_PIPELINE;
+    }
+
+    PipelineHandle PipelineRegistry::AddEntry(const std::string& key, const std::string& label) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto entry = std::make_unique<Entry>();
+        entry->label = label;
+        m_entries.push_back(std::move(entry));
+        const PipelineHandle handle = static_cast<PipelineHandle>(m_entries.size());
+        m_byKey[key] = handle;
+        return handle;
+    }
+
+	// GetShaderModule method. One module per distinct source; pipelines keep their own reference.
+    WGPUShaderModule PipelineRegistry::GetShaderModule(const std::string& source) {
+        auto it = m_shaderModules.find(source);
+        if (it != m_shaderModules.end()) return it->second;
+
+        WGPUShaderSourceWGSL source_desc = {};
+        source_desc.chain.sType = WGPUSType_ShaderSourceWGSL;
+        source_desc.code = ToStringView(source);
+        WGPUShaderModuleDescriptor shader_desc = {};
+        shader_desc.nextInChain = &source_desc.chain;
+        WGPUShaderModule module = wgpuDeviceCreateShaderModule(m_device, &shader_desc);
+        m_shaderModules.emplace(source, module);
+        return module;
+    }
+
+    bool PipelineRegistry::IsDone(PipelineHandle handle) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const Entry* entry = GetEntry(handle);
+        return !entry || entry->done;
+    }
+
+	// GetEntry method. Caller holds m_mutex.
+    const PipelineRegistry::Entry* PipelineRegistry::GetEntry(PipelineHandle handle) const {
+        if (handle == INVALID_PIPELINE || handle > m_entries.size()) return nullptr;
+        return m_entries[handle - 1].get();
+    }
+
+    std::filesystem::path PipelineRegistry::DiskCache::PathFor(const void* key, size_t keySize) const {
+        return directory / fmt::format("{:016x}.bin", HashBytes(key, keySize));
+    }
+
+	// Load callback. Dawn first asks for the size (value == nullptr), then for the data.
+	// Files start with the full key so that a hash collision reads as a miss instead of a wrong blob.
+    size_t PipelineRegistry::DiskCache::Load(const void* key, size_t keySize, void* value, size_t valueSize, void* userdata) {
+        auto* cache = static_cast<DiskCache*>(userdata);
+        std::lock_guard<std::mutex> lock(cache->mutex);
+
+        std::ifstream file(cache->PathFor(key, keySize), std::ios::binary | std::ios::ate);
+        if (!file) {
+            if (!value) cache->misses++;
+            return 0;
+        }
+
+        const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+        uint64_t storedKeySize = 0;
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(&storedKeySize), sizeof(storedKeySize));
+        if (!file || storedKeySize != keySize || fileSize < sizeof(storedKeySize) + keySize) return 0;
+
+        std::vector<char> storedKey(keySize);
+        file.read(storedKey.data(), keySize);
+        if (!file || std::memcmp(storedKey.data(), key, keySize) != 0) return 0;
+
+        const size_t blobSize = static_cast<size_t>(fileSize - sizeof(storedKeySize) - keySize);
+        if (!value) {
+            cache->hits++;
+            return blobSize;
+        }
+        if (valueSize < blobSize) return 0;
+        file.read(static_cast<char*>(value), blobSize);
+        return file ? blobSize : 0;
+    }
+
+	// Store callback. Writes to a temporary file first so a crash never leaves a truncated blob behind.
+    void PipelineRegistry::DiskCache::Store(const void* key, size_t keySize, const void* value, size_t valueSize, void* userdata) {
+        auto* cache = static_cast<DiskCache*>(userdata);
+        std::lock_guard<std::mutex> lock(cache->mutex);
+
+        const std::filesystem::path path = cache->PathFor(key, keySize);
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            const uint64_t storedKeySize = keySize;
+            file.write(reinterpret_cast<const char*>(&storedKeySize), sizeof(storedKeySize));
+            file.write(static_cast<const char*>(key), keySize);
+            file.write(static_cast<const char*>(value), valueSize);
+            if (!file) {
+                spdlog::warn("PipelineRegistry: Failed to write pipeline cache blob '{}'.", temporary.string());
+                return;
+            }
+        }
+
+        std::error_code ec;
+        std::filesystem::rename(temporary, path, ec);
+        if (ec) {
+            std::filesystem::remove(temporary, ec);
+            return;
+        }
+        cache->stores++;
+    }
+
+} // namespace enDjinn
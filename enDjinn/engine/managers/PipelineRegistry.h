@@ -0,0 +1,116 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "./assets/Sprite.h"
+
+namespace enDjinn {
+
+	// Index into the PipelineRegistry. Handles stay valid until the registry shuts down.
+    using PipelineHandle = uint32_t;
+    constexpr PipelineHandle INVALID_PIPELINE = 0;
+
+	// Vertex inputs a pipeline can be built for. Both use the shared quad at buffer 0.
+    enum class VertexLayout : uint8_t {
+        Quad,          // Per-sprite data comes from elsewhere (e.g. a storage buffer)
+        QuadInstanced  // Buffer 1 holds InstanceData, one per sprite
+    };
+
+	// Everything that distinguishes one render pipeline from another. Two equal descriptors share a pipeline.
+    struct RenderPipelineDesc {
+        std::string label;
+        std::string shaderSource; // WGSL
+        std::string vertexEntry = "vertex_shader_main";
+        std::string fragmentEntry = "fragment_shader_main";
+        VertexLayout vertexLayout = VertexLayout::QuadInstanced;
+        BlendMode blend = BlendMode::Alpha;
+        WGPUTextureFormat format = WGPUTextureFormat_Undefined;
+        WGPUPipelineLayout layout = nullptr; // nullptr lets WebGPU derive the layout from the shader
+    };
+
+    struct ComputePipelineDesc {
+        std::string label;
+        std::string shaderSource;
+        std::string entryPoint;
+        WGPUPipelineLayout layout = nullptr;
+    };
+
+	// Creates render and compute pipelines asynchronously and deduplicates them by shader and state.
+	// Shader modules are shared between pipelines built from the same source. With Dawn, the compiled
+	// pipeline blobs are also persisted to disk so later runs skip most of the driver compilation.
+    class PipelineRegistry {
+    public:
+        PipelineRegistry() = default;
+        ~PipelineRegistry();
+
+		// Must be called on the device descriptor before the device is requested. No-op outside Dawn.
+        void AttachDiskCache(WGPUDeviceDescriptor& deviceDesc, const std::filesystem::path& directory);
+
+        void Startup(WGPUInstance instance, WGPUDevice device);
+        void Shutdown();
+
+		// Returns immediately. The pipeline is available from Get once compilation finishes.
+        PipelineHandle Request(const RenderPipelineDesc& desc);
+        PipelineHandle RequestCompute(const ComputePipelineDesc& desc);
+
+		// nullptr while the pipeline is still compiling or if it failed. Safe from any thread.
+        WGPURenderPipeline Get(PipelineHandle handle) const;
+        WGPUComputePipeline GetCompute(PipelineHandle handle) const;
+
+		// Pumps WebGPU events until the given pipeline (or every pending one) has finished compiling
+        bool Wait(PipelineHandle handle);
+        void WaitAll();
+
+        size_t GetPipelineCount() const;
+
+    private:
+        struct Entry {
+            std::string label;
+            WGPURenderPipeline render = nullptr;
+            WGPUComputePipeline compute = nullptr;
+            bool done = false;
+            bool failed = false;
+        };
+
+        // Dawn's blob cache callbacks. Each blob is one file, named by a hash of its key.
+        struct DiskCache {
+            std::filesystem::path directory;
+            std::mutex mutex;
+            std::atomic<uint64_t> hits{ 0 };
+            std::atomic<uint64_t> misses{ 0 };
+            std::atomic<uint64_t> stores{ 0 };
+
+            std::filesystem::path PathFor(const void* key, size_t keySize) const;
+            static size_t Load(const void* key, size_t keySize, void* value, size_t valueSize, void* userdata);
+            static void Store(const void* key, size_t keySize, const void* value, size_t valueSize, void* userdata);
+        };
+
+        PipelineHandle Find(const std::string& key);
+        PipelineHandle AddEntry(const std::string& key, const std::string& label);
+        WGPUShaderModule GetShaderModule(const std::string& source);
+        bool IsDone(PipelineHandle handle) const;
+        const Entry* GetEntry(PipelineHandle handle) const;
+
+        WGPUInstance m_instance = nullptr;
+        WGPUDevice m_device = nullptr;
+
+        mutable std::mutex m_mutex; // Guards the entries, which completion callbacks fill in from any thread
+        std::vector<std::unique_ptr<Entry>> m_entries; // Handle N is m_entries[N - 1]
+        std::unordered_map<std::string, PipelineHandle> m_byKey;
+        std::unordered_map<std::string, WGPUShaderModule> m_shaderModules;
+        std::atomic<uint32_t> m_pending{ 0 };
+
+        std::unique_ptr<DiskCache> m_diskCache;
+#ifdef WEBGPU_BACKEND_DAWN
+        WGPUDawnCacheDeviceDescriptor m_cacheDescriptor{};
+#endif
+    };
+
+} // namespace enDjinn
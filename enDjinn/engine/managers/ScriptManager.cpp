@@ -5,40 +5,77 @@
 #include "../assets/ResourceManager.h"
 #include "ScriptManager.h"
 #include "spdlog/spdlog.h"
+#include "../utils/Log.h"
+#include "../utils/FrameArena.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
 
 using namespace enDjinn;
 
+namespace {
+    constexpr uint64_t COROUTINE_SWEEP_TICKS = 60; // How often event waiters are checked for a destroyed owner
+}
+
 ScriptManager::ScriptManager() = default;
-ScriptManager::~ScriptManager() = default;
+ScriptManager::~ScriptManager() {
+    if (m_statsSampler) Stats::Get().RemoveSampler(m_statsSampler);
+}
 
-// Initialize the Lua state and expose C++ types/functions to Lua
-bool ScriptManager::Startup() {
-    lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::table);
-    lua.script("math.randomseed(0)");
-    sol::state& lua = GetLuaState();
+// Math usertypes shared by every Lua state the engine creates (the main one and the script shards)
+void ScriptManager::RegisterMathTypes(sol::state& state) {
+    // Expose glm::vec2 as 'vec2'
+    state.new_usertype<glm::vec2>("vec2",
+        sol::constructors<glm::vec2(float, float)>(),
+        "x", &glm::vec2::x,
+        "y", &glm::vec2::y
+    );
 
     // Expose glm::vec3 as 'vec3'
-    lua.new_usertype<glm::vec3>("vec3",
+    state.new_usertype<glm::vec3>("vec3",
         sol::constructors<glm::vec3(float, float, float)>(),
         "x", &glm::vec3::x,
         "y", &glm::vec3::y,
         "z", &glm::vec3::z
     );
 
+    // Expose glm::vec4 as 'vec4' (sprite UV rects)
+    state.new_usertype<glm::vec4>("vec4",
+        sol::constructors<glm::vec4(float, float, float, float)>(),
+        "x", &glm::vec4::x,
+        "y", &glm::vec4::y,
+        "z", &glm::vec4::z,
+        "w", &glm::vec4::w
+    );
+}
+
+// Initialize the Lua state and expose C++ types/functions to Lua
+bool ScriptManager::Startup() {
+    lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::table);
+    lua.script("math.randomseed(0)");
+    sol::state& lua = GetLuaState();
+
+    // Expose vec2, vec3 and vec4
+    RegisterMathTypes(lua);
+
     // Expose enDjinn::Sprite as 'Sprite'
     lua.new_usertype<enDjinn::Sprite>("Sprite",
         sol::constructors<enDjinn::Sprite()>(),
         "textureName", &enDjinn::Sprite::textureName,
         "position", &enDjinn::Sprite::position, // This uses the exposed vec3
         "scale", &enDjinn::Sprite::scale,      // Assuming scale is glm::vec2/vec3
-        "z", &enDjinn::Sprite::z               // If 'z' is separate
+        "z", &enDjinn::Sprite::z,              // If 'z' is separate
+        "blend", &enDjinn::Sprite::blend,      // BlendMode.Alpha by default
+        "uvRect", &enDjinn::Sprite::uvRect,    // vec4(x, y, width, height) in UVs, the whole texture by default
+        "animation", &enDjinn::Sprite::animation // Animation_Play id, 0 for none
     );
 
-	// Expose glm::vec2 as 'vec2'
-    lua.new_usertype<glm::vec2>("vec2",
-        sol::constructors<glm::vec2(float, float)>(),
-        "x", &glm::vec2::x,
-        "y", &glm::vec2::y
+    // Expose enDjinn::BlendMode as 'BlendMode' (each mode selects a render pipeline variant)
+    lua.new_enum("BlendMode",
+        "Alpha", enDjinn::BlendMode::Alpha,
+        "Additive", enDjinn::BlendMode::Additive,
+        "Multiply", enDjinn::BlendMode::Multiply,
+        "Opaque", enDjinn::BlendMode::Opaque
     );
 
 	// Explose glm::vec3 again for ScriptComponent (if needed if Engine is supported later)
@@ -65,6 +102,11 @@ bool ScriptManager::Startup() {
         }
     );
 
+    // Report the Lua heap once per frame
+    m_statsSampler = Stats::Get().AddSampler([this](Stats& stats) {
+        stats.Set("lua.heap_bytes", static_cast<double>(lua.memory_used()));
+        });
+
     return true;
 }
 
@@ -102,10 +144,9 @@ void ScriptManager::ExposeInputManager(InputManager* inputManager) {
         bool is_pressed = inputManager->IsKeyPressed(keycode);
 
         // 2. Log everything we know
-        // We only need to see it when we press a key like 'W'.
-        // Note: This is not needed, but practical for debugging
+        // Called for every held key on every tick, so this is trace level and compiled out by default
         if (is_pressed) {
-            spdlog::info("[LUA BINDING] IsKeyPressed called. keycode: {}, result: {}", keycode, is_pressed);
+            ENDJINN_TRACE("[LUA BINDING] IsKeyPressed called. keycode: {}, result: {}", keycode, is_pressed);
         }
 
         // 3. Return the result to Lua
@@ -138,8 +179,38 @@ void ScriptManager::ExposeResourceManager(ResourceManager* resourceManager) {
         }
     );
 
+    // Lua function: ResourceManager_LoadBatch(manifestOrGlob) -> number of assets loaded
+    // Accepts a manifest ("name path" per line) or a glob such as "sprites/*.jpg"; images and sounds load in parallel.
+    lua.set_function("ResourceManager_LoadBatch",
+        [resourceManager](const std::string& source) {
+            return resourceManager->LoadBatch(source);
+        }
+    );
+
+    // Lua function: ResourceManager_SetTextureBudget(megabytes, idleFrames)
+    lua.set_function("ResourceManager_SetTextureBudget",
+        [resourceManager](double megabytes, int idleFrames) {
+            resourceManager->SetTextureBudget(static_cast<uint64_t>(megabytes * 1024.0 * 1024.0), static_cast<uint32_t>(std::max(idleFrames, 0)));
+        }
+    );
+
+    // Lua function: ResourceManager_GetTextureStats() -> table of GPU texture memory counters
+    lua.set_function("ResourceManager_GetTextureStats",
+        [this, resourceManager]() {
+            TextureStats stats = resourceManager->GetTextureStats();
+            return lua.create_table_with(
+                "residentBytes", stats.residentBytes,
+                "budgetBytes", stats.budgetBytes,
+                "residentCount", stats.residentCount,
+                "evictedCount", stats.evictedCount,
+                "evictions", stats.evictions,
+                "reloads", stats.reloads
+            );
+        }
+    );
+
 	// Log the successful exposure
-    spdlog::info("ScriptManager: ResourceManager exposed to Lua (ResourceManager_LoadImage).");
+    spdlog::info("ScriptManager: ResourceManager exposed to Lua (ResourceManager_LoadImage, ResourceManager_LoadBatch, texture budget).");
 }
 
 // Expose SoundManager functionality to Lua
@@ -193,6 +264,713 @@ void ScriptManager::ExposeSoundManager(SoundManager* soundManager) {
     spdlog::info("ScriptManager: SoundManager exposed to Lua (LoadSound, PlaySound).");
 }
 
+// Expose the GPU sprite swarms to Lua. Lua only sets initial state; motion runs in a compute pass.
+void ScriptManager::ExposeSwarmSystem(SwarmSystem* swarmSystem) {
+    if (!swarmSystem) {
+        spdlog::error("ScriptManager: Cannot expose SwarmSystem, pointer is null.");
+        return;
+    }
+
+    // Lua function: Swarm_Create(textureName, capacity, z) -> swarm id, or -1 on failure
+    lua.set_function("Swarm_Create",
+        [swarmSystem](const std::string& textureName, int capacity, sol::optional<float> z) {
+            return swarmSystem->CreateSwarm(textureName, static_cast<uint32_t>(std::max(capacity, 0)), z.value_or(0.0f));
+        }
+    );
+
+    // Lua function: Swarm_Spawn(swarm, position, velocity, acceleration, scale, lifetime) -> spawn id
+    // Acceleration, scale and lifetime are optional; a lifetime of 0 lives until Swarm_Clear.
+    lua.set_function("Swarm_Spawn",
+        [swarmSystem](int swarm, const glm::vec2& position, const glm::vec2& velocity,
+            sol::optional<glm::vec2> acceleration, sol::optional<glm::vec2> scale, sol::optional<float> lifetime) {
+            MotionState state;
+            state.position = position;
+            state.velocity = velocity;
+            state.acceleration = acceleration.value_or(glm::vec2(0.0f));
+            state.scale = scale.value_or(glm::vec2(1.0f));
+            state.lifetime = std::max(lifetime.value_or(0.0f), 0.0f);
+            return swarmSystem->Spawn(swarm, state);
+        }
+    );
+
+    // Lua function: Swarm_OnExpire(swarm, function(spawnIds) ... end), called once per tick with every expired id
+    lua.set_function("Swarm_OnExpire",
+        [swarmSystem](int swarm, sol::protected_function callback) {
+            swarmSystem->SetExpireCallback(swarm, [callback](const std::vector<uint64_t>& spawnIds) {
+                sol::protected_function_result result = callback(sol::as_table(spawnIds));
+                if (!result.valid()) {
+                    sol::error err = result;
+                    ENDJINN_ERROR_EVERY(1000, "[LUA]: Swarm expiry callback failed: {}", err.what());
+                }
+                });
+        }
+    );
+
+    // Lua functions: Swarm_Clear(swarm), Swarm_GetCount(swarm)
+    lua.set_function("Swarm_Clear", [swarmSystem](int swarm) { swarmSystem->Clear(swarm); });
+    lua.set_function("Swarm_GetCount", [swarmSystem](int swarm) { return swarmSystem->GetLiveCount(swarm); });
+
+	// Log the successful exposure
+    spdlog::info("ScriptManager: SwarmSystem exposed to Lua (Swarm_Create, Swarm_Spawn, Swarm_OnExpire, Swarm_Clear).");
+}
+
+// Expose native sprite animation to Lua. Lua creates clips and starts animations; stepping them is native.
+void ScriptManager::ExposeAnimationSystem(AnimationSystem* animationSystem, ResourceManager* resourceManager) {
+    if (!animationSystem || !resourceManager) {
+        spdlog::error("ScriptManager: Cannot expose AnimationSystem, pointer is null.");
+        return;
+    }
+
+    lua.new_enum("PlaybackMode",
+        "Loop", PlaybackMode::Loop,
+        "Once", PlaybackMode::Once,
+        "PingPong", PlaybackMode::PingPong
+    );
+
+    // Lua function: Animation_CreateClip(name, textureName, frames, frameSeconds, mode) -> clip id, or -1
+    // Frames are { x, y, width, height } rects in pixels, so the texture must be loaded first.
+    lua.set_function("Animation_CreateClip",
+        [animationSystem, resourceManager](const std::string& name, const std::string& textureName, sol::table frames,
+            float frameSeconds, sol::optional<PlaybackMode> mode) {
+            const Texture* texture = resourceManager->GetTexture(textureName);
+            if (!texture || texture->width == 0 || texture->height == 0) {
+                spdlog::error("[LUA]: Animation_CreateClip: Texture '{}' for clip '{}' is not loaded.", textureName, name);
+                return -1;
+            }
+            const float width = static_cast<float>(texture->width);
+            const float height = static_cast<float>(texture->height);
+            std::vector<glm::vec4> rects;
+            rects.reserve(frames.size());
+            for (size_t i = 1; i <= frames.size(); ++i) {
+                sol::table rect = frames[i];
+                rects.emplace_back(rect.get_or(1, 0.0f) / width, rect.get_or(2, 0.0f) / height,
+                    rect.get_or(3, width) / width, rect.get_or(4, height) / height);
+            }
+            return animationSystem->CreateClip(name, textureName, std::move(rects), frameSeconds, mode.value_or(PlaybackMode::Loop));
+        }
+    );
+
+    // Lua function: Animation_CreateGridClip(name, textureName, columns, rows, firstFrame, frameCount, frameSeconds, mode)
+    // For sheets of equal cells numbered from 0, left to right and top to bottom. Works before the texture loads.
+    lua.set_function("Animation_CreateGridClip",
+        [animationSystem](const std::string& name, const std::string& textureName, int columns, int rows,
+            int firstFrame, int frameCount, float frameSeconds, sol::optional<PlaybackMode> mode) {
+            return animationSystem->CreateGridClip(name, textureName, static_cast<uint32_t>(std::max(columns, 0)),
+                static_cast<uint32_t>(std::max(rows, 0)), static_cast<uint32_t>(std::max(firstFrame, 0)),
+                static_cast<uint32_t>(std::max(frameCount, 0)), frameSeconds, mode.value_or(PlaybackMode::Loop));
+        }
+    );
+
+    // Lua function: Animation_Play(clipName, speed) -> animation id for Sprite.animation, 0 on failure
+    lua.set_function("Animation_Play", [animationSystem](const std::string& clipName, sol::optional<float> speed) {
+        return animationSystem->Play(animationSystem->FindClip(clipName), speed.value_or(1.0f));
+    });
+
+    // Lua function: Animation_Set(id, clipName) -> true if switched. Restarts from the first frame.
+    lua.set_function("Animation_Set", [animationSystem](AnimationSystem::AnimationId id, const std::string& clipName) {
+        return animationSystem->SetClip(id, animationSystem->FindClip(clipName));
+    });
+
+    // Lua functions: Animation_SetSpeed(id, speed), Animation_Destroy(id), Animation_IsFinished(id), Animation_GetFrame(id)
+    lua.set_function("Animation_SetSpeed", [animationSystem](AnimationSystem::AnimationId id, float speed) { animationSystem->SetSpeed(id, speed); });
+    lua.set_function("Animation_Destroy", [animationSystem](AnimationSystem::AnimationId id) { animationSystem->Destroy(id); });
+    lua.set_function("Animation_IsFinished", [animationSystem](AnimationSystem::AnimationId id) { return animationSystem->IsFinished(id); });
+    lua.set_function("Animation_GetFrame", [animationSystem](AnimationSystem::AnimationId id) { return animationSystem->GetFrame(id); });
+
+	// Log the successful exposure
+    spdlog::info("ScriptManager: AnimationSystem exposed to Lua (Animation_CreateClip, Animation_CreateGridClip, Animation_Play, Animation_Set).");
+}
+
+// Expose tilemaps to Lua. A whole level layer is one tilemap instead of one entity per tile.
+void ScriptManager::ExposeTilemapSystem(TilemapSystem* tilemapSystem) {
+    if (!tilemapSystem) {
+        spdlog::error("ScriptManager: Cannot expose TilemapSystem, pointer is null.");
+        return;
+    }
+
+    // Lua function: Tilemap_Create(tilesetName, width, height, tileSize, tilesetColumns, tilesetRows, origin) -> id, or -1
+    // origin is the world position of the top-left corner and defaults to centering the map.
+    lua.set_function("Tilemap_Create",
+        [tilemapSystem](const std::string& tilesetName, int width, int height, float tileSize,
+            int tilesetColumns, int tilesetRows, sol::optional<glm::vec2> origin) {
+            const glm::vec2 centered(-0.5f * width * tileSize, 0.5f * height * tileSize);
+            return tilemapSystem->CreateTilemap(tilesetName, static_cast<uint32_t>(std::max(width, 0)), static_cast<uint32_t>(std::max(height, 0)),
+                tileSize, static_cast<uint32_t>(std::max(tilesetColumns, 0)), static_cast<uint32_t>(std::max(tilesetRows, 0)), origin.value_or(centered));
+        }
+    );
+
+    // Lua functions: Tilemap_SetTile(map, x, y, tile), Tilemap_GetTile(map, x, y). x and y start at 0; tile 0 is empty.
+    lua.set_function("Tilemap_SetTile", [tilemapSystem](int map, int x, int y, int tile) {
+        if (x < 0 || y < 0) return false;
+        return tilemapSystem->SetTile(map, static_cast<uint32_t>(x), static_cast<uint32_t>(y), static_cast<uint16_t>(std::clamp(tile, 0, 65535)));
+    });
+    lua.set_function("Tilemap_GetTile", [tilemapSystem](int map, int x, int y) -> int {
+        if (x < 0 || y < 0) return 0;
+        return tilemapSystem->GetTile(map, static_cast<uint32_t>(x), static_cast<uint32_t>(y));
+    });
+
+    // Lua function: Tilemap_SetTiles(map, tiles) with every tile of the map in one row-major array
+    lua.set_function("Tilemap_SetTiles", [tilemapSystem](int map, sol::table tiles) {
+        std::vector<uint16_t> values(tiles.size());
+        for (size_t i = 0; i < values.size(); ++i) {
+            values[i] = static_cast<uint16_t>(std::clamp(tiles.get_or(i + 1, 0), 0, 65535));
+        }
+        return tilemapSystem->SetTiles(map, values);
+    });
+
+    // Lua functions: Tilemap_Fill(map, tile), Tilemap_Destroy(map)
+    lua.set_function("Tilemap_Fill", [tilemapSystem](int map, int tile) { tilemapSystem->Fill(map, static_cast<uint16_t>(std::clamp(tile, 0, 65535))); });
+    lua.set_function("Tilemap_Destroy", [tilemapSystem](int map) { tilemapSystem->Destroy(map); });
+
+	// Log the successful exposure
+    spdlog::info("ScriptManager: TilemapSystem exposed to Lua (Tilemap_Create, Tilemap_SetTile, Tilemap_SetTiles, Tilemap_Fill).");
+}
+
+// Expose the particle system to Lua: emitters with their own fixed particle pools
+void ScriptManager::ExposeParticleSystem(ParticleSystem* particleSystem) {
+    if (!particleSystem) {
+        spdlog::error("ScriptManager: Cannot expose ParticleSystem, pointer is null.");
+        return;
+    }
+
+    // Emitter settings come from a plain table; missing keys keep the EmitterConfig defaults
+    auto readConfig = [](sol::optional<sol::table> table) {
+        EmitterConfig config;
+        if (!table) return config;
+        config.rate = table->get_or("rate", config.rate);
+        config.lifetimeMin = table->get_or("lifetimeMin", config.lifetimeMin);
+        config.lifetimeMax = table->get_or("lifetimeMax", config.lifetimeMin);
+        config.speedMin = table->get_or("speedMin", config.speedMin);
+        config.speedMax = table->get_or("speedMax", config.speedMin);
+        config.direction = table->get_or("direction", config.direction);
+        config.spread = table->get_or("spread", config.spread);
+        config.gravity = table->get_or("gravity", config.gravity);
+        config.startScale = table->get_or("startScale", config.startScale);
+        config.endScale = table->get_or("endScale", config.endScale);
+        config.z = table->get_or("z", config.z);
+        config.blend = table->get_or("blend", config.blend);
+        return config;
+    };
+
+    // Lua function: Particles_CreateEmitter(textureName, capacity, config) -> id, or -1
+    // config keys: rate, lifetimeMin, lifetimeMax, speedMin, speedMax, direction, spread (radians), gravity (vec2),
+    // startScale, endScale, z, blend
+    lua.set_function("Particles_CreateEmitter", [particleSystem, readConfig](const std::string& textureName, int capacity, sol::optional<sol::table> config) {
+        return particleSystem->CreateEmitter(textureName, static_cast<uint32_t>(std::max(capacity, 0)), readConfig(config));
+    });
+    lua.set_function("Particles_SetConfig", [particleSystem, readConfig](int emitter, sol::table config) {
+        particleSystem->SetConfig(emitter, readConfig(config));
+    });
+
+    // Lua functions: Particles_SetPosition(emitter, position), Particles_SetEmitting(emitter, emitting), Particles_Burst(emitter, count)
+    lua.set_function("Particles_SetPosition", [particleSystem](int emitter, const glm::vec2& position) { particleSystem->SetPosition(emitter, position); });
+    lua.set_function("Particles_SetEmitting", [particleSystem](int emitter, bool emitting) { particleSystem->SetEmitting(emitter, emitting); });
+    lua.set_function("Particles_Burst", [particleSystem](int emitter, int count) { particleSystem->Burst(emitter, static_cast<uint32_t>(std::max(count, 0))); });
+
+    // Lua functions: Particles_Clear(emitter), Particles_Destroy(emitter), Particles_GetCount(emitter) -> live particles
+    lua.set_function("Particles_Clear", [particleSystem](int emitter) { particleSystem->Clear(emitter); });
+    lua.set_function("Particles_Destroy", [particleSystem](int emitter) { particleSystem->Destroy(emitter); });
+    lua.set_function("Particles_GetCount", [particleSystem](int emitter) { return particleSystem->GetCount(emitter); });
+
+	// Log the successful exposure
+    spdlog::info("ScriptManager: ParticleSystem exposed to Lua (Particles_CreateEmitter, Particles_Burst, Particles_SetPosition).");
+}
+
+// Expose the text system to Lua: fonts and batched, cached text
+void ScriptManager::ExposeTextSystem(TextSystem* textSystem, ResourceManager* resourceManager) {
+    if (!textSystem || !resourceManager) {
+        spdlog::error("ScriptManager: Cannot expose TextSystem, pointer is null.");
+        return;
+    }
+
+    lua.new_enum("TextAlign",
+        "Left", TextAlign::Left,
+        "Center", TextAlign::Center,
+        "Right", TextAlign::Right
+    );
+
+    // Lua functions: Text_LoadFont(name, path, pixelHeight, sdf) bakes a TrueType file;
+    // Text_CreateGridFont(name, textureName, columns, rows, firstChar) uses a loaded monospace atlas. Both -> font, or -1
+    lua.set_function("Text_LoadFont", [textSystem, resourceManager](const std::string& name, const std::string& path, float pixelHeight, sol::optional<bool> sdf) {
+        return textSystem->LoadFont(name, path, pixelHeight, sdf.value_or(false), *resourceManager);
+    });
+    lua.set_function("Text_CreateGridFont", [textSystem, resourceManager](const std::string& name, const std::string& textureName,
+        int columns, int rows, sol::optional<int> firstChar) {
+        return textSystem->CreateGridFont(name, textureName, static_cast<uint32_t>(std::max(columns, 0)), static_cast<uint32_t>(std::max(rows, 0)),
+            static_cast<uint32_t>(std::max(firstChar.value_or(32), 0)), *resourceManager);
+    });
+
+    // Lua function: Text_Create(font, value, position, size) -> text. size is the line height in world units.
+    // Values other than strings (e.g. a score) go through tostring.
+    auto toString = [this](const sol::object& value) {
+        return value.is<std::string>() ? value.as<std::string>() : lua["tostring"](value).get<std::string>();
+    };
+    lua.set_function("Text_Create", [textSystem, toString](int font, const sol::object& value, const glm::vec2& position, float size) {
+        return textSystem->CreateText(font, toString(value), position, size);
+    });
+
+    // Lua function: Text_Set(text, value). Setting the same value again is free.
+    lua.set_function("Text_Set", [textSystem, toString](int text, const sol::object& value) { textSystem->SetString(text, toString(value)); });
+
+    // Lua functions: Text_SetPosition(text, position), Text_SetSize(text, size), Text_SetColor(text, vec4),
+    // Text_SetZ(text, z), Text_SetAlign(text, TextAlign), Text_SetVisible(text, visible)
+    lua.set_function("Text_SetPosition", [textSystem](int text, const glm::vec2& position) { textSystem->SetPosition(text, position); });
+    lua.set_function("Text_SetSize", [textSystem](int text, float size) { textSystem->SetSize(text, size); });
+    lua.set_function("Text_SetColor", [textSystem](int text, const glm::vec4& color) { textSystem->SetColor(text, color); });
+    lua.set_function("Text_SetZ", [textSystem](int text, float z) { textSystem->SetZ(text, z); });
+    lua.set_function("Text_SetAlign", [textSystem](int text, TextAlign align) { textSystem->SetAlign(text, align); });
+    lua.set_function("Text_SetVisible", [textSystem](int text, bool visible) { textSystem->SetVisible(text, visible); });
+
+    // Lua functions: Text_Measure(text) -> vec2 in world units, Text_Destroy(text)
+    lua.set_function("Text_Measure", [textSystem](int text) { return textSystem->Measure(text); });
+    lua.set_function("Text_Destroy", [textSystem](int text) { textSystem->Destroy(text); });
+
+	// Log the successful exposure
+    spdlog::info("ScriptManager: TextSystem exposed to Lua (Text_LoadFont, Text_CreateGridFont, Text_Create, Text_Set).");
+}
+
+// Expose native collision to Lua. Colliders follow their entity's Sprite; contacts arrive as one batch per tick.
+void ScriptManager::ExposeCollisionSystem(CollisionSystem* collisionSystem) {
+    if (!collisionSystem) {
+        spdlog::error("ScriptManager: Cannot expose CollisionSystem, pointer is null.");
+        return;
+    }
+    m_collisionSystem = collisionSystem; // World snapshots capture and restore its colliders
+
+    // Expose enDjinn::ColliderShape as 'ColliderShape'
+    lua.new_enum("ColliderShape",
+        "Box", ColliderShape::Box,
+        "Circle", ColliderShape::Circle
+    );
+
+    // Collider options come from a plain table; missing keys keep the ColliderDesc defaults.
+    // Layers and masks are bit sets; Lua integers are truncated to their low 32 bits.
+    auto readOptions = [](ColliderDesc& desc, sol::optional<sol::table> table) {
+        if (!table) return;
+        desc.offset = table->get_or("offset", desc.offset);
+        desc.layer = static_cast<uint32_t>(table->get_or<int64_t>("layer", desc.layer));
+        desc.mask = static_cast<uint32_t>(table->get_or<int64_t>("mask", desc.mask));
+        desc.followSprite = table->get_or("followSprite", desc.followSprite);
+    };
+    auto readMask = [](sol::optional<int64_t> mask) { return mask ? static_cast<uint32_t>(*mask) : ~0u; };
+
+    // Lua functions: Collision_AddBox(entity, halfExtents, options), Collision_AddCircle(entity, radius, options) -> true if added
+    // options keys: offset (vec2), layer, mask, followSprite (default true; otherwise use Collision_SetPosition)
+    lua.set_function("Collision_AddBox", [collisionSystem, readOptions](EntityId entity, const glm::vec2& halfExtents, sol::optional<sol::table> options) {
+        ColliderDesc desc;
+        desc.shape = ColliderShape::Box;
+        desc.halfExtents = halfExtents;
+        readOptions(desc, options);
+        return collisionSystem->Add(entity, desc);
+    });
+    lua.set_function("Collision_AddCircle", [collisionSystem, readOptions](EntityId entity, float radius, sol::optional<sol::table> options) {
+        ColliderDesc desc;
+        desc.shape = ColliderShape::Circle;
+        desc.radius = radius;
+        readOptions(desc, options);
+        return collisionSystem->Add(entity, desc);
+    });
+
+    // Lua functions: Collision_Remove(entity), Collision_SetPosition(entity, position), Collision_SetLayer(entity, layer, mask),
+    // Collision_SetCellSize(size)
+    lua.set_function("Collision_Remove", [collisionSystem](EntityId entity) { collisionSystem->Remove(entity); });
+    lua.set_function("Collision_SetPosition", [collisionSystem](EntityId entity, const glm::vec2& position) { collisionSystem->SetPosition(entity, position); });
+    lua.set_function("Collision_SetLayer", [collisionSystem, readMask](EntityId entity, int64_t layer, sol::optional<int64_t> mask) {
+        collisionSystem->SetLayer(entity, static_cast<uint32_t>(layer), readMask(mask));
+    });
+    lua.set_function("Collision_SetCellSize", [collisionSystem](float size) { collisionSystem->SetCellSize(size); });
+
+    // Lua function: Collision_OnContact(function(begins, ends) ... end), called once per tick when contacts change.
+    // Both arrays hold entity pairs back to back: { a1, b1, a2, b2, ... }.
+    lua.set_function("Collision_OnContact",
+        [this, collisionSystem](sol::protected_function callback) {
+            collisionSystem->SetContactCallback([this, callback](const std::vector<Contact>& begins, const std::vector<Contact>& ends) {
+                auto toTable = [this](const std::vector<Contact>& contacts) {
+                    sol::table pairs = lua.create_table(static_cast<int>(contacts.size() * 2), 0);
+                    for (size_t i = 0; i < contacts.size(); ++i) {
+                        pairs.raw_set(i * 2 + 1, contacts[i].a, i * 2 + 2, contacts[i].b);
+                    }
+                    return pairs;
+                };
+                sol::protected_function_result result = callback(toTable(begins), toTable(ends));
+                if (!result.valid()) {
+                    sol::error err = result;
+                    ENDJINN_ERROR_EVERY(1000, "[LUA]: Contact callback failed: {}", err.what());
+                }
+                });
+        }
+    );
+
+    // Lua functions: Collision_QueryBox(min, max, mask), Collision_QueryCircle(center, radius, mask) -> array of entities
+    lua.set_function("Collision_QueryBox", [collisionSystem, readMask](const glm::vec2& min, const glm::vec2& max, sol::optional<int64_t> mask) {
+        return sol::as_table(collisionSystem->QueryBox(min, max, readMask(mask)));
+    });
+    lua.set_function("Collision_QueryCircle", [collisionSystem, readMask](const glm::vec2& center, float radius, sol::optional<int64_t> mask) {
+        return sol::as_table(collisionSystem->QueryCircle(center, radius, readMask(mask)));
+    });
+
+    // Lua function: Collision_Raycast(origin, direction, maxDistance, mask) -> { entity, distance, point, normal } or nil
+    lua.set_function("Collision_Raycast", [this, collisionSystem, readMask](const glm::vec2& origin, const glm::vec2& direction,
+        float maxDistance, sol::optional<int64_t> mask) -> sol::object {
+        // The walk is bounded by the occupied cells, but an infinite or NaN distance is still a script bug
+        if (!std::isfinite(maxDistance)) {
+            ENDJINN_WARN_EVERY(1000, "[LUA]: Collision_Raycast needs a finite maxDistance, got {}.", maxDistance);
+            return sol::lua_nil;
+        }
+        RayHit hit;
+        if (!collisionSystem->Raycast(origin, direction, maxDistance, hit, readMask(mask))) return sol::lua_nil;
+        return lua.create_table_with("entity", hit.entity, "distance", hit.distance, "point", hit.point, "normal", hit.normal);
+    });
+
+	// Log the successful exposure
+    spdlog::info("ScriptManager: CollisionSystem exposed to Lua (Collision_AddBox, Collision_AddCircle, Collision_OnContact, Collision_Raycast).");
+}
+
+// Copies the Sprite positions of collider-carrying entities into the CollisionSystem and drops the colliders of
+// destroyed entities. Reads the ECS tables directly, so no Lua code runs per entity.
+void ScriptManager::SyncColliders(CollisionSystem& collisionSystem) {
+    if (collisionSystem.GetCount() == 0) return;
+
+    sol::optional<sol::table> liveEntities = lua.traverse_get<sol::optional<sol::table>>("ECS", "LiveEntities");
+    if (!liveEntities) return;
+    // Absent until the first Sprite is added
+    sol::optional<sol::table> sprites = lua.traverse_get<sol::optional<sol::table>>("ECS", "_pools", "Sprite", "data");
+
+    constexpr EntityId slotMask = (EntityId(1) << ENTITY_SLOT_BITS) - 1;
+    collisionSystem.SyncPositions([&](int64_t entity, glm::vec2& position) {
+        const EntityId slot = entity & slotMask;
+        sol::optional<EntityId> live = liveEntities->raw_get<sol::optional<EntityId>>(slot);
+        if (!live || *live != entity) return false;
+        if (sprites) {
+            sol::optional<Sprite*> sprite = sprites->raw_get<sol::optional<Sprite*>>(slot);
+            if (sprite && *sprite) position = (*sprite)->position;
+        }
+        return true;
+    });
+}
+
+// Expose the coroutine scheduler to Lua. A coroutine runs until it waits; the scheduler resumes it only once the
+// wait is over, so an idle script costs nothing per tick instead of being polled.
+void ScriptManager::ExposeCoroutines() {
+    auto collect = [](const sol::variadic_args& va) { return std::vector<sol::object>(va.begin(), va.end()); };
+
+    // Lua functions: Coroutine_Start(function, ...) -> id, Coroutine_StartFor(entity, function, ...) -> id
+    // The coroutine runs right away up to its first wait; the extra arguments are passed to the function.
+    // One started for an entity ends when the entity is destroyed.
+    lua.set_function("Coroutine_Start", [this, collect](sol::protected_function function, sol::variadic_args va) {
+        return StartCoroutine(function, 0, collect(va));
+    });
+    lua.set_function("Coroutine_StartFor", [this, collect](EntityId entity, sol::protected_function function, sol::variadic_args va) {
+        return StartCoroutine(function, entity, collect(va));
+    });
+
+    // Lua functions: Coroutine_Stop(id) -> whether it was alive, Coroutine_IsAlive(id)
+    lua.set_function("Coroutine_Stop", [this](uint64_t id) {
+        auto it = m_coroutines.find(id);
+        if (it == m_coroutines.end()) return false;
+        if (it->second.running) {
+            it->second.stopped = true;
+        }
+        else {
+            EraseCoroutine(id);
+        }
+        return true;
+    });
+    lua.set_function("Coroutine_IsAlive", [this](uint64_t id) {
+        auto it = m_coroutines.find(id);
+        return it != m_coroutines.end() && !it->second.stopped;
+    });
+
+    // Lua functions for use inside a coroutine: wait(seconds), wait_frames(n), wait_event(name) -> the signal's arguments.
+    // They yield, so they cannot be called through a native callback (e.g. from inside ECS.ForEach's function argument).
+    lua.set_function("wait", sol::yielding([this](double seconds) {
+        const double ticks = std::ceil(seconds / m_secondsPerTick - 1e-6);
+        m_pendingWait = { WaitKind::Ticks, ticks > 1.0 ? static_cast<uint64_t>(ticks) : 1 };
+    }));
+    lua.set_function("wait_frames", sol::yielding([this](int64_t frames) {
+        m_pendingWait = { WaitKind::Ticks, static_cast<uint64_t>(std::max<int64_t>(frames, 1)) };
+    }));
+    lua.set_function("wait_event", sol::yielding([this](const std::string& name) {
+        m_pendingWait = { WaitKind::Event, 0, name };
+    }));
+
+    // Lua function: Event_Signal(name, ...) -> number of coroutines woken. They resume on the next tick's pass.
+    lua.set_function("Event_Signal", [this, collect](const std::string& name, sol::variadic_args va) {
+        auto it = m_eventWaiters.find(name);
+        if (it == m_eventWaiters.end()) return 0;
+        std::vector<uint64_t> waiters = std::move(it->second);
+        m_eventWaiters.erase(it);
+
+        const std::vector<sol::object> args = collect(va);
+        int woken = 0;
+        for (uint64_t id : waiters) {
+            auto coroutine = m_coroutines.find(id);
+            if (coroutine == m_coroutines.end() || coroutine->second.waiting != WaitKind::Event) continue;
+            coroutine->second.waiting = WaitKind::None;
+            coroutine->second.event.clear();
+            m_signalled.emplace_back(id, args);
+            ++woken;
+        }
+        return woken;
+    });
+
+	// Log the successful exposure
+    spdlog::info("ScriptManager: Coroutine scheduler exposed to Lua (Coroutine_Start, wait, wait_frames, wait_event, Event_Signal).");
+}
+
+uint64_t ScriptManager::StartCoroutine(const sol::protected_function& function, EntityId owner, const std::vector<sol::object>& args) {
+    const uint64_t id = m_nextCoroutineId++;
+    Coroutine& coroutine = m_coroutines[id];
+    coroutine.thread = sol::thread::create(lua.lua_state());
+    coroutine.routine = sol::coroutine(coroutine.thread.state(), function);
+    coroutine.owner = owner;
+    ResumeCoroutine(id, args);
+    return id;
+}
+
+// Runs a coroutine until it waits, returns or fails, then files it under what it waits for next
+void ScriptManager::ResumeCoroutine(uint64_t id, const std::vector<sol::object>& args) {
+    auto it = m_coroutines.find(id);
+    if (it == m_coroutines.end()) return;
+    Coroutine& coroutine = it->second;
+
+    // 1. Coroutines tied to an entity end with it
+    if (coroutine.owner != 0 && !IsEntityLive(coroutine.owner)) {
+        EraseCoroutine(id);
+        return;
+    }
+
+    // 2. Resume. A coroutine may start others, which run nested, so the running id is saved.
+    const uint64_t outer = m_runningCoroutine;
+    m_runningCoroutine = id;
+    m_pendingWait = {};
+    coroutine.running = true;
+    coroutine.waiting = WaitKind::None;
+    bool yielded = false;
+    {
+        sol::protected_function_result result = coroutine.routine(sol::as_args(args));
+        if (!result.valid()) {
+            sol::error err = result;
+            ENDJINN_ERROR_EVERY(1000, "[LUA]: Coroutine {} failed: {}", id, err.what());
+        }
+        else {
+            yielded = result.status() == sol::call_status::yielded;
+        }
+    }
+    coroutine.running = false;
+    m_runningCoroutine = outer;
+    ++m_coroutineResumes;
+    // Taken right away, so a wait left over from a nested coroutine cannot reach the one that resumed it
+    PendingWait wait = std::exchange(m_pendingWait, {});
+
+    // 3. Finished, failed or stopped from inside: drop it
+    if (!yielded || coroutine.stopped) {
+        m_coroutines.erase(id);
+        return;
+    }
+
+    // 4. File it. A yield that did not go through a wait primitive waits one tick.
+    if (wait.kind == WaitKind::Event) {
+        coroutine.waiting = WaitKind::Event;
+        coroutine.event = std::move(wait.event);
+        m_eventWaiters[coroutine.event].push_back(id);
+    }
+    else {
+        coroutine.waiting = WaitKind::Ticks;
+        m_timers.Schedule(id, wait.ticks);
+    }
+}
+
+void ScriptManager::EraseCoroutine(uint64_t id) {
+    auto it = m_coroutines.find(id);
+    if (it == m_coroutines.end()) return;
+    if (it->second.waiting == WaitKind::Event) {
+        auto waiters = m_eventWaiters.find(it->second.event);
+        if (waiters != m_eventWaiters.end()) {
+            std::erase(waiters->second, id);
+            if (waiters->second.empty()) m_eventWaiters.erase(waiters);
+        }
+    }
+    m_coroutines.erase(it);
+}
+
+// Coroutines waiting on a timer are culled when it fires, but an event may never fire. Every
+// COROUTINE_SWEEP_TICKS ticks, entity-owned event waiters whose entity is gone are dropped.
+void ScriptManager::CullOrphanedCoroutines() {
+    std::vector<uint64_t> orphans;
+    for (const auto& [id, coroutine] : m_coroutines) {
+        if (coroutine.owner != 0 && coroutine.waiting == WaitKind::Event && !IsEntityLive(coroutine.owner)) orphans.push_back(id);
+    }
+    for (uint64_t id : orphans) EraseCoroutine(id);
+}
+
+// UpdateCoroutines method implementation
+void ScriptManager::UpdateCoroutines(double secondsPerTick) {
+    m_secondsPerTick = secondsPerTick;
+    m_coroutineResumes = 0;
+
+    // 1. Coroutines woken by Event_Signal since the last pass. Signals raised during this pass wait for the next,
+    // so coroutines signalling each other cannot keep the pass going.
+    std::pmr::vector<std::pair<uint64_t, std::vector<sol::object>>> signalled(std::make_move_iterator(m_signalled.begin()),
+        std::make_move_iterator(m_signalled.end()), FrameArena::Get().Resource());
+    m_signalled.clear();
+    for (const auto& [id, args] : signalled) ResumeCoroutine(id, args);
+
+    // 2. Coroutines whose timer expires on this tick
+    m_firedTimers.clear();
+    m_timers.Advance(m_firedTimers);
+    const std::vector<sol::object> noArgs;
+    for (uint64_t id : m_firedTimers) {
+        auto it = m_coroutines.find(id);
+        if (it == m_coroutines.end() || it->second.waiting != WaitKind::Ticks) continue; // Stopped meanwhile
+        ResumeCoroutine(id, noArgs);
+    }
+
+    // 3. Event waiters whose entity is gone
+    if (++m_coroutineTicks % COROUTINE_SWEEP_TICKS == 0) CullOrphanedCoroutines();
+
+    Stats& stats = Stats::Get();
+    stats.Set("lua.coroutines", static_cast<double>(m_coroutines.size()));
+    stats.Set("lua.coroutine_resumes", static_cast<double>(m_coroutineResumes));
+}
+
+// An entity is live if its handle is still the one stored in its slot (see ecs.lua)
+bool ScriptManager::IsEntityLive(EntityId entity) {
+    constexpr EntityId slotMask = (EntityId(1) << ENTITY_SLOT_BITS) - 1;
+    sol::optional<EntityId> live = lua.traverse_get<sol::optional<EntityId>>("ECS", "LiveEntities", entity & slotMask);
+    return live && *live == entity;
+}
+
+// Expose script sharding to Lua. Opt-in: entity scripts run on several Lua states in parallel (see ScriptShards).
+void ScriptManager::ExposeScriptShards(ResourceManager* resourceManager) {
+    if (!resourceManager) {
+        spdlog::error("ScriptManager: Cannot expose ScriptShards, ResourceManager pointer is null.");
+        return;
+    }
+
+    // Lua function: Shards_Start(count, { "scripts/ai.lua", ... }) -> success
+    // Each shard runs these scripts; they define the functions named in Shards_Assign.
+    lua.set_function("Shards_Start", [this, resourceManager](int count, std::vector<std::string> scripts) {
+        return m_shards.Start(static_cast<uint32_t>(std::max(count, 0)), scripts, *resourceManager);
+    });
+    lua.set_function("Shards_Stop", [this]() { m_shards.Stop(); });
+    lua.set_function("Shards_GetCount", [this]() { return m_shards.GetShardCount(); });
+
+    // Lua functions: Shards_Assign(entity, scriptName) -> shard index or -1, Shards_Unassign(entity)
+    // An assigned entity's script runs in a shard as scriptName(entity, dt), instead of through the main state:
+    // assigning drops the entity's 'script' component, so the main update no longer runs it (unassigning does not
+    // bring it back).
+    lua.set_function("Shards_Assign", [this](EntityId entity, const std::string& scriptName) {
+        const int shard = m_shards.Assign(entity, scriptName);
+        if (shard < 0) return shard;
+        sol::protected_function dropComponent = lua["ECS"]["DropComponent"];
+        if (dropComponent.valid()) {
+            sol::protected_function_result result = dropComponent("script", entity);
+            if (!result.valid()) {
+                sol::error err = result;
+                spdlog::error("[LUA]: Shards_Assign: Dropping the script component of entity {} failed: {}", entity, err.what());
+            }
+        }
+        return shard;
+    });
+    lua.set_function("Shards_Unassign", [this](EntityId entity) { m_shards.Unassign(entity); });
+
+    // Lua functions: Shards_SendTo(entity, name, ...), Shards_Broadcast(name, ...), delivered at the start of the next tick
+    auto collect = [](const sol::variadic_args& va) {
+        std::vector<ShardValue> args;
+        for (auto arg : va) args.push_back(ScriptShards::ToValue(arg.get<sol::object>()));
+        return args;
+    };
+    lua.set_function("Shards_SendTo", [this, collect](EntityId entity, const std::string& name, sol::variadic_args va) {
+        m_shards.Post(ShardMessage{ entity, name, collect(va) });
+    });
+    lua.set_function("Shards_Broadcast", [this, collect](const std::string& name, sol::variadic_args va) {
+        m_shards.Post(ShardMessage{ 0, name, collect(va) });
+    });
+
+    // Lua function: Shards_OnMessage(function(entity, name, ...) ... end), for messages the shards send to the main
+    // state; called at the end of the tick
+    lua.set_function("Shards_OnMessage", [this](sol::protected_function handler) { m_shards.SetMainHandler(handler); });
+
+	// Log the successful exposure
+    spdlog::info("ScriptManager: ScriptShards exposed to Lua (Shards_Start, Shards_Assign, Shards_SendTo, Shards_OnMessage).");
+}
+
+void ScriptManager::DispatchShards(float dt) {
+    m_shards.Dispatch(lua, dt);
+}
+
+void ScriptManager::MergeShards() {
+    m_shards.Merge(lua);
+}
+
+// Expose the statistics registry to Lua: engine counters, frame time percentiles and game-defined stats
+void ScriptManager::ExposeStats() {
+    // Lua functions: Stats_Get(name) -> number, Stats_GetAll() -> { name = value }
+    lua.set_function("Stats_Get", [](const std::string& name) { return Stats::Get().GetValue(name); });
+    lua.set_function("Stats_GetAll", [this]() {
+        sol::table all = lua.create_table();
+        for (const auto& [name, value] : Stats::Get().GetAll()) {
+            all[name] = value;
+        }
+        return all;
+        });
+
+    // Lua function: Stats_GetFrameTimes() -> { p50, p95, p99, average, max, samples } in milliseconds
+    lua.set_function("Stats_GetFrameTimes", [this]() {
+        const FrameTimeSummary frames = Stats::Get().GetFrameTimes();
+        return lua.create_table_with("p50", frames.p50, "p95", frames.p95, "p99", frames.p99,
+            "average", frames.average, "max", frames.max, "samples", frames.samples);
+        });
+
+    // Lua functions: Stats_Add(name, amount) for per-frame counters, Stats_Set(name, value) for gauges
+    lua.set_function("Stats_Add", [](const std::string& name, sol::optional<double> amount) { Stats::Get().Add(name, amount.value_or(1.0)); });
+    lua.set_function("Stats_Set", [](const std::string& name, double value) { Stats::Get().Set(name, value); });
+
+    // Lua functions: Stats_StartCsv(path), Stats_StopCsv(), Stats_ShowOverlay(enabled)
+    lua.set_function("Stats_StartCsv", [](const std::string& path) { return Stats::Get().StartCsv(path); });
+    lua.set_function("Stats_StopCsv", []() { Stats::Get().StopCsv(); });
+    lua.set_function("Stats_ShowOverlay", [](bool enabled) { Stats::Get().SetOverlayEnabled(enabled); });
+
+	// Log the successful exposure
+    spdlog::info("ScriptManager: Stats exposed to Lua (Stats_Get, Stats_GetAll, Stats_GetFrameTimes, Stats_StartCsv, Stats_ShowOverlay).");
+}
+
+// Expose binary world snapshots to Lua. Restoring rebuilds the ECS in bulk instead of re-running setup scripts.
+void ScriptManager::ExposeWorldSnapshots(ResourceManager* resourceManager) {
+    if (!resourceManager) {
+        spdlog::error("ScriptManager: Cannot expose world snapshots, ResourceManager is null.");
+        return;
+    }
+
+    // Lua functions: World_Snapshot(name) and World_Restore(name) keep snapshots in memory, e.g. for "restart level"
+    lua.set_function("World_Snapshot", [this, resourceManager](const std::string& name) {
+        return m_snapshots[name].Capture(lua, *resourceManager, m_collisionSystem);
+        });
+    lua.set_function("World_Restore", [this, resourceManager](const std::string& name) {
+        auto it = m_snapshots.find(name);
+        if (it == m_snapshots.end()) {
+            spdlog::error("[LUA]: World_Restore: No snapshot named '{}'.", name);
+            return false;
+        }
+        return it->second.Restore(lua, *resourceManager, m_collisionSystem);
+        });
+    lua.set_function("World_DropSnapshot", [this](const std::string& name) { m_snapshots.erase(name); });
+
+    // Lua functions: World_Save(path) and World_Load(path) go through files, with paths relative to the asset root
+    lua.set_function("World_Save", [this, resourceManager](const std::string& partialPath) {
+        WorldSnapshot snapshot;
+        return snapshot.Capture(lua, *resourceManager, m_collisionSystem) && snapshot.SaveToFile(resourceManager->ResolvePath(partialPath));
+        });
+    lua.set_function("World_Load", [this, resourceManager](const std::string& partialPath) {
+        WorldSnapshot snapshot;
+        return snapshot.LoadFromFile(resourceManager->ResolvePath(partialPath)) && snapshot.Restore(lua, *resourceManager, m_collisionSystem);
+        });
+
+	// Log the successful exposure
+    spdlog::info("ScriptManager: World snapshots exposed to Lua (World_Snapshot, World_Restore, World_Save, World_Load).");
+}
+
 bool ScriptManager::LoadScript(const std::string& name, const std::string& path) {
     if (m_loadedScripts.count(name)) {
         spdlog::warn("ScriptManager: Script with name '{}' is already loaded.", name);
@@ -218,6 +996,28 @@ bool ScriptManager::LoadScript(const std::string& name, const std::string& path)
     return true;
 }
 
+// Loads a script from memory, either source text or precompiled bytecode (e.g. from a cooked pack)
+bool ScriptManager::LoadScriptBuffer(const std::string& name, std::string_view buffer, const std::string& chunkName) {
+    if (m_loadedScripts.count(name)) {
+        spdlog::warn("ScriptManager: Script with name '{}' is already loaded.", name);
+        return true;
+    }
+
+    sol::load_result loadResult = lua.load(buffer, chunkName, sol::load_mode::any);
+
+    if (!loadResult.valid()) {
+        sol::error err = loadResult;
+        spdlog::error("ScriptManager: Failed to load script '{}' from buffer '{}'. Error: {}",
+            name, chunkName, err.what());
+        return false;
+    }
+
+    m_loadedScripts[name] = loadResult;
+
+    spdlog::info("ScriptManager: Successfully loaded script '{}' from buffer.", name);
+    return true;
+}
+
 void ScriptManager::RedirectLuaPrint(sol::variadic_args va) {
     std::string message;
 
@@ -242,28 +1042,34 @@ sol::protected_function* ScriptManager::GetScript(const std::string& name) {
     return &it->second;
 }
 
+// GetComponentQuery method. ECS.ForEach also caches its views by query table, so a reused table skips that lookup too.
+const sol::table& ScriptManager::GetComponentQuery(std::string_view component) {
+    auto it = m_componentQueries.find(component);
+    if (it == m_componentQueries.end()) {
+        it = m_componentQueries.emplace(std::string(component), lua.create_table_with(1, std::string(component))).first;
+    }
+    return it->second;
+}
+
 void ScriptManager::UpdateScriptSystem(float dt) {
     sol::state& lua = GetLuaState();
     sol::protected_function ecs_foreach = lua["ECS"]["ForEach"];
 
     if (!ecs_foreach.valid()) {
-        spdlog::warn("ECS.ForEach not found. Script system is inactive.");
+        ENDJINN_WARN_EVERY(1000, "ECS.ForEach not found. Script system is inactive.");
         return;
     }
 
-    // Define the query: entities must have a "script" component
-    std::vector<std::string> components_to_query = { "script" };
-
     // The Lua callback function: runs the script defined in the component
     // Note: The script component must be exposed to Lua as "script"
-    auto script_callback = [&](int entity_id) {
+    auto script_callback = [&](EntityId entity_id) {
         // Retrieve the script component data for this entity
         // We use sol::optional for safety, assuming the component exists (as per query)
-        sol::optional<enDjinn::ScriptComponent> script_comp = lua["ECS"]["Components"]["script"][entity_id];
+        sol::optional<enDjinn::ScriptComponent*> script_comp = lua["ECS"]["Components"]["script"][entity_id];
 
-        if (script_comp && !script_comp->name.empty()) {
+        if (script_comp && *script_comp && !(*script_comp)->name.empty()) {
             // Find the global Lua function that corresponds to the script name, e.g., "Entity_Update"
-            sol::protected_function entity_script_func = lua[script_comp->name.c_str()];
+            sol::protected_function entity_script_func = lua[(*script_comp)->name.c_str()];
 
             if (entity_script_func.valid()) {
                 // Execute the script function, passing the entity ID and delta time
@@ -271,17 +1077,16 @@ void ScriptManager::UpdateScriptSystem(float dt) {
 
                 if (!result.valid()) {
                     sol::error err = result;
-                    spdlog::error("Entity Script Runtime Error ({}) for Entity {}: {}",
-                        script_comp->name, entity_id, err.what());
+                    ENDJINN_ERROR_EVERY(1000, "Entity Script Runtime Error ({}) for Entity {}: {}",
+                        (*script_comp)->name, entity_id, err.what());
                 }
             }
             else {
-                spdlog::warn("Script function '{}' not found for Entity {}.", script_comp->name, entity_id);
+                ENDJINN_WARN_EVERY(1000, "Script function '{}' not found for Entity {}.", (*script_comp)->name, entity_id);
             }
         }
         };
 
-    // Execute the ECS query
-    // sol::as_table ensures the C++ vector is passed as a Lua table (array)
-    ecs_foreach(sol::as_table(components_to_query), script_callback);
+    // Execute the ECS query: entities must have a "script" component
+    ecs_foreach(GetComponentQuery("script"), script_callback);
 }
\ No newline at end of file
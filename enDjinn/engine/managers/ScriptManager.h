@@ -1,12 +1,26 @@
 #pragma once
 
-// Must be defined before including sol/sol.hpp
+// Must be defined before including sol/sol.hpp. The build sets it (ENDJINN_SOL_SAFETIES), so every TU agrees.
+#ifndef SOL_ALL_SAFETIES_ON
 #define SOL_ALL_SAFETIES_ON 1
+#endif
 #include <sol/sol.hpp>
+#include <map>
+#include <string_view>
 #include "InputManager.h"
 #include "../assets/ResourceManager.h"
 #include "../utils/Types.h"
 #include "SoundManager.h"
+#include "../systems/SwarmSystem.h"
+#include "../systems/AnimationSystem.h"
+#include "../systems/TilemapSystem.h"
+#include "../systems/ParticleSystem.h"
+#include "../systems/TextSystem.h"
+#include "../systems/CollisionSystem.h"
+#include "../systems/WorldSnapshot.h"
+#include "../utils/Stats.h"
+#include "../utils/TimerWheel.h"
+#include "ScriptShards.h"
 
 namespace enDjinn
 {
@@ -19,20 +33,92 @@ namespace enDjinn
         void Shutdown();
 
         sol::state& GetLuaState() { return lua; }
+        // A query table for ECS.ForEach over one component, created once and reused every frame
+        const sol::table& GetComponentQuery(std::string_view component);
 
         //Lua methods
         sol::state& GetState() { return lua; }
         void ExposeInputManager(enDjinn::InputManager* inputManager);
         void ExposeResourceManager(enDjinn::ResourceManager* resourceManager);
         void ExposeSoundManager(enDjinn::SoundManager* soundManager);
+        void ExposeSwarmSystem(enDjinn::SwarmSystem* swarmSystem);
+        void ExposeAnimationSystem(enDjinn::AnimationSystem* animationSystem, enDjinn::ResourceManager* resourceManager);
+        void ExposeTilemapSystem(enDjinn::TilemapSystem* tilemapSystem);
+        void ExposeParticleSystem(enDjinn::ParticleSystem* particleSystem);
+        void ExposeTextSystem(enDjinn::TextSystem* textSystem, enDjinn::ResourceManager* resourceManager);
+        void ExposeCollisionSystem(enDjinn::CollisionSystem* collisionSystem);
+        void ExposeWorldSnapshots(enDjinn::ResourceManager* resourceManager);
+        void ExposeStats();
+        void ExposeCoroutines();
+        void ExposeScriptShards(enDjinn::ResourceManager* resourceManager);
         void RedirectLuaPrint(sol::variadic_args va);
         bool LoadScript(const std::string& name, const std::string& path);
+        bool LoadScriptBuffer(const std::string& name, std::string_view buffer, const std::string& chunkName);
         sol::protected_function* GetScript(const std::string& name);
         void UpdateScriptSystem(float dt);
+        void SyncColliders(enDjinn::CollisionSystem& collisionSystem);
+        // Resumes the coroutines whose wait ended. Called once per simulation tick.
+        void UpdateCoroutines(double secondsPerTick);
+        // Sharded entity scripts: Dispatch starts them before the main update, Merge is the barrier after it
+        void DispatchShards(float dt);
+        void MergeShards();
+
+        // Registers vec2, vec3 and vec4 in a Lua state
+        static void RegisterMathTypes(sol::state& state);
     private:
+        // What a hosted coroutine is waiting for. Waiting coroutines cost nothing per tick.
+        enum class WaitKind : uint8_t {
+            None,
+            Ticks, // wait(seconds) and wait_frames(n), filed in the timer wheel
+            Event  // wait_event(name)
+        };
+
+        struct Coroutine {
+            sol::thread thread;
+            sol::coroutine routine;
+            EntityId owner = 0; // Nonzero: the coroutine ends once this entity is destroyed
+            WaitKind waiting = WaitKind::None;
+            std::string event; // The event it waits for, while waiting is WaitKind::Event
+            bool running = false;
+            bool stopped = false; // Coroutine_Stop while it was running; dropped when it yields
+        };
+
+        struct PendingWait {
+            WaitKind kind = WaitKind::None;
+            uint64_t ticks = 0;
+            std::string event;
+        };
+
+        uint64_t StartCoroutine(const sol::protected_function& function, EntityId owner, const std::vector<sol::object>& args);
+        void ResumeCoroutine(uint64_t id, const std::vector<sol::object>& args);
+        void EraseCoroutine(uint64_t id); // Also takes it off its event's waiter list
+        void CullOrphanedCoroutines();
+        bool IsEntityLive(EntityId entity);
 
         sol::state lua;
         // Storage for compiled Lua scripts, indexed by a user-defined name
         std::unordered_map<std::string, sol::protected_function> m_loadedScripts;
+        // In-memory world snapshots, e.g. the start of the level for a quick restart
+        std::unordered_map<std::string, WorldSnapshot> m_snapshots;
+        enDjinn::CollisionSystem* m_collisionSystem = nullptr; // Saved and restored with world snapshots
+        std::map<std::string, sol::table, std::less<>> m_componentQueries;
+        Stats::SamplerId m_statsSampler = 0; // Reports the Lua heap size
+
+        // Coroutine scheduler. Ids are never reused, so timers of stopped coroutines just go stale; event waiter
+        // entries are removed with their coroutine.
+        std::unordered_map<uint64_t, Coroutine> m_coroutines;
+        uint64_t m_nextCoroutineId = 1;
+        uint64_t m_runningCoroutine = 0;
+        PendingWait m_pendingWait; // Set by the wait primitive a coroutine yields through
+        TimerWheel m_timers;
+        std::unordered_map<std::string, std::vector<uint64_t>> m_eventWaiters;
+        std::vector<std::pair<uint64_t, std::vector<sol::object>>> m_signalled; // Woken by Event_Signal, with its arguments
+        std::vector<uint64_t> m_firedTimers;
+        double m_secondsPerTick = 1.0 / 60.0;
+        uint64_t m_coroutineResumes = 0;
+        uint64_t m_coroutineTicks = 0; // Paces the sweep for event waiters whose entity is gone
+
+        // Declared after the Lua state, so the shards stop (and release their handler) first
+        ScriptShards m_shards;
     };
 }
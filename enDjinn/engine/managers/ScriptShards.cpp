@@ -0,0 +1,395 @@
+#include "ScriptManager.h"
+#include "ScriptShards.h"
+#include "../assets/Sprite.h"
+#include "../utils/ThreadPool.h"
+#include "../utils/FrameArena.h"
+#include "../utils/Stats.h"
+#include "../utils/Log.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <chrono>
+#include <type_traits>
+
+namespace enDjinn {
+
+    namespace {
+        constexpr int64_t SLOT_MASK = (int64_t(1) << ENTITY_SLOT_BITS) - 1;
+    }
+
+    ScriptShards::~ScriptShards() {
+        Stop();
+    }
+
+	// Start method. Every shard gets the same bindings and runs the same scripts, so a script name means the same
+	// function on all of them.
+    bool ScriptShards::Start(uint32_t count, const std::vector<std::string>& partialPaths, ResourceManager& resourceManager) {
+        Stop();
+        if (count == 0) {
+            spdlog::error("ScriptShards: Cannot start zero shards.");
+            return false;
+        }
+        const uint32_t workers = ThreadPool::Get().GetThreadCount();
+        if (workers == 0) {
+            spdlog::error("ScriptShards: The thread pool has no workers, sharding stays off.");
+            return false;
+        }
+        if (count > workers) {
+            spdlog::warn("ScriptShards: {} shards requested but the thread pool has {} workers; using {}.", count, workers, workers);
+            count = workers;
+        }
+
+        std::vector<std::unique_ptr<Shard>> shards;
+        for (uint32_t i = 0; i < count; ++i) {
+            auto shard = std::make_unique<Shard>();
+            shard->index = i;
+
+			// 1. Libraries, core types and the shard-side API
+            shard->lua.open_libraries(sol::lib::base, sol::lib::math, sol::lib::table);
+            shard->lua.script("math.randomseed(" + std::to_string(i) + ")");
+            ScriptManager::RegisterMathTypes(shard->lua);
+            Bind(*shard);
+
+			// 2. The scripts, from the cooked pack as bytecode when available
+            for (const std::string& partialPath : partialPaths) {
+                sol::load_result chunk;
+                if (const PackedAsset* packed = resourceManager.FindPackedAsset(partialPath, PackAssetType::Script)) {
+                    std::string_view bytecode(reinterpret_cast<const char*>(packed->data), packed->size);
+                    chunk = shard->lua.load(bytecode, "@" + partialPath, sol::load_mode::any);
+                }
+                else {
+                    chunk = shard->lua.load_file(resourceManager.ResolvePath(partialPath).generic_string());
+                }
+                if (!chunk.valid()) {
+                    sol::error err = chunk;
+                    spdlog::error("ScriptShards: Failed to load '{}' into shard {}: {}", partialPath, i, err.what());
+                    return false;
+                }
+                sol::protected_function script = chunk;
+                sol::protected_function_result result = script();
+                if (!result.valid()) {
+                    sol::error err = result;
+                    spdlog::error("ScriptShards: Running '{}' in shard {} failed: {}", partialPath, i, err.what());
+                    return false;
+                }
+            }
+            shards.push_back(std::move(shard));
+        }
+
+        m_shards = std::move(shards);
+        spdlog::info("ScriptShards: Started {} shards with {} scripts each.", count, partialPaths.size());
+        return true;
+    }
+
+    void ScriptShards::Stop() {
+        for (std::future<void>& running : m_running) running.wait();
+        m_running.clear();
+        m_shards.clear();
+        m_assignments.clear();
+        m_shared.clear();
+        m_fromMain.clear();
+    }
+
+	// Assign method. New entities go to the shard with the fewest, which keeps the shards evenly loaded.
+    int ScriptShards::Assign(int64_t entity, const std::string& scriptName) {
+        if (m_shards.empty()) {
+            spdlog::warn("ScriptShards: Cannot assign entity {}, sharding has not been started.", entity);
+            return -1;
+        }
+        Unassign(entity);
+
+        uint32_t target = 0;
+        for (uint32_t i = 1; i < m_shards.size(); ++i) {
+            if (m_shards[i]->entities.size() < m_shards[target]->entities.size()) target = i;
+        }
+        Shard& shard = *m_shards[target];
+        m_assignments[entity] = { target, static_cast<uint32_t>(shard.entities.size()) };
+        shard.entities.emplace_back(entity, scriptName);
+        return static_cast<int>(target);
+    }
+
+	// Unassign method. The shard's last entity takes the freed place.
+    void ScriptShards::Unassign(int64_t entity) {
+        auto it = m_assignments.find(entity);
+        if (it == m_assignments.end()) return;
+        Shard& shard = *m_shards[it->second.shard];
+        const uint32_t index = it->second.index;
+        m_assignments.erase(it);
+
+        if (index + 1 != shard.entities.size()) {
+            shard.entities[index] = std::move(shard.entities.back());
+            m_assignments[shard.entities[index].first].index = index;
+        }
+        shard.entities.pop_back();
+    }
+
+	// Dispatch method implementation
+    void ScriptShards::Dispatch(sol::state& main, float dt) {
+        if (m_shards.empty()) return;
+
+		// 1. What the shards may read this tick
+        Snapshot(main);
+
+		// 2. Entities destroyed since the last tick leave their shard, which hears about it
+        for (std::unique_ptr<Shard>& shard : m_shards) {
+            for (size_t i = 0; i < shard->entities.size();) {
+                const int64_t entity = shard->entities[i].first;
+                if (FindShared(entity)) {
+                    ++i;
+                    continue;
+                }
+                shard->inbox.push_back(ShardMessage{ entity, "destroyed", {} });
+                Unassign(entity); // Moves the last entity to i
+            }
+        }
+
+		// 3. Messages the main state sent since the last barrier
+        std::pmr::vector<ShardMessage> fromMain(std::make_move_iterator(m_fromMain.begin()), std::make_move_iterator(m_fromMain.end()),
+            FrameArena::Get().Resource());
+        m_fromMain.clear();
+        for (ShardMessage& message : fromMain) Route(std::move(message), main, true);
+
+		// 4. Start every shard on the pool
+        for (std::unique_ptr<Shard>& shard : m_shards) {
+            shard->running = shard->entities;
+            Shard* running = shard.get();
+            m_running.push_back(ThreadPool::Get().Submit([this, running, dt]() { Run(*running, dt); }));
+        }
+    }
+
+	// Run method. Runs on a worker; touches nothing but the shard and the read-only snapshot.
+    void ScriptShards::Run(Shard& shard, float dt) {
+        const auto start = std::chrono::steady_clock::now();
+
+		// 1. Messages delivered at the last barrier
+        if (shard.onMessage.valid()) {
+            std::vector<sol::object> args;
+            for (const ShardMessage& message : shard.inbox) {
+                args.clear();
+                args.push_back(sol::make_object(shard.lua, message.entity));
+                args.push_back(sol::make_object(shard.lua, message.name));
+                for (const ShardValue& value : message.args) args.push_back(ToObject(shard.lua.lua_state(), value));
+                sol::protected_function_result result = shard.onMessage(sol::as_args(args));
+                if (!result.valid()) {
+                    sol::error err = result;
+                    ENDJINN_ERROR_EVERY(1000, "[LUA shard {}]: Message handler failed: {}", shard.index, err.what());
+                }
+            }
+        }
+        shard.inbox.clear();
+
+		// 2. Entity scripts. Entities are usually grouped by script, so the function is looked up once per run of a name.
+        sol::protected_function function;
+        const std::string* functionName = nullptr;
+        for (const auto& [entity, scriptName] : shard.running) {
+            if (!functionName || *functionName != scriptName) {
+                function = shard.lua[scriptName];
+                functionName = &scriptName;
+            }
+            if (!function.valid()) {
+                ENDJINN_WARN_EVERY(1000, "ScriptShards: Script function '{}' not found in shard {}.", scriptName, shard.index);
+                continue;
+            }
+            sol::protected_function_result result = function(entity, dt);
+            if (!result.valid()) {
+                sol::error err = result;
+                ENDJINN_ERROR_EVERY(1000, "[LUA shard {}]: Entity Script Runtime Error ({}) for Entity {}: {}",
+                    shard.index, scriptName, entity, err.what());
+            }
+        }
+
+        shard.runMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+	// Merge method. The tick barrier: applies each shard's output in shard order.
+    void ScriptShards::Merge(sol::state& main) {
+        if (m_running.empty()) return;
+        for (std::future<void>& running : m_running) running.get();
+        m_running.clear();
+
+        sol::optional<sol::table> liveEntities = main.traverse_get<sol::optional<sol::table>>("ECS", "LiveEntities");
+        sol::optional<sol::table> sprites = main.traverse_get<sol::optional<sol::table>>("ECS", "_pools", "Sprite", "data");
+        double slowestMs = 0.0;
+        for (std::unique_ptr<Shard>& shard : m_shards) {
+			// 1. Position commands, for entities still alive after the main state's update
+            if (liveEntities && sprites) {
+                for (const auto& [entity, position] : shard->positions) {
+                    const int64_t slot = entity & SLOT_MASK;
+                    sol::optional<int64_t> live = liveEntities->raw_get<sol::optional<int64_t>>(slot);
+                    if (!live || *live != entity) continue;
+                    sol::optional<Sprite*> sprite = sprites->raw_get<sol::optional<Sprite*>>(slot);
+                    if (sprite && *sprite) (*sprite)->position = position;
+                }
+            }
+            shard->positions.clear();
+
+			// 2. Messages, to their entity's shard (read next tick) or to the main state (right away)
+            std::pmr::vector<ShardMessage> outbox(std::make_move_iterator(shard->outbox.begin()), std::make_move_iterator(shard->outbox.end()),
+                FrameArena::Get().Resource());
+            shard->outbox.clear();
+            for (ShardMessage& message : outbox) Route(std::move(message), main, false);
+            slowestMs = std::max(slowestMs, shard->runMs);
+        }
+
+        Stats& stats = Stats::Get();
+        stats.Set("script.shard_ms_max", slowestMs);
+        stats.Set("script.shard_entities", static_cast<double>(m_assignments.size()));
+    }
+
+	// Route method. Entity 0 means the main state when a shard sends it, and every shard when the main state does.
+    void ScriptShards::Route(ShardMessage&& message, sol::state& main, bool fromMain) {
+        if (message.entity == 0) {
+            if (!fromMain) {
+                DeliverToMain(message, main);
+                return;
+            }
+            for (std::unique_ptr<Shard>& shard : m_shards) shard->inbox.push_back(message);
+            return;
+        }
+
+        auto it = m_assignments.find(message.entity);
+        if (it != m_assignments.end()) {
+            m_shards[it->second.shard]->inbox.push_back(std::move(message));
+        }
+        else {
+            DeliverToMain(message, main);
+        }
+    }
+
+    void ScriptShards::DeliverToMain(const ShardMessage& message, sol::state& main) {
+        if (!m_mainHandler.valid()) return;
+        std::vector<sol::object> args;
+        args.reserve(message.args.size() + 2);
+        args.push_back(sol::make_object(main, message.entity));
+        args.push_back(sol::make_object(main, message.name));
+        for (const ShardValue& value : message.args) args.push_back(ToObject(main.lua_state(), value));
+        sol::protected_function_result result = m_mainHandler(sol::as_args(args));
+        if (!result.valid()) {
+            sol::error err = result;
+            ENDJINN_ERROR_EVERY(1000, "[LUA]: Shard message handler failed: {}", err.what());
+        }
+    }
+
+	// Snapshot method. Copies every live entity's Sprite, indexed by slot, straight from the ECS tables.
+    void ScriptShards::Snapshot(sol::state& main) {
+        const int64_t slotCount = main.traverse_get<sol::optional<int64_t>>("ECS", "_slotCount").value_or(0);
+        m_shared.assign(static_cast<size_t>(slotCount) + 1, SharedEntity{});
+
+        sol::optional<sol::table> liveEntities = main.traverse_get<sol::optional<sol::table>>("ECS", "LiveEntities");
+        if (!liveEntities) return;
+        sol::optional<sol::table> sprites = main.traverse_get<sol::optional<sol::table>>("ECS", "_pools", "Sprite", "data");
+
+        for (int64_t slot = 1; slot <= slotCount; ++slot) {
+            sol::optional<int64_t> entity = liveEntities->raw_get<sol::optional<int64_t>>(slot);
+            if (!entity) continue;
+            SharedEntity& shared = m_shared[static_cast<size_t>(slot)];
+            shared.entity = *entity;
+            if (!sprites) continue;
+            sol::optional<Sprite*> sprite = sprites->raw_get<sol::optional<Sprite*>>(slot);
+            if (!sprite || !*sprite) continue;
+            shared.hasSprite = true;
+            shared.position = (*sprite)->position;
+            shared.scale = (*sprite)->scale;
+            shared.z = (*sprite)->z;
+        }
+    }
+
+    const ScriptShards::SharedEntity* ScriptShards::FindShared(int64_t entity) const {
+        const size_t slot = static_cast<size_t>(entity & SLOT_MASK);
+        if (slot >= m_shared.size() || m_shared[slot].entity != entity) return nullptr;
+        return &m_shared[slot];
+    }
+
+	// Bind method. The shard-side API; everything here runs on the shard's worker.
+    void ScriptShards::Bind(Shard& shard) {
+        sol::state& lua = shard.lua;
+        lua["Shard_Index"] = shard.index;
+
+        lua.set_function("print", [index = shard.index](sol::variadic_args va) {
+            std::string message;
+            for (auto arg : va) {
+                message += arg.get<sol::object>().as<std::string>();
+                message += " ";
+            }
+            spdlog::info("[LUA shard {}]: {}", index, message);
+        });
+
+        // Lua functions: Shared_IsAlive(entity), Shared_GetPosition(entity) / Shared_GetScale(entity) -> vec2 or nil,
+        // Shared_GetZ(entity) -> number or nil. All read the snapshot taken at the start of the tick.
+        lua.set_function("Shared_IsAlive", [this](int64_t entity) { return FindShared(entity) != nullptr; });
+        lua.set_function("Shared_GetPosition", [this](int64_t entity) -> sol::optional<glm::vec2> {
+            const SharedEntity* shared = FindShared(entity);
+            if (!shared || !shared->hasSprite) return sol::nullopt;
+            return shared->position;
+        });
+        lua.set_function("Shared_GetScale", [this](int64_t entity) -> sol::optional<glm::vec2> {
+            const SharedEntity* shared = FindShared(entity);
+            if (!shared || !shared->hasSprite) return sol::nullopt;
+            return shared->scale;
+        });
+        lua.set_function("Shared_GetZ", [this](int64_t entity) -> sol::optional<float> {
+            const SharedEntity* shared = FindShared(entity);
+            if (!shared || !shared->hasSprite) return sol::nullopt;
+            return shared->z;
+        });
+
+        // Lua function: Shard_SetPosition(entity, position), applied to the entity's Sprite at the end of the tick
+        lua.set_function("Shard_SetPosition", [&shard](int64_t entity, const glm::vec2& position) {
+            shard.positions.emplace_back(entity, position);
+        });
+
+        // Lua functions: Shard_Send(name, ...) to the main state, Shard_SendTo(entity, name, ...) to whoever runs the
+        // entity's script. Arguments may be nil, booleans, numbers, strings and vec2s.
+        auto collect = [](const sol::variadic_args& va) {
+            std::vector<ShardValue> args;
+            for (auto arg : va) args.push_back(ToValue(arg.get<sol::object>()));
+            return args;
+        };
+        lua.set_function("Shard_Send", [&shard, collect](const std::string& name, sol::variadic_args va) {
+            shard.outbox.push_back(ShardMessage{ 0, name, collect(va) });
+        });
+        lua.set_function("Shard_SendTo", [&shard, collect](int64_t entity, const std::string& name, sol::variadic_args va) {
+            shard.outbox.push_back(ShardMessage{ entity, name, collect(va) });
+        });
+
+        // Lua function: Shard_OnMessage(function(entity, name, ...) ... end), called before this shard's entity scripts
+        lua.set_function("Shard_OnMessage", [&shard](sol::protected_function handler) { shard.onMessage = handler; });
+    }
+
+    ShardValue ScriptShards::ToValue(const sol::object& object) {
+        switch (object.get_type()) {
+        case sol::type::lua_nil:
+        case sol::type::none:
+            return std::monostate{};
+        case sol::type::boolean:
+            return ShardValue(std::in_place_type<bool>, object.as<bool>());
+        case sol::type::number: {
+            lua_State* state = object.lua_state();
+            object.push();
+            const bool integer = lua_isinteger(state, -1);
+            lua_pop(state, 1);
+            if (integer) return ShardValue(std::in_place_type<int64_t>, object.as<int64_t>());
+            return ShardValue(std::in_place_type<double>, object.as<double>());
+        }
+        case sol::type::string:
+            return object.as<std::string>();
+        default:
+            if (object.is<glm::vec2>()) return object.as<glm::vec2>();
+            break;
+        }
+        ENDJINN_WARN_EVERY(1000, "ScriptShards: Only nil, booleans, numbers, strings and vec2s can cross between Lua states; sending nil.");
+        return std::monostate{};
+    }
+
+    sol::object ScriptShards::ToObject(lua_State* state, const ShardValue& value) {
+        return std::visit([state](const auto& v) -> sol::object {
+            using T = std::decay_t<decltype(v)>;
+            if constexpr (std::is_same_v<T, std::monostate>) {
+                return sol::make_object(state, sol::lua_nil);
+            }
+            else {
+                return sol::make_object(state, v);
+            }
+            }, value);
+    }
+
+} // namespace enDjinn
@@ -0,0 +1,102 @@
+#pragma once
+
+// Included through ScriptManager.h, which configures sol before including it
+#include <sol/sol.hpp>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+
+namespace enDjinn {
+
+    class ResourceManager;
+
+	// A value that can cross from one Lua state to another. Tables, functions and other userdata cannot.
+    using ShardValue = std::variant<std::monostate, bool, int64_t, double, std::string, glm::vec2>;
+
+    struct ShardMessage {
+        int64_t entity = 0; // The entity it is about (its recipient when sent to one), or 0
+        std::string name;
+        std::vector<ShardValue> args;
+    };
+
+	// Opt-in parallel entity scripts. Each shard is a Lua state of its own, loaded with the same scripts, that runs
+	// the scripts of the entities assigned to it on a ThreadPool worker while the main state runs its own update.
+	// Shards never touch the main state: they read a snapshot of every entity's Sprite taken at the start of the
+	// tick, and write back through position commands and messages. Everything they produce is merged on the main
+	// thread at the end of the tick, shard by shard in order, so results do not depend on thread timing.
+	// Messages sent to an entity reach the shard that owns it (or the main state) at that barrier.
+    class ScriptShards {
+    public:
+        ScriptShards() = default;
+        ~ScriptShards();
+
+		// Creates 'count' states and runs the given scripts in each. Returns false, leaving sharding off, on failure.
+        bool Start(uint32_t count, const std::vector<std::string>& partialPaths, ResourceManager& resourceManager);
+        void Stop();
+        uint32_t GetShardCount() const { return static_cast<uint32_t>(m_shards.size()); }
+
+		// Runs the shard-side global 'scriptName' as scriptName(entity, dt) every tick on the least loaded shard.
+		// Returns the shard index, or -1. Destroyed entities are unassigned and their shard gets a "destroyed" message.
+        int Assign(int64_t entity, const std::string& scriptName);
+        void Unassign(int64_t entity);
+
+		// From the main state. Entity 0 broadcasts to every shard.
+        void Post(ShardMessage message) { m_fromMain.push_back(std::move(message)); }
+        void SetMainHandler(sol::protected_function handler) { m_mainHandler = std::move(handler); }
+
+		// Tick hooks on the main thread: Dispatch snapshots the main state and starts the shards, Merge waits for
+		// them and applies what they produced. The main state may run its own scripts in between.
+        void Dispatch(sol::state& main, float dt);
+        void Merge(sol::state& main);
+
+        static ShardValue ToValue(const sol::object& object);
+        static sol::object ToObject(lua_State* state, const ShardValue& value);
+
+    private:
+		// One entity's shared components as of the start of the tick
+        struct SharedEntity {
+            int64_t entity = 0; // 0 for an empty slot
+            bool hasSprite = false;
+            glm::vec2 position = { 0.0f, 0.0f };
+            glm::vec2 scale = { 0.0f, 0.0f };
+            float z = 0.0f;
+        };
+
+        struct Shard {
+            uint32_t index = 0;
+            sol::state lua;
+            sol::protected_function onMessage;
+            std::vector<std::pair<int64_t, std::string>> entities; // Assigned; changed on the main thread only
+            std::vector<std::pair<int64_t, std::string>> running;  // This tick's copy, read by the worker
+            std::vector<ShardMessage> inbox;
+            std::vector<ShardMessage> outbox;
+            std::vector<std::pair<int64_t, glm::vec2>> positions;
+            double runMs = 0.0;
+        };
+
+        struct Assignment {
+            uint32_t shard = 0;
+            uint32_t index = 0; // In the shard's entity list
+        };
+
+        void Bind(Shard& shard);
+        void Run(Shard& shard, float dt);
+        void Snapshot(sol::state& main);
+        const SharedEntity* FindShared(int64_t entity) const;
+        void Route(ShardMessage&& message, sol::state& main, bool fromMain);
+        void DeliverToMain(const ShardMessage& message, sol::state& main);
+
+        std::vector<std::unique_ptr<Shard>> m_shards;
+        std::unordered_map<int64_t, Assignment> m_assignments;
+        std::vector<SharedEntity> m_shared; // Indexed by entity slot
+        std::vector<ShardMessage> m_fromMain;
+        sol::protected_function m_mainHandler;
+        std::vector<std::future<void>> m_running;
+    };
+
+} // namespace enDjinn
@@ -2,6 +2,10 @@
 
 #include "SoundManager.h"
 #include "spdlog/spdlog.h"
+#include "../utils/ThreadPool.h"
+#include "../utils/Log.h"
+#include <algorithm>
+#include <chrono>
 
 namespace enDjinn {
 
@@ -17,26 +21,70 @@ namespace enDjinn {
     }
 
 	// Startup method to initialize SoLoud
-    void SoundManager::Startup() {
-        SoLoud::result result = m_soloud.init();
+    void SoundManager::Startup(const AudioConfig& config) {
+        m_config = config;
+
+		// 1. Open the requested backend; without a device, fall back to mixing into memory
+        SoLoud::result result = InitBackend(config.backend);
+        if (result != SoLoud::SO_NO_ERROR && config.backend != AudioBackend::Null && config.fallbackToNull) {
+            spdlog::warn("SoLoud could not open an audio device ({}), falling back to the null backend.", m_soloud.getErrorString(result));
+            result = InitBackend(AudioBackend::Null);
+        }
         if (result != SoLoud::SO_NO_ERROR) {
             spdlog::error("SoLoud initialization failed: {}", m_soloud.getErrorString(result));
             m_isInitialized = false;
             return;
         }
         m_isInitialized = true;
-        spdlog::info("SoLoud initialized successfully.");
+        m_offline = m_soloud.getBackendId() == SoLoud::Soloud::NULLDRIVER;
+        m_sampleRate = m_soloud.getBackendSamplerate();
+        m_bufferSize = m_soloud.getBackendBufferSize();
+        m_channels = m_soloud.getBackendChannels();
+        m_pendingFrames = 0.0;
+
+		// 2. Voice limit. SoLoud keeps one voice slot in reserve, so the limit stays below VOICE_COUNT.
+        const unsigned int voices = std::clamp(config.maxActiveVoices, 1u, static_cast<unsigned int>(VOICE_COUNT - 1));
+        if (voices != config.maxActiveVoices) {
+            spdlog::warn("SoundManager: {} active voices requested, using {}.", config.maxActiveVoices, voices);
+        }
+        if (m_soloud.setMaxActiveVoiceCount(voices) != SoLoud::SO_NO_ERROR) {
+            spdlog::warn("SoundManager: Could not set the active voice limit to {}.", voices);
+        }
+
+        m_statsSampler = Stats::Get().AddSampler([this](Stats& stats) {
+            stats.Set("audio.voices", static_cast<double>(m_soloud.getActiveVoiceCount()));
+            });
+        spdlog::info("SoLoud initialized: {} backend, {} Hz, {} frame buffer ({:.1f} ms), {} voices.",
+            m_soloud.getBackendString(), m_sampleRate, m_bufferSize, 1000.0 * m_bufferSize / m_sampleRate, voices);
+    }
+
+	// InitBackend method. SoLoud's init tears down whatever was open first, so a failed attempt can be retried.
+    SoLoud::result SoundManager::InitBackend(AudioBackend backend) {
+        unsigned int backendId = SoLoud::Soloud::AUTO;
+        if (backend == AudioBackend::Miniaudio) backendId = SoLoud::Soloud::MINIAUDIO;
+        else if (backend == AudioBackend::Null) backendId = SoLoud::Soloud::NULLDRIVER;
+
+        const unsigned int sampleRate = m_config.sampleRate ? m_config.sampleRate : SoLoud::Soloud::AUTO;
+        const unsigned int bufferSize = m_config.bufferSize ? m_config.bufferSize : SoLoud::Soloud::AUTO;
+        return m_soloud.init(SoLoud::Soloud::CLIP_ROUNDOFF, backendId, sampleRate, bufferSize, 2);
     }
 
 	// Shutdown method to deinitialize SoLoud and clean up sounds
     void SoundManager::Shutdown() {
+        if (m_statsSampler) {
+            Stats::Get().RemoveSampler(m_statsSampler);
+            m_statsSampler = 0;
+        }
         if (m_isInitialized) {
             m_soloud.deinit();
             m_isInitialized = false;
+            m_offline = false;
+            m_mixScratch.clear();
             spdlog::info("SoLoud deinitialized.");
         }
         // The unique_ptrs in the map will handle deleting the Wav objects automatically.
         m_sounds.clear();
+        m_soundPaths.clear();
         spdlog::info("SoundManager shut down.");
     }
 
@@ -49,30 +97,75 @@ namespace enDjinn {
             spdlog::warn("Sound with name '{}' already exists, overwriting.", name);
         }
 
-		// Resolve the full path using ResourceManager
-        std::filesystem::path fullPath = m_resourceManager.ResolvePath(partialPath);
+        std::unique_ptr<SoLoud::Wav> wav = DecodeSound(name, partialPath);
+        if (!wav) return false;
+
+        // Move the unique_ptr (ownership of the Wav object) into the map.
+        m_sounds[name] = std::move(wav);
+        m_soundPaths[name] = partialPath;
+        spdlog::info("Sound '{}' loaded successfully.", name);
+        return true;
+    }
 
+	// LoadSoundBatch method to decode many sounds in parallel, then register them all at once
+    int SoundManager::LoadSoundBatch(const std::vector<AssetRequest>& requests) {
+        if (!m_isInitialized) return 0;
+
+		// Each Wav decodes independently, so the only shared state is the map, which is filled afterwards
+        std::vector<std::unique_ptr<SoLoud::Wav>> decoded(requests.size());
+        ThreadPool::Get().ParallelFor(requests.size(), 1, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                decoded[i] = DecodeSound(requests[i].name, requests[i].partialPath);
+            }
+            });
+
+        int loaded = 0;
+        for (size_t i = 0; i < requests.size(); ++i) {
+            if (!decoded[i]) continue;
+            m_sounds[requests[i].name] = std::move(decoded[i]);
+            m_soundPaths[requests[i].name] = requests[i].partialPath;
+            ++loaded;
+        }
+        spdlog::info("SoundManager: Batch loaded {} of {} sounds.", loaded, requests.size());
+        return loaded;
+    }
+
+	// DecodeSound method. Does not touch the sound map, so it is safe to call from worker threads.
+    std::unique_ptr<SoLoud::Wav> SoundManager::DecodeSound(const std::string& name, const std::string& partialPath) const {
         // Create a new Wav object on the heap, managed by a unique_ptr.
         auto wav = std::make_unique<SoLoud::Wav>();
 
+		// Prefer the cooked pack: the PCM is already decoded, so loading is one copy out of the mapped pages
+		// (a Wav owns and frees its samples, so loadRawWave copies them). SoLoud only reads the source.
+        if (const PackedAsset* packed = m_resourceManager.FindPackedAsset(partialPath, PackAssetType::Sound)) {
+            float* samples = const_cast<float*>(reinterpret_cast<const float*>(packed->data));
+            unsigned int sampleCount = static_cast<unsigned int>(packed->size / sizeof(float));
+            SoLoud::result result = wav->loadRawWave(samples, sampleCount, static_cast<float>(packed->height), packed->width, true, false);
+            if (result != SoLoud::SO_NO_ERROR) {
+                spdlog::error("Failed to load sound '{}' from cooked pack: {}", name, m_soloud.getErrorString(result));
+                return nullptr;
+            }
+            return wav;
+        }
+
+		// Resolve the full path using ResourceManager
+        std::filesystem::path fullPath = m_resourceManager.ResolvePath(partialPath);
+
         // Load the sound data into the new object.
         SoLoud::result result = wav->load(fullPath.string().c_str());
 		// Check for loading errors
         if (result != SoLoud::SO_NO_ERROR) {
             spdlog::error("Failed to load sound '{}' from '{}': {}", name, fullPath.string(), m_soloud.getErrorString(result));
-            return false;
+            return nullptr;
         }
-
-        // Move the unique_ptr (ownership of the Wav object) into the map.
-        m_sounds[name] = std::move(wav);
-        spdlog::info("Sound '{}' loaded successfully.", name);
-        return true;
+        return wav;
     }
 
 	// DestroySound method to remove sounds from the manager
     void SoundManager::DestroySound(const std::string& name) {
         // Erasing the unique_ptr from the map automatically triggers its destructor,
         // which deletes the managed Wav object.
+        m_soundPaths.erase(name);
         if (m_sounds.erase(name) > 0) {
             spdlog::info("Sound '{}' destroyed.", name);
         }
@@ -92,11 +185,53 @@ namespace enDjinn {
             m_soloud.setVolume(handle, volume); // Use per-handle volume for more control
             m_soloud.setPan(handle, pan);
             m_soloud.setLooping(handle, loopCount != 0);
-            spdlog::debug("Playing sound '{}'.", name); // Use debug for less log spam
+            ENDJINN_DEBUG("Playing sound '{}'.", name);
         }
         else {
-            spdlog::warn("Attempted to play non-existent sound '{}'.", name);
+            ENDJINN_WARN_EVERY(1000, "Attempted to play non-existent sound '{}'.", name);
+        }
+    }
+
+	// MixOffline method. SoLoud mixes at most one buffer per call, so longer spans go through in buffer-sized chunks.
+    bool SoundManager::MixOffline(float* output, unsigned int frames) {
+        if (!m_isInitialized || !m_offline) {
+            ENDJINN_WARN_EVERY(1000, "SoundManager: MixOffline needs the null audio backend.");
+            return false;
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        for (unsigned int mixed = 0; mixed < frames;) {
+            const unsigned int chunk = std::min(frames - mixed, m_bufferSize);
+            m_soloud.mix(output + static_cast<size_t>(mixed) * m_channels, chunk);
+            mixed += chunk;
+        }
+        Stats::Get().Add("audio.mix_ms", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        return true;
+    }
+
+	// AdvanceOffline method. Fractional frames carry over, so 60 ticks of 1/60 s mix exactly one second.
+    void SoundManager::AdvanceOffline(double seconds) {
+        if (!m_isInitialized || !m_offline) return;
+
+        m_pendingFrames += seconds * m_sampleRate;
+        const unsigned int frames = static_cast<unsigned int>(m_pendingFrames);
+        m_pendingFrames -= frames;
+        if (frames == 0) return;
+
+        const size_t samples = static_cast<size_t>(frames) * m_channels;
+        if (m_mixScratch.size() < samples) m_mixScratch.resize(samples);
+        MixOffline(m_mixScratch.data(), frames);
+    }
+
+	// GetLoadedSounds method. Sorted by name so snapshots of the same world are byte-identical.
+    std::vector<AssetRequest> SoundManager::GetLoadedSounds() const {
+        std::vector<AssetRequest> sounds;
+        sounds.reserve(m_soundPaths.size());
+        for (const auto& [name, partialPath] : m_soundPaths) {
+            sounds.push_back({ name, partialPath });
         }
+        std::sort(sounds.begin(), sounds.end(), [](const AssetRequest& lhs, const AssetRequest& rhs) { return lhs.name < rhs.name; });
+        return sounds;
     }
 
 } // namespace enDjinn
\ No newline at end of file
@@ -5,32 +5,80 @@
 #include "soloud.h"
 #include "soloud_wav.h"
 #include "./assets/ResourceManager.h" // Corrected header name
+#include "./utils/Stats.h"
 
+#include <cstdint>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <memory> // <<< ADD THIS for std::unique_ptr
 
 namespace enDjinn {
 
+	// The driver SoLoud mixes for. Null opens no device and mixes only when asked, into memory: headless runs,
+	// machines without sound hardware, and measuring the mixer itself.
+    enum class AudioBackend : uint8_t {
+        Auto,      // The platform's device, through miniaudio
+        Miniaudio,
+        Null
+    };
+
+	// Device settings. Zero picks the backend's default. Smaller buffers lower the latency but wake the mixer more often.
+    struct AudioConfig {
+        AudioBackend backend = AudioBackend::Auto;
+        unsigned int sampleRate = 0;       // Hz
+        unsigned int bufferSize = 0;       // Frames per mix
+        unsigned int maxActiveVoices = 16; // Voices mixed at once; quieter ones are virtualised beyond that
+        bool fallbackToNull = true;        // Without a device, keep sounds loading and playing silently
+    };
+
     class SoundManager {
     public:
         SoundManager(ResourceManager& resourceManager);
         ~SoundManager();
 
-        void Startup();
+        void Startup(const AudioConfig& config = {});
         void Shutdown();
         bool LoadSound(const std::string& name, const std::string& partialPath);
+        int LoadSoundBatch(const std::vector<AssetRequest>& requests);
         void DestroySound(const std::string& name);
         void PlaySound(const std::string& name, float volume = 1.0f, float pan = 0.0f, int loopCount = 0);
+        // Name and source of every loaded sound, e.g. for world snapshots
+        std::vector<AssetRequest> GetLoadedSounds() const;
+
+        // Null backend only: mixes the next 'frames' frames into 'output' (interleaved, frames * GetChannels() floats).
+        // Nothing else drives the mixer, so the same calls produce the same samples on any machine.
+        bool MixOffline(float* output, unsigned int frames);
+        // Null backend only: mixes the frames 'seconds' of playback cover into a scratch buffer, so voices advance
+        // and finish as they would on a device. Called once per engine tick.
+        void AdvanceOffline(double seconds);
+
+        bool IsOffline() const { return m_offline; }
+        unsigned int GetSampleRate() const { return m_sampleRate; }
+        unsigned int GetBufferSize() const { return m_bufferSize; }
+        unsigned int GetChannels() const { return m_channels; }
 
     private:
+        SoLoud::result InitBackend(AudioBackend backend);
+        std::unique_ptr<SoLoud::Wav> DecodeSound(const std::string& name, const std::string& partialPath) const;
+
         SoLoud::Soloud m_soloud;
         // --- MODIFIED LINE ---
         // Store unique_ptrs to Wav objects instead of the objects directly.
         std::unordered_map<std::string, std::unique_ptr<SoLoud::Wav>> m_sounds;
+        std::unordered_map<std::string, std::string> m_soundPaths; // Name -> partial path
 
         ResourceManager& m_resourceManager;
         bool m_isInitialized = false;
+        Stats::SamplerId m_statsSampler = 0; // Reports active voices
+
+        AudioConfig m_config;
+        bool m_offline = false; // Running on the null backend
+        unsigned int m_sampleRate = 0;
+        unsigned int m_bufferSize = 0;
+        unsigned int m_channels = 0;
+        std::vector<float> m_mixScratch; // AdvanceOffline's output, discarded
+        double m_pendingFrames = 0.0;    // Fractional frames carried between AdvanceOffline calls
     };
 
 } // namespace enDjinn
\ No newline at end of file
@@ -0,0 +1,207 @@
+#include "AnimationSystem.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cmath>
+
+namespace enDjinn {
+
+	// CreateClip method implementation
+    int AnimationSystem::CreateClip(const std::string& name, const std::string& textureName, std::vector<glm::vec4> frames,
+        float frameSeconds, PlaybackMode mode) {
+        if (frames.empty()) {
+            spdlog::error("AnimationSystem: Clip '{}' has no frames.", name);
+            return -1;
+        }
+
+        AnimationClip clip;
+        clip.name = name;
+        clip.textureName = textureName;
+        clip.frames = std::move(frames);
+        clip.frameSeconds = std::max(frameSeconds, 0.001f);
+        clip.mode = mode;
+
+        auto it = m_clipsByName.find(name);
+        if (it != m_clipsByName.end()) {
+            m_clips[it->second] = std::move(clip);
+            return it->second;
+        }
+        const int index = static_cast<int>(m_clips.size());
+        m_clips.push_back(std::move(clip));
+        m_clipsByName[name] = index;
+        return index;
+    }
+
+	// CreateGridClip method implementation
+    int AnimationSystem::CreateGridClip(const std::string& name, const std::string& textureName, uint32_t columns, uint32_t rows,
+        uint32_t firstFrame, uint32_t frameCount, float frameSeconds, PlaybackMode mode) {
+        if (columns == 0 || rows == 0 || firstFrame + frameCount > columns * rows) {
+            spdlog::error("AnimationSystem: Clip '{}' does not fit a {}x{} grid.", name, columns, rows);
+            return -1;
+        }
+
+        const glm::vec2 cell(1.0f / columns, 1.0f / rows);
+        std::vector<glm::vec4> frames;
+        frames.reserve(frameCount);
+        for (uint32_t i = firstFrame; i < firstFrame + frameCount; ++i) {
+            frames.emplace_back((i % columns) * cell.x, (i / columns) * cell.y, cell.x, cell.y);
+        }
+        return CreateClip(name, textureName, std::move(frames), frameSeconds, mode);
+    }
+
+    int AnimationSystem::FindClip(const std::string& name) const {
+        auto it = m_clipsByName.find(name);
+        return it != m_clipsByName.end() ? it->second : -1;
+    }
+
+    const AnimationClip* AnimationSystem::GetClip(int clip) const {
+        return clip >= 0 && clip < static_cast<int>(m_clips.size()) ? &m_clips[clip] : nullptr;
+    }
+
+	// Play method implementation. Reuses the most recently freed slot.
+    AnimationSystem::AnimationId AnimationSystem::Play(int clip, float speed) {
+        if (!GetClip(clip)) return 0;
+
+        uint32_t slot;
+        if (!m_freeSlots.empty()) {
+            slot = m_freeSlots.back();
+            m_freeSlots.pop_back();
+        }
+        else {
+            slot = static_cast<uint32_t>(m_clip.size());
+            if (slot >= SLOT_MASK) {
+                spdlog::error("AnimationSystem: Too many animations playing.");
+                return 0;
+            }
+            m_clip.push_back(-1);
+            m_time.push_back(0.0f);
+            m_speed.push_back(0.0f);
+            m_frame.push_back(0);
+            m_finished.push_back(0);
+            m_generation.push_back(0);
+        }
+
+        m_clip[slot] = clip;
+        m_time[slot] = 0.0f;
+        m_speed[slot] = std::max(speed, 0.0f);
+        m_frame[slot] = 0;
+        m_finished[slot] = 0;
+        ++m_playing;
+        // Slot + 1 keeps ids non-zero; the generation fills the bits above the slot
+        return ((m_generation[slot] << SLOT_BITS) | (slot + 1));
+    }
+
+    bool AnimationSystem::SetClip(AnimationId id, int clip) {
+        const int slot = Slot(id);
+        if (slot < 0 || !GetClip(clip)) return false;
+        m_clip[slot] = clip;
+        m_time[slot] = 0.0f;
+        m_frame[slot] = 0;
+        m_finished[slot] = 0;
+        return true;
+    }
+
+    void AnimationSystem::SetSpeed(AnimationId id, float speed) {
+        const int slot = Slot(id);
+        if (slot >= 0) m_speed[slot] = std::max(speed, 0.0f);
+    }
+
+    void AnimationSystem::Destroy(AnimationId id) {
+        const int slot = Slot(id);
+        if (slot < 0) return;
+        m_clip[slot] = -1;
+        m_generation[slot]++;
+        m_freeSlots.push_back(static_cast<uint32_t>(slot));
+        --m_playing;
+    }
+
+    bool AnimationSystem::IsAlive(AnimationId id) const {
+        return Slot(id) >= 0;
+    }
+
+    bool AnimationSystem::IsFinished(AnimationId id) const {
+        const int slot = Slot(id);
+        return slot < 0 || m_finished[slot];
+    }
+
+    uint32_t AnimationSystem::GetFrame(AnimationId id) const {
+        const int slot = Slot(id);
+        return slot >= 0 ? m_frame[slot] : 0;
+    }
+
+	// Clear method implementation. Drops every animation; clips are kept.
+    void AnimationSystem::Clear() {
+        m_freeSlots.clear();
+        for (uint32_t slot = 0; slot < m_clip.size(); ++slot) {
+            if (m_clip[slot] >= 0) m_generation[slot]++;
+            m_clip[slot] = -1;
+            m_freeSlots.push_back(static_cast<uint32_t>(m_clip.size()) - 1 - slot);
+        }
+        m_playing = 0;
+    }
+
+	// Tick method implementation. One pass over the instance arrays, no lookups or allocation.
+    void AnimationSystem::Tick(float dt) {
+        const size_t count = m_clip.size();
+        for (size_t slot = 0; slot < count; ++slot) {
+            const int clipIndex = m_clip[slot];
+            if (clipIndex < 0 || m_finished[slot]) continue;
+            const AnimationClip& clip = m_clips[clipIndex];
+
+            // Looping clips keep their time within one cycle so it never loses precision
+            float time = m_time[slot] + dt * m_speed[slot];
+            if (clip.mode != PlaybackMode::Once) {
+                const size_t frameCount = clip.frames.size();
+                const size_t cycleFrames = clip.mode == PlaybackMode::PingPong && frameCount > 1 ? 2 * frameCount - 2 : frameCount;
+                const float cycle = clip.frameSeconds * static_cast<float>(cycleFrames);
+                if (time >= cycle) time = std::fmod(time, cycle);
+            }
+
+            bool finished = false;
+            m_frame[slot] = FrameAt(clip, time, finished);
+            m_finished[slot] = finished;
+            m_time[slot] = time;
+        }
+    }
+
+    const AnimationClip* AnimationSystem::Resolve(AnimationId id, glm::vec4& uvRect) const {
+        const int slot = Slot(id);
+        if (slot < 0) return nullptr;
+        const AnimationClip& clip = m_clips[m_clip[slot]];
+        uvRect = clip.frames[std::min<size_t>(m_frame[slot], clip.frames.size() - 1)];
+        return &clip;
+    }
+
+    int AnimationSystem::Slot(AnimationId id) const {
+        const uint32_t index = id & SLOT_MASK;
+        if (index == 0 || index > m_clip.size()) return -1;
+        const uint32_t slot = index - 1;
+        const uint32_t generationBits = 32 - SLOT_BITS;
+        const uint32_t generation = m_generation[slot] & ((1u << generationBits) - 1);
+        if (m_clip[slot] < 0 || generation != (id >> SLOT_BITS)) return -1;
+        return static_cast<int>(slot);
+    }
+
+	// FrameAt method implementation. Maps a time within the clip to a frame index.
+    uint32_t AnimationSystem::FrameAt(const AnimationClip& clip, float time, bool& finished) {
+        const uint32_t frameCount = static_cast<uint32_t>(clip.frames.size());
+        const uint32_t step = static_cast<uint32_t>(time / clip.frameSeconds);
+        switch (clip.mode) {
+        case PlaybackMode::Once:
+            if (step >= frameCount) {
+                finished = true;
+                return frameCount - 1;
+            }
+            return step;
+        case PlaybackMode::PingPong: {
+            if (frameCount == 1) return 0;
+            const uint32_t period = 2 * frameCount - 2;
+            const uint32_t position = step % period;
+            return position < frameCount ? position : period - position;
+        }
+        case PlaybackMode::Loop:
+        default:
+            return step % frameCount;
+        }
+    }
+
+} // namespace enDjinn
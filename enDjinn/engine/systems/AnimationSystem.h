@@ -0,0 +1,88 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace enDjinn {
+
+    enum class PlaybackMode : uint8_t {
+        Loop,     // 0, 1, 2, 0, 1, 2, ...
+        Once,     // 0, 1, 2, 2, 2, ... then reports finished
+        PingPong  // 0, 1, 2, 1, 0, 1, ...
+    };
+
+	// A flipbook: frames are rects into one sheet or atlas texture, in normalized UVs (x, y, width, height)
+    struct AnimationClip {
+        std::string name;
+        std::string textureName;
+        std::vector<glm::vec4> frames;
+        float frameSeconds = 0.1f;
+        PlaybackMode mode = PlaybackMode::Loop;
+    };
+
+	// Native sprite animation. Playing animations live here in structure-of-arrays form and are all advanced
+	// by one loop per tick; a Sprite refers to its animation by id, and the renderer reads the current frame's
+	// rect straight into the instance data. Lua starts, switches and stops animations but never steps them.
+	//
+	// Ids carry a generation in the upper bits like ECS handles, so a stale id simply resolves to nothing.
+	// Animation state is not part of world snapshots; restored sprites keep their ids, which stay valid in the
+	// same session and show the whole texture otherwise.
+	//
+	// Slots are not reclaimed on their own: ecs.lua destroys a Sprite's animation when the Sprite is dropped,
+	// replaced or destroyed with its entity. Ids kept anywhere else must be freed with Destroy.
+    class AnimationSystem {
+    public:
+        using AnimationId = uint32_t; // 0 means no animation
+        static constexpr int SLOT_BITS = 20;
+
+		// Clips. Creating a clip under an existing name replaces it; playing animations pick up the new frames.
+        int CreateClip(const std::string& name, const std::string& textureName, std::vector<glm::vec4> frames,
+            float frameSeconds, PlaybackMode mode);
+		// Frames laid out left to right, top to bottom in a grid of equal cells
+        int CreateGridClip(const std::string& name, const std::string& textureName, uint32_t columns, uint32_t rows,
+            uint32_t firstFrame, uint32_t frameCount, float frameSeconds, PlaybackMode mode);
+        int FindClip(const std::string& name) const; // -1 when unknown
+        const AnimationClip* GetClip(int clip) const;
+
+		// Instances
+        AnimationId Play(int clip, float speed = 1.0f);
+        bool SetClip(AnimationId id, int clip); // Restarts from the first frame
+        void SetSpeed(AnimationId id, float speed);
+        void Destroy(AnimationId id);
+        bool IsAlive(AnimationId id) const;
+        bool IsFinished(AnimationId id) const;
+        uint32_t GetFrame(AnimationId id) const;
+        void Clear();
+
+		// Advances every playing animation by dt. Called once per tick.
+        void Tick(float dt);
+
+		// The clip and current frame rect of an animation, for drawing. nullptr for 0 or stale ids.
+        const AnimationClip* Resolve(AnimationId id, glm::vec4& uvRect) const;
+
+        size_t GetPlayingCount() const { return m_playing; }
+
+    private:
+        static constexpr uint32_t SLOT_MASK = (1u << SLOT_BITS) - 1;
+
+        int Slot(AnimationId id) const; // -1 for 0 or stale ids
+        static uint32_t FrameAt(const AnimationClip& clip, float time, bool& finished);
+
+        std::vector<AnimationClip> m_clips;
+        std::unordered_map<std::string, int> m_clipsByName;
+
+        // Instances by slot
+        std::vector<int> m_clip;            // -1 for free slots
+        std::vector<float> m_time;
+        std::vector<float> m_speed;
+        std::vector<uint32_t> m_frame;
+        std::vector<uint8_t> m_finished;
+        std::vector<uint32_t> m_generation; // Bumped on Destroy
+        std::vector<uint32_t> m_freeSlots;
+        size_t m_playing = 0;
+    };
+
+} // namespace enDjinn
@@ -0,0 +1,524 @@
+#include "CollisionSystem.h"
+#include "../utils/Stats.h"
+#include "../utils/Log.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <limits>
+
+namespace enDjinn {
+
+    namespace {
+        // Cell coordinates are clamped to this range, so far-away positions still convert to int
+        constexpr int MAX_CELL_COORD = 1 << 29;
+
+        bool IsFinite(const glm::vec2& v) {
+            return std::isfinite(v.x) && std::isfinite(v.y);
+        }
+
+		// Cell coordinate along one axis. Defined for any input; NaN lands on the lowest cell.
+        int CellCoord(float scaled) {
+            const float cell = std::floor(scaled);
+            if (!(cell > -static_cast<float>(MAX_CELL_COORD))) return -MAX_CELL_COORD;
+            if (cell > static_cast<float>(MAX_CELL_COORD)) return MAX_CELL_COORD;
+            return static_cast<int>(cell);
+        }
+    }
+
+	// Add method. Colliders are appended to the arrays; replacing one updates it in place.
+    bool CollisionSystem::Add(int64_t entity, const ColliderDesc& desc) {
+        if (!IsFinite(desc.offset) || !IsFinite(desc.halfExtents) || !std::isfinite(desc.radius)) {
+            ENDJINN_WARN_EVERY(1000, "CollisionSystem: Collider for entity {} has a non-finite size or offset, not added.", entity);
+            return false;
+        }
+
+        const int existing = Index(entity);
+        size_t i;
+        if (existing >= 0) {
+            i = static_cast<size_t>(existing);
+        }
+        else {
+            i = m_entity.size();
+            m_indexByEntity[entity] = static_cast<uint32_t>(i);
+            m_entity.push_back(entity);
+            m_shape.emplace_back();
+            m_center.emplace_back(0.0f);
+            m_offset.emplace_back(0.0f);
+            m_halfExtents.emplace_back(0.0f);
+            m_radius.push_back(0.0f);
+            m_layer.push_back(0);
+            m_mask.push_back(0);
+            m_followSprite.push_back(0);
+        }
+
+        const glm::vec2 position = existing >= 0 ? m_center[i] - m_offset[i] : glm::vec2(0.0f);
+        m_shape[i] = desc.shape;
+        m_offset[i] = desc.offset;
+        m_center[i] = position + desc.offset;
+        m_radius[i] = std::max(desc.radius, 0.0f);
+        m_halfExtents[i] = desc.shape == ColliderShape::Circle ? glm::vec2(m_radius[i]) : glm::max(desc.halfExtents, glm::vec2(0.0f));
+        m_layer[i] = desc.layer;
+        m_mask[i] = desc.mask;
+        m_followSprite[i] = desc.followSprite;
+        m_gridDirty = true;
+        return true;
+    }
+
+    void CollisionSystem::Remove(int64_t entity) {
+        const int i = Index(entity);
+        if (i >= 0) RemoveAt(static_cast<size_t>(i));
+    }
+
+    bool CollisionSystem::Has(int64_t entity) const {
+        return Index(entity) >= 0;
+    }
+
+    void CollisionSystem::SetPosition(int64_t entity, const glm::vec2& position) {
+        const int i = Index(entity);
+        if (i < 0) return;
+        if (!IsFinite(position)) {
+            ENDJINN_WARN_EVERY(1000, "CollisionSystem: Ignoring non-finite position for entity {}.", entity);
+            return;
+        }
+        const glm::vec2 center = position + m_offset[i];
+        if (center == m_center[i]) return;
+        m_center[i] = center;
+        m_gridDirty = true;
+    }
+
+    void CollisionSystem::SetLayer(int64_t entity, uint32_t layer, uint32_t mask) {
+        const int i = Index(entity);
+        if (i < 0) return;
+        m_layer[i] = layer;
+        m_mask[i] = mask;
+    }
+
+    void CollisionSystem::Clear() {
+        for (auto* column : { &m_center, &m_offset, &m_halfExtents }) column->clear();
+        m_entity.clear();
+        m_shape.clear();
+        m_radius.clear();
+        m_layer.clear();
+        m_mask.clear();
+        m_followSprite.clear();
+        m_indexByEntity.clear();
+        m_cells.clear();
+        m_oversized.clear();
+        m_gridDirty = true;
+    }
+
+    std::vector<ColliderState> CollisionSystem::GetColliders() const {
+        std::vector<ColliderState> colliders(m_entity.size());
+        for (size_t i = 0; i < m_entity.size(); ++i) {
+            ColliderState& state = colliders[i];
+            state.entity = m_entity[i];
+            state.desc.shape = m_shape[i];
+            state.desc.halfExtents = m_halfExtents[i];
+            state.desc.radius = m_radius[i];
+            state.desc.offset = m_offset[i];
+            state.desc.layer = m_layer[i];
+            state.desc.mask = m_mask[i];
+            state.desc.followSprite = m_followSprite[i] != 0;
+            state.position = m_center[i] - m_offset[i];
+        }
+        return colliders;
+    }
+
+	// SetColliders method. Goes through Add and SetPosition, so restored data is validated like script input.
+    void CollisionSystem::SetColliders(const std::vector<ColliderState>& colliders) {
+        Clear();
+        for (const ColliderState& state : colliders) {
+            if (Add(state.entity, state.desc)) SetPosition(state.entity, state.position);
+        }
+    }
+
+    void CollisionSystem::SetCellSize(float cellSize) {
+        if (cellSize <= 0.0f) {
+            spdlog::warn("CollisionSystem: Ignoring cell size {}.", cellSize);
+            return;
+        }
+        m_cellSize = cellSize;
+        m_inverseCellSize = 1.0f / cellSize;
+        m_gridDirty = true;
+    }
+
+	// SyncPositions method. Removal swaps the last collider into the current index, which is then visited again.
+    void CollisionSystem::SyncPositions(const std::function<bool(int64_t entity, glm::vec2& position)>& visitor) {
+        for (size_t i = 0; i < m_entity.size();) {
+            glm::vec2 position = m_center[i] - m_offset[i];
+            if (!visitor(m_entity[i], position)) {
+                RemoveAt(i);
+                continue;
+            }
+            if (!m_followSprite[i]) {
+                ++i;
+                continue;
+            }
+            if (!IsFinite(position)) {
+                ENDJINN_WARN_EVERY(1000, "CollisionSystem: Entity {} has a non-finite position, keeping its collider where it was.", m_entity[i]);
+                ++i;
+                continue;
+            }
+            const glm::vec2 center = position + m_offset[i];
+            if (center != m_center[i]) {
+                m_center[i] = center;
+                m_gridDirty = true;
+            }
+            ++i;
+        }
+    }
+
+	// Step method implementation
+    void CollisionSystem::Step() {
+		// 1. Broadphase: bucket every collider into the cells its bounding box touches
+        if (m_gridDirty) RebuildGrid();
+
+		// 2. Pairs within each cell. A pair sharing several cells is tested only in the cell holding the
+		// bottom-left corner of the two boxes' overlap, so nothing is reported twice.
+        m_contacts.clear();
+        uint64_t pairTests = 0;
+        auto testPair = [&](uint32_t i, uint32_t j) {
+            if (!(m_layer[i] & m_mask[j]) || !(m_layer[j] & m_mask[i])) return;
+            ++pairTests;
+            if (!Overlaps(i, j)) return;
+            const int64_t a = m_entity[i], b = m_entity[j];
+            m_contacts.push_back(a < b ? Contact{ a, b } : Contact{ b, a });
+        };
+        for (size_t begin = 0; begin < m_cells.size();) {
+            size_t end = begin + 1;
+            while (end < m_cells.size() && m_cells[end].cell == m_cells[begin].cell) ++end;
+
+            for (size_t p = begin; p < end; ++p) {
+                const uint32_t i = m_cells[p].collider;
+                for (size_t q = p + 1; q < end; ++q) {
+                    const uint32_t j = m_cells[q].collider;
+                    const glm::vec2 overlapMin = glm::max(m_center[i] - m_halfExtents[i], m_center[j] - m_halfExtents[j]);
+                    if (CellKey(CellOf(overlapMin).x, CellOf(overlapMin).y) != m_cells[begin].cell) continue;
+
+					// 3. Narrowphase on the exact shapes
+                    testPair(i, j);
+                }
+            }
+            begin = end;
+        }
+
+        // Oversized colliders are not in the grid and meet every other collider here; pairs of two oversized
+        // colliders are tested from the lower index only
+        for (const uint32_t i : m_oversized) {
+            for (uint32_t j = 0; j < m_entity.size(); ++j) {
+                if (j == i || (j < i && std::binary_search(m_oversized.begin(), m_oversized.end(), j))) continue;
+                testPair(i, j);
+            }
+        }
+
+		// 4. Diff against the previous step
+        std::sort(m_contacts.begin(), m_contacts.end());
+        m_begins.clear();
+        m_ends.clear();
+        std::set_difference(m_contacts.begin(), m_contacts.end(), m_previousContacts.begin(), m_previousContacts.end(), std::back_inserter(m_begins));
+        std::set_difference(m_previousContacts.begin(), m_previousContacts.end(), m_contacts.begin(), m_contacts.end(), std::back_inserter(m_ends));
+        m_previousContacts = m_contacts;
+
+        Stats& stats = Stats::Get();
+        stats.Set("collision.colliders", static_cast<double>(m_entity.size()));
+        stats.Set("collision.pair_tests", static_cast<double>(pairTests));
+        stats.Set("collision.contacts", static_cast<double>(m_contacts.size()));
+
+		// 5. One batch of events per tick
+        if (m_onContact && (!m_begins.empty() || !m_ends.empty())) {
+            m_onContact(m_begins, m_ends);
+        }
+    }
+
+	// QueryBox method. Falls back to a linear scan when the box covers more cells than there are colliders.
+    std::vector<int64_t> CollisionSystem::QueryBox(const glm::vec2& min, const glm::vec2& max, uint32_t mask) {
+        std::vector<int64_t> found;
+        const glm::vec2 center = 0.5f * (min + max);
+        const glm::vec2 half = 0.5f * glm::abs(max - min);
+        auto test = [&](uint32_t i) {
+            if (!(m_layer[i] & mask)) return;
+            const glm::vec2 delta = glm::abs(m_center[i] - center);
+            bool hit;
+            if (m_shape[i] == ColliderShape::Circle) {
+                const glm::vec2 outside = glm::max(delta - half, glm::vec2(0.0f));
+                hit = glm::dot(outside, outside) < m_radius[i] * m_radius[i];
+            }
+            else {
+                hit = delta.x < half.x + m_halfExtents[i].x && delta.y < half.y + m_halfExtents[i].y;
+            }
+            if (hit) found.push_back(m_entity[i]);
+        };
+
+        if (!IsFinite(min) || !IsFinite(max)) return found;
+        if (m_gridDirty) RebuildGrid();
+        const glm::ivec2 first = CellOf(center - half), last = CellOf(center + half);
+        const uint64_t cellCount = static_cast<uint64_t>(last.x - first.x + 1) * static_cast<uint64_t>(last.y - first.y + 1);
+        if (cellCount > m_entity.size()) {
+            for (uint32_t i = 0; i < m_entity.size(); ++i) test(i);
+            return found;
+        }
+
+        ++m_stamp;
+        for (int y = first.y; y <= last.y; ++y) {
+            for (int x = first.x; x <= last.x; ++x) {
+                ForEachInCell(x, y, [&](uint32_t i) {
+                    if (m_visitStamp[i] == m_stamp) return;
+                    m_visitStamp[i] = m_stamp;
+                    test(i);
+                });
+            }
+        }
+        for (const uint32_t i : m_oversized) test(i);
+        return found;
+    }
+
+	// QueryCircle method. The circle's bounding box picks the candidates; the exact shapes decide.
+    std::vector<int64_t> CollisionSystem::QueryCircle(const glm::vec2& center, float radius, uint32_t mask) {
+        std::vector<int64_t> candidates = QueryBox(center - glm::vec2(radius), center + glm::vec2(radius), mask);
+        std::erase_if(candidates, [&](int64_t entity) {
+            const uint32_t i = static_cast<uint32_t>(Index(entity));
+            if (m_shape[i] == ColliderShape::Circle) {
+                const glm::vec2 delta = m_center[i] - center;
+                const float reach = radius + m_radius[i];
+                return glm::dot(delta, delta) >= reach * reach;
+            }
+            const glm::vec2 closest = glm::clamp(center, m_center[i] - m_halfExtents[i], m_center[i] + m_halfExtents[i]);
+            const glm::vec2 delta = closest - center;
+            return glm::dot(delta, delta) >= radius * radius;
+        });
+        return candidates;
+    }
+
+	// Raycast method. Walks the grid cell by cell along the ray (DDA) and stops at the first cell whose
+	// far edge lies beyond the closest hit so far. The walk covers only the occupied cell bounds, so its
+	// length does not depend on maxDistance.
+    bool CollisionSystem::Raycast(const glm::vec2& origin, const glm::vec2& direction, float maxDistance, RayHit& hit, uint32_t mask) {
+        const float length = glm::length(direction);
+        if (!(length > 0.0f) || !(maxDistance > 0.0f) || m_entity.empty() || !IsFinite(origin) || !std::isfinite(length)) return false;
+        const glm::vec2 dir = direction / length;
+
+        if (m_gridDirty) RebuildGrid();
+        ++m_stamp;
+
+		// 0. Oversized colliders are outside the grid, so test them first; their hits shorten the walk below
+        bool found = false;
+        float best = maxDistance;
+        for (const uint32_t i : m_oversized) {
+            float distance;
+            glm::vec2 normal;
+            if ((m_layer[i] & mask) && RayTest(i, origin, dir, best, distance, normal) && (!found || distance < best)) {
+                found = true;
+                best = distance;
+                hit = { m_entity[i], distance, origin + dir * distance, normal };
+            }
+        }
+        if (m_cells.empty()) return found;
+
+		// 1. Clip the ray to the occupied bounds (slab test); a ray that misses them hits nothing
+        const glm::vec2 boundsMin = glm::vec2(m_occupiedMin) * m_cellSize;
+        const glm::vec2 boundsMax = glm::vec2(m_occupiedMax + 1) * m_cellSize;
+        float enter = 0.0f, leave = best;
+        for (int axis = 0; axis < 2; ++axis) {
+            if (dir[axis] == 0.0f) {
+                if (origin[axis] < boundsMin[axis] || origin[axis] > boundsMax[axis]) return found;
+                continue;
+            }
+            float t0 = (boundsMin[axis] - origin[axis]) / dir[axis];
+            float t1 = (boundsMax[axis] - origin[axis]) / dir[axis];
+            if (t0 > t1) std::swap(t0, t1);
+            enter = std::max(enter, t0);
+            leave = std::min(leave, t1);
+        }
+        if (enter > leave) return found;
+
+		// 2. Walk from the cell where the ray enters the bounds
+        glm::ivec2 cell = glm::clamp(CellOf(origin + dir * enter), m_occupiedMin, m_occupiedMax);
+        const glm::ivec2 step(dir.x > 0.0f ? 1 : -1, dir.y > 0.0f ? 1 : -1);
+        const float infinity = std::numeric_limits<float>::infinity();
+        // Distance along the ray to the next vertical and horizontal cell boundary, and between boundaries
+        glm::vec2 next, delta;
+        for (int axis = 0; axis < 2; ++axis) {
+            if (dir[axis] == 0.0f) {
+                next[axis] = delta[axis] = infinity;
+                continue;
+            }
+            const float boundary = (cell[axis] + (step[axis] > 0 ? 1 : 0)) * m_cellSize;
+            next[axis] = (boundary - origin[axis]) / dir[axis];
+            delta[axis] = m_cellSize / std::abs(dir[axis]);
+        }
+
+        float cellEntry = enter;
+        while (cellEntry <= best) {
+            ForEachInCell(cell.x, cell.y, [&](uint32_t i) {
+                if (m_visitStamp[i] == m_stamp || !(m_layer[i] & mask)) return;
+                m_visitStamp[i] = m_stamp;
+                float distance;
+                glm::vec2 normal;
+                if (RayTest(i, origin, dir, best, distance, normal) && (!found || distance < best)) {
+                    found = true;
+                    best = distance;
+                    hit = { m_entity[i], distance, origin + dir * distance, normal };
+                }
+            });
+
+            // Everything in this cell is closer than anything in the cells after it
+            const float cellExit = std::min(next.x, next.y);
+            if (found && best <= cellExit) break;
+            const int axis = next.x < next.y ? 0 : 1;
+            cellEntry = next[axis];
+            next[axis] += delta[axis];
+            cell[axis] += step[axis];
+            // Past the bounds along the axis it moves on, the ray never comes back to an occupied cell
+            if (cell[axis] < m_occupiedMin[axis] || cell[axis] > m_occupiedMax[axis]) break;
+        }
+        return found;
+    }
+
+    int CollisionSystem::Index(int64_t entity) const {
+        auto it = m_indexByEntity.find(entity);
+        return it != m_indexByEntity.end() ? static_cast<int>(it->second) : -1;
+    }
+
+	// RemoveAt method. Swaps the last collider into the freed index.
+    void CollisionSystem::RemoveAt(size_t index) {
+        const size_t last = m_entity.size() - 1;
+        m_indexByEntity.erase(m_entity[index]);
+        if (index != last) {
+            m_entity[index] = m_entity[last];
+            m_shape[index] = m_shape[last];
+            m_center[index] = m_center[last];
+            m_offset[index] = m_offset[last];
+            m_halfExtents[index] = m_halfExtents[last];
+            m_radius[index] = m_radius[last];
+            m_layer[index] = m_layer[last];
+            m_mask[index] = m_mask[last];
+            m_followSprite[index] = m_followSprite[last];
+            m_indexByEntity[m_entity[index]] = static_cast<uint32_t>(index);
+        }
+        m_entity.pop_back();
+        m_shape.pop_back();
+        m_center.pop_back();
+        m_offset.pop_back();
+        m_halfExtents.pop_back();
+        m_radius.pop_back();
+        m_layer.pop_back();
+        m_mask.pop_back();
+        m_followSprite.pop_back();
+        m_gridDirty = true;
+    }
+
+    glm::ivec2 CollisionSystem::CellOf(const glm::vec2& point) const {
+        return glm::ivec2(CellCoord(point.x * m_inverseCellSize), CellCoord(point.y * m_inverseCellSize));
+    }
+
+    uint64_t CollisionSystem::CellKey(int x, int y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+
+	// RebuildGrid method. The hash is a sorted array of (cell, collider) entries, so each cell's colliders are contiguous.
+	// Colliders spanning more than MAX_COLLIDER_CELLS cells go to the oversized list instead.
+    void CollisionSystem::RebuildGrid() {
+        m_cells.clear();
+        m_oversized.clear();
+        m_occupiedMin = glm::ivec2(std::numeric_limits<int>::max());
+        m_occupiedMax = glm::ivec2(std::numeric_limits<int>::min());
+        for (uint32_t i = 0; i < m_entity.size(); ++i) {
+            const glm::ivec2 first = CellOf(m_center[i] - m_halfExtents[i]);
+            const glm::ivec2 last = CellOf(m_center[i] + m_halfExtents[i]);
+            const uint64_t span = static_cast<uint64_t>(last.x - first.x + 1) * static_cast<uint64_t>(last.y - first.y + 1);
+            if (span > MAX_COLLIDER_CELLS) {
+                m_oversized.push_back(i);
+                continue;
+            }
+            m_occupiedMin = glm::min(m_occupiedMin, first);
+            m_occupiedMax = glm::max(m_occupiedMax, last);
+            for (int y = first.y; y <= last.y; ++y) {
+                for (int x = first.x; x <= last.x; ++x) {
+                    m_cells.push_back({ CellKey(x, y), i });
+                }
+            }
+        }
+        std::sort(m_cells.begin(), m_cells.end());
+        m_visitStamp.assign(m_entity.size(), 0);
+        m_stamp = 0;
+        m_gridDirty = false;
+    }
+
+    template<typename Visit>
+    void CollisionSystem::ForEachInCell(int x, int y, Visit&& visit) const {
+        const uint64_t key = CellKey(x, y);
+        auto it = std::lower_bound(m_cells.begin(), m_cells.end(), CellEntry{ key, 0 });
+        for (; it != m_cells.end() && it->cell == key; ++it) {
+            visit(it->collider);
+        }
+    }
+
+	// Overlaps method. Exact test for each pair of shapes; touching edges do not count.
+    bool CollisionSystem::Overlaps(size_t i, size_t j) const {
+        const ColliderShape a = m_shape[i], b = m_shape[j];
+        if (a == ColliderShape::Box && b == ColliderShape::Box) {
+            const glm::vec2 delta = glm::abs(m_center[i] - m_center[j]);
+            const glm::vec2 reach = m_halfExtents[i] + m_halfExtents[j];
+            return delta.x < reach.x && delta.y < reach.y;
+        }
+        if (a == ColliderShape::Circle && b == ColliderShape::Circle) {
+            const glm::vec2 delta = m_center[i] - m_center[j];
+            const float reach = m_radius[i] + m_radius[j];
+            return glm::dot(delta, delta) < reach * reach;
+        }
+
+        // Box and circle: the box's closest point to the circle's center must lie inside the circle
+        const size_t box = a == ColliderShape::Box ? i : j;
+        const size_t circle = a == ColliderShape::Box ? j : i;
+        const glm::vec2 closest = glm::clamp(m_center[circle], m_center[box] - m_halfExtents[box], m_center[box] + m_halfExtents[box]);
+        const glm::vec2 delta = m_center[circle] - closest;
+        return glm::dot(delta, delta) < m_radius[circle] * m_radius[circle];
+    }
+
+	// RayTest method. A ray starting inside a collider hits it at distance 0, facing back along the ray.
+    bool CollisionSystem::RayTest(size_t i, const glm::vec2& origin, const glm::vec2& direction, float maxDistance, float& distance, glm::vec2& normal) const {
+        if (m_shape[i] == ColliderShape::Circle) {
+            const glm::vec2 m = origin - m_center[i];
+            const float b = glm::dot(m, direction);
+            const float c = glm::dot(m, m) - m_radius[i] * m_radius[i];
+            if (c > 0.0f && b > 0.0f) return false;
+            const float discriminant = b * b - c;
+            if (discriminant < 0.0f) return false;
+            distance = std::max(-b - std::sqrt(discriminant), 0.0f);
+            if (distance > maxDistance) return false;
+            normal = c <= 0.0f ? -direction : glm::normalize(origin + direction * distance - m_center[i]);
+            return true;
+        }
+
+        // Slab test, tracking which axis the ray entered through
+        float tMin = 0.0f, tMax = maxDistance;
+        int entryAxis = -1;
+        for (int axis = 0; axis < 2; ++axis) {
+            const float low = m_center[i][axis] - m_halfExtents[i][axis];
+            const float high = m_center[i][axis] + m_halfExtents[i][axis];
+            if (direction[axis] == 0.0f) {
+                if (origin[axis] < low || origin[axis] > high) return false;
+                continue;
+            }
+            float t0 = (low - origin[axis]) / direction[axis];
+            float t1 = (high - origin[axis]) / direction[axis];
+            if (t0 > t1) std::swap(t0, t1);
+            if (t0 > tMin) {
+                tMin = t0;
+                entryAxis = axis;
+            }
+            tMax = std::min(tMax, t1);
+            if (tMin > tMax) return false;
+        }
+
+        distance = tMin;
+        normal = -direction;
+        if (entryAxis >= 0) {
+            normal = glm::vec2(0.0f);
+            normal[entryAxis] = direction[entryAxis] > 0.0f ? -1.0f : 1.0f;
+        }
+        return true;
+    }
+
+} // namespace enDjinn
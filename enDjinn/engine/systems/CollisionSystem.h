@@ -0,0 +1,140 @@
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+namespace enDjinn {
+
+    enum class ColliderShape : uint8_t {
+        Box,    // Axis-aligned, given by its half extents
+        Circle
+    };
+
+	// Collider settings. An entity collides with another only if each one's layer is in the other's mask.
+    struct ColliderDesc {
+        ColliderShape shape = ColliderShape::Box;
+        glm::vec2 halfExtents = { 0.5f, 0.5f }; // Box
+        float radius = 0.5f;                    // Circle
+        glm::vec2 offset = { 0.0f, 0.0f };      // From the entity's position to the collider's center
+        uint32_t layer = 1;
+        uint32_t mask = ~0u;
+        bool followSprite = true; // Take the position from the entity's Sprite component every tick
+    };
+
+	// One collider as stored, for world snapshots
+    struct ColliderState {
+        int64_t entity = 0;
+        ColliderDesc desc;
+        glm::vec2 position = { 0.0f, 0.0f }; // The entity's, without the offset
+    };
+
+	// A pair of touching entities, ordered so that a < b
+    struct Contact {
+        int64_t a = 0;
+        int64_t b = 0;
+        bool operator<(const Contact& other) const { return a != other.a ? a < other.a : b < other.b; }
+        bool operator==(const Contact& other) const { return a == other.a && b == other.b; }
+    };
+
+    struct RayHit {
+        int64_t entity = 0;
+        float distance = 0.0f;
+        glm::vec2 point = { 0.0f, 0.0f };
+        glm::vec2 normal = { 0.0f, 0.0f };
+    };
+
+	// Broadphase and narrowphase collision for ECS entities. Each entity has at most one collider, stored natively
+	// in structure-of-arrays form. Every step re-buckets the colliders into a uniform grid (a spatial hash kept as a
+	// sorted array of cell entries), tests only pairs that share a cell, and diffs the touching pairs against the
+	// previous step, so contact begin and end events go out in one batch per tick. Overlap and raycast queries use
+	// the same grid. Entities are Lua ECS handles (EntityId); colliders of destroyed entities are dropped by the sync.
+	//
+	// Positions and sizes must be finite; non-finite ones are rejected. A collider spanning more than
+	// MAX_COLLIDER_CELLS cells is kept out of the grid and tested against everything instead.
+    class CollisionSystem {
+    public:
+        using ContactCallback = std::function<void(const std::vector<Contact>& begins, const std::vector<Contact>& ends)>;
+        static constexpr uint64_t MAX_COLLIDER_CELLS = 64;
+
+        CollisionSystem() = default;
+
+		// Colliders. Adding to an entity that already has one replaces it. Fails for non-finite sizes or offsets.
+        bool Add(int64_t entity, const ColliderDesc& desc);
+        void Remove(int64_t entity);
+        bool Has(int64_t entity) const;
+        void SetPosition(int64_t entity, const glm::vec2& position);
+        void SetLayer(int64_t entity, uint32_t layer, uint32_t mask);
+        void Clear();
+        size_t GetCount() const { return m_entity.size(); }
+        // Every collider, in storage order. SetColliders replaces all colliders with such a list.
+        std::vector<ColliderState> GetColliders() const;
+        void SetColliders(const std::vector<ColliderState>& colliders);
+
+		// Grid cells should be about the size of a typical collider
+        void SetCellSize(float cellSize);
+        void SetContactCallback(ContactCallback callback) { m_onContact = std::move(callback); }
+
+		// Position sync: visits every collider with its current position. The visitor returns false for dead entities,
+		// whose colliders are then removed; positions it writes are kept for colliders that follow their sprite.
+        void SyncPositions(const std::function<bool(int64_t entity, glm::vec2& position)>& visitor);
+
+		// Runs the broad- and narrowphase and delivers this tick's contact events. Called once per tick.
+        void Step();
+        const std::vector<Contact>& GetContacts() const { return m_contacts; } // Sorted
+
+		// Queries against the current positions. 'mask' selects the layers to report.
+        std::vector<int64_t> QueryBox(const glm::vec2& min, const glm::vec2& max, uint32_t mask = ~0u);
+        std::vector<int64_t> QueryCircle(const glm::vec2& center, float radius, uint32_t mask = ~0u);
+        bool Raycast(const glm::vec2& origin, const glm::vec2& direction, float maxDistance, RayHit& hit, uint32_t mask = ~0u);
+
+    private:
+        struct CellEntry {
+            uint64_t cell;
+            uint32_t collider;
+            bool operator<(const CellEntry& other) const { return cell != other.cell ? cell < other.cell : collider < other.collider; }
+        };
+
+        int Index(int64_t entity) const;
+        void RemoveAt(size_t index);
+        glm::ivec2 CellOf(const glm::vec2& point) const;
+        static uint64_t CellKey(int x, int y);
+        void RebuildGrid();
+        template<typename Visit> void ForEachInCell(int x, int y, Visit&& visit) const;
+        bool Overlaps(size_t i, size_t j) const;
+        bool RayTest(size_t i, const glm::vec2& origin, const glm::vec2& direction, float maxDistance, float& distance, glm::vec2& normal) const;
+
+        float m_cellSize = 16.0f;
+        float m_inverseCellSize = 1.0f / 16.0f;
+
+        // Colliders, one array per attribute
+        std::vector<int64_t> m_entity;
+        std::vector<ColliderShape> m_shape;
+        std::vector<glm::vec2> m_center;      // World-space, offset included
+        std::vector<glm::vec2> m_offset;
+        std::vector<glm::vec2> m_halfExtents; // Bounding box half extents, also for circles
+        std::vector<float> m_radius;
+        std::vector<uint32_t> m_layer;
+        std::vector<uint32_t> m_mask;
+        std::vector<uint8_t> m_followSprite;
+        std::unordered_map<int64_t, uint32_t> m_indexByEntity;
+
+        // Spatial hash, rebuilt lazily when a collider changed since the last build
+        std::vector<CellEntry> m_cells;
+        std::vector<uint32_t> m_oversized; // Colliders spanning too many cells for the grid, in index order
+        bool m_gridDirty = true;
+        glm::ivec2 m_occupiedMin = { 0, 0 }; // Bounds of the cells holding colliders, inclusive; bound raycast walks
+        glm::ivec2 m_occupiedMax = { 0, 0 };
+        std::vector<uint32_t> m_visitStamp; // Per collider, so queries report each collider once
+        uint32_t m_stamp = 0;
+
+        std::vector<Contact> m_contacts;
+        std::vector<Contact> m_previousContacts;
+        std::vector<Contact> m_begins;
+        std::vector<Contact> m_ends;
+        ContactCallback m_onContact;
+    };
+
+} // namespace enDjinn
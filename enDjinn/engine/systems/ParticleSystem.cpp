@@ -0,0 +1,263 @@
+#include "ParticleSystem.h"
+#include "../assets/ResourceManager.h"
+#include "../managers/GraphicsManager.h"
+#include "../utils/SimdMath.h"
+#include "../utils/Stats.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+    template< typename T > constexpr const T* to_ptr(const T& val) { return &val; }
+}
+
+namespace enDjinn {
+
+    ParticleSystem::~ParticleSystem() {
+        Shutdown();
+    }
+
+    void ParticleSystem::Startup(WGPUDevice device) {
+        m_device = device;
+    }
+
+    void ParticleSystem::Shutdown() {
+        m_emitters.clear();
+        m_device = nullptr;
+    }
+
+	// CreateEmitter method. The whole pool is allocated here, once.
+    int ParticleSystem::CreateEmitter(const std::string& textureName, uint32_t capacity, const EmitterConfig& config) {
+        if (capacity == 0) {
+            spdlog::error("ParticleSystem: Cannot create an emitter for '{}' with zero capacity.", textureName);
+            return -1;
+        }
+
+        auto emitter = std::make_unique<Emitter>();
+        emitter->textureName = textureName;
+        emitter->config = config;
+        emitter->capacity = capacity;
+        emitter->random.seed(static_cast<uint32_t>(m_emitters.size()) + 1); // Deterministic, for headless runs
+        for (std::vector<float>* column : { &emitter->x, &emitter->y, &emitter->velocityX, &emitter->velocityY,
+            &emitter->age, &emitter->inverseLifetime, &emitter->lifeFraction, &emitter->scale }) {
+            column->resize(capacity);
+        }
+
+        m_emitters.push_back(std::move(emitter));
+        return static_cast<int>(m_emitters.size()) - 1;
+    }
+
+    void ParticleSystem::Destroy(int emitter) {
+        if (Find(emitter)) m_emitters[emitter].reset();
+    }
+
+    void ParticleSystem::SetConfig(int emitter, const EmitterConfig& config) {
+        if (Emitter* e = Find(emitter)) e->config = config;
+    }
+
+    void ParticleSystem::SetPosition(int emitter, const glm::vec2& position) {
+        if (Emitter* e = Find(emitter)) e->position = position;
+    }
+
+    void ParticleSystem::SetEmitting(int emitter, bool emitting) {
+        if (Emitter* e = Find(emitter)) {
+            e->emitting = emitting;
+            e->spawnDebt = 0.0f;
+        }
+    }
+
+    void ParticleSystem::Burst(int emitter, uint32_t count) {
+        if (Emitter* e = Find(emitter)) Spawn(*e, count);
+    }
+
+    void ParticleSystem::Clear(int emitter) {
+        if (Emitter* e = Find(emitter)) e->count = 0;
+    }
+
+    uint32_t ParticleSystem::GetCount(int emitter) const {
+        const Emitter* e = Find(emitter);
+        return e ? e->count : 0;
+    }
+
+	// Tick method implementation
+    void ParticleSystem::Tick(float dt) {
+        uint32_t alive = 0;
+        for (std::unique_ptr<Emitter>& emitter : m_emitters) {
+            if (!emitter) continue;
+
+			// 1. Emission. The rate accumulates fractional particles across ticks.
+            if (emitter->emitting && emitter->config.rate > 0.0f) {
+                emitter->spawnDebt += emitter->config.rate * dt;
+                const uint32_t due = static_cast<uint32_t>(emitter->spawnDebt);
+                emitter->spawnDebt -= static_cast<float>(due);
+                Spawn(*emitter, due);
+            }
+
+			// 2. Simulation
+            if (emitter->count > 0) Update(*emitter, dt);
+            alive += emitter->count;
+        }
+        Stats::Get().Set("particles.alive", alive);
+    }
+
+	// Spawn method. Particles beyond the pool's capacity are dropped.
+    void ParticleSystem::Spawn(Emitter& emitter, uint32_t count) {
+        const EmitterConfig& config = emitter.config;
+        count = std::min(count, emitter.capacity - emitter.count);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        for (uint32_t n = 0; n < count; ++n) {
+            const uint32_t i = emitter.count++;
+            const float angle = config.direction + (unit(emitter.random) - 0.5f) * config.spread;
+            const float speed = config.speedMin + (config.speedMax - config.speedMin) * unit(emitter.random);
+            const float lifetime = config.lifetimeMin + (config.lifetimeMax - config.lifetimeMin) * unit(emitter.random);
+
+            emitter.x[i] = emitter.position.x;
+            emitter.y[i] = emitter.position.y;
+            emitter.velocityX[i] = std::cos(angle) * speed;
+            emitter.velocityY[i] = std::sin(angle) * speed;
+            emitter.age[i] = 0.0f;
+            emitter.inverseLifetime[i] = 1.0f / std::max(lifetime, 0.001f);
+            emitter.lifeFraction[i] = 0.0f;
+            emitter.scale[i] = config.startScale;
+        }
+    }
+
+	// Update method. Every pass runs over the live range of one array at a time.
+    void ParticleSystem::Update(Emitter& emitter, float dt) {
+        const EmitterConfig& config = emitter.config;
+        const size_t count = emitter.count;
+
+		// 1. Integrate: constant gravity, then positions from the new velocities (semi-implicit Euler)
+        simd::ScaleAdd(emitter.velocityX.data(), 1.0f, config.gravity.x * dt, emitter.velocityX.data(), count);
+        simd::ScaleAdd(emitter.velocityY.data(), 1.0f, config.gravity.y * dt, emitter.velocityY.data(), count);
+        simd::AddScaled(emitter.x.data(), emitter.velocityX.data(), dt, count);
+        simd::AddScaled(emitter.y.data(), emitter.velocityY.data(), dt, count);
+
+		// 2. Age, and the scale that follows from the fraction of life used
+        simd::ScaleAdd(emitter.age.data(), 1.0f, dt, emitter.age.data(), count);
+        simd::Multiply(emitter.age.data(), emitter.inverseLifetime.data(), emitter.lifeFraction.data(), count);
+        simd::ScaleAdd(emitter.lifeFraction.data(), config.endScale - config.startScale, config.startScale, emitter.scale.data(), count);
+
+		// 3. Swap expired particles out with the last live one
+        uint32_t live = emitter.count;
+        for (uint32_t i = 0; i < live;) {
+            if (emitter.lifeFraction[i] < 1.0f) {
+                ++i;
+                continue;
+            }
+            --live;
+            for (std::vector<float>* column : { &emitter.x, &emitter.y, &emitter.velocityX, &emitter.velocityY,
+                &emitter.age, &emitter.inverseLifetime, &emitter.lifeFraction, &emitter.scale }) {
+                (*column)[i] = (*column)[live];
+            }
+        }
+        emitter.count = live;
+    }
+
+	// Capture method. Writes each emitter's live particles straight into a mapped instance buffer.
+    void ParticleSystem::Capture(std::vector<ParticleFrame>& frames, ResourceManager& resourceManager) {
+        if (!m_device) return;
+
+        for (std::unique_ptr<Emitter>& emitterPtr : m_emitters) {
+            if (!emitterPtr || emitterPtr->count == 0) continue;
+            Emitter& emitter = *emitterPtr;
+
+            const Texture* texture = resourceManager.GetTexture(emitter.textureName);
+            if (!texture || !texture->texture) continue;
+            glm::vec2 aspect(1.0f);
+            if (texture->width < texture->height) {
+                aspect.x = static_cast<float>(texture->width) / texture->height;
+            }
+            else {
+                aspect.y = static_cast<float>(texture->height) / texture->width;
+            }
+
+            const uint64_t bufferSize = sizeof(InstanceData) * emitter.count;
+            WGPUBuffer buffer = wgpuDeviceCreateBuffer(m_device, to_ptr(WGPUBufferDescriptor{
+                .label = WGPUStringView("Particle Instance Buffer", WGPU_STRLEN),
+                .usage = WGPUBufferUsage_Vertex,
+                .size = bufferSize,
+                .mappedAtCreation = true
+                }));
+            if (!buffer) continue;
+
+            InstanceData* instances = static_cast<InstanceData*>(wgpuBufferGetMappedRange(buffer, 0, bufferSize));
+            const float z = emitter.config.z;
+            for (uint32_t i = 0; i < emitter.count; ++i) {
+                instances[i].translation = glm::vec3(emitter.x[i], emitter.y[i], z);
+                instances[i].scale = glm::vec2(emitter.scale[i] * aspect.x, emitter.scale[i] * aspect.y);
+                instances[i].uvRect = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+            }
+            wgpuBufferUnmap(buffer);
+
+            wgpuTextureAddRef(texture->texture);
+            ParticleFrame& frame = frames.emplace_back();
+            frame.instanceBuffer = buffer;
+            frame.texture = texture->texture;
+            frame.instanceCount = emitter.count;
+            frame.blend = emitter.config.blend;
+            Stats::Get().Add("gpu.upload_bytes", static_cast<double>(bufferSize));
+        }
+    }
+
+	// Draw method. One bind group and one instanced draw per emitter.
+    void ParticleSystem::Draw(WGPURenderPassEncoder renderPass, const std::vector<ParticleFrame>& frames,
+        WGPUBuffer projectionBuffer, uint64_t projectionSize, WGPUSampler sampler, WGPUBuffer quadBuffer) {
+        WGPURenderPipeline currentPipeline = nullptr;
+        WGPUBindGroupLayout layout = nullptr;
+
+        for (const ParticleFrame& frame : frames) {
+            if (!frame.pipeline) continue;
+            if (frame.pipeline != currentPipeline) {
+                currentPipeline = frame.pipeline;
+                wgpuRenderPassEncoderSetPipeline(renderPass, currentPipeline);
+                wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, quadBuffer, 0, 4 * 4 * sizeof(float));
+                if (layout) wgpuBindGroupLayoutRelease(layout);
+                layout = wgpuRenderPipelineGetBindGroupLayout(currentPipeline, 0);
+            }
+
+            WGPUTextureView textureView = wgpuTextureCreateView(frame.texture, nullptr);
+            std::array<WGPUBindGroupEntry, 3> entries{};
+            entries[0] = { .binding = 0, .buffer = projectionBuffer, .size = projectionSize };
+            entries[1] = { .binding = 1, .sampler = sampler };
+            entries[2] = { .binding = 2, .textureView = textureView };
+            WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(m_device, to_ptr(WGPUBindGroupDescriptor{
+                .layout = layout,
+                .entryCount = entries.size(),
+                .entries = entries.data()
+                }));
+            wgpuTextureViewRelease(textureView);
+
+            wgpuRenderPassEncoderSetBindGroup(renderPass, 0, bindGroup, 0, nullptr);
+            wgpuRenderPassEncoderSetVertexBuffer(renderPass, 1, frame.instanceBuffer, 0, sizeof(InstanceData) * frame.instanceCount);
+            wgpuRenderPassEncoderDraw(renderPass, 4, frame.instanceCount, 0, 0);
+            wgpuBindGroupRelease(bindGroup);
+        }
+        if (layout) wgpuBindGroupLayoutRelease(layout);
+    }
+
+	// Release method. Drops the snapshot's buffers and texture references.
+    void ParticleSystem::Release(std::vector<ParticleFrame>& frames) {
+        for (ParticleFrame& frame : frames) {
+            if (frame.instanceBuffer) wgpuBufferRelease(frame.instanceBuffer);
+            if (frame.texture) wgpuTextureRelease(frame.texture);
+        }
+        frames.clear();
+    }
+
+    ParticleSystem::Emitter* ParticleSystem::Find(int emitter) {
+        if (emitter < 0 || static_cast<size_t>(emitter) >= m_emitters.size() || !m_emitters[emitter]) {
+            spdlog::warn("ParticleSystem: Unknown emitter {}.", emitter);
+            return nullptr;
+        }
+        return m_emitters[emitter].get();
+    }
+
+    const ParticleSystem::Emitter* ParticleSystem::Find(int emitter) const {
+        if (emitter < 0 || static_cast<size_t>(emitter) >= m_emitters.size()) return nullptr;
+        return m_emitters[emitter].get();
+    }
+
+} // namespace enDjinn
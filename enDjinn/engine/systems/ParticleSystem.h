@@ -0,0 +1,96 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+#include <glm/glm.hpp>
+#include "../assets/Sprite.h"
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace enDjinn {
+
+    class ResourceManager;
+
+	// How an emitter spawns and shapes its particles. Angles are in radians, 0 pointing along +x.
+    struct EmitterConfig {
+        float rate = 0.0f;          // Particles per second while emitting; bursts work with a rate of 0
+        float lifetimeMin = 1.0f;
+        float lifetimeMax = 1.0f;
+        float speedMin = 10.0f;
+        float speedMax = 10.0f;
+        float direction = 0.0f;
+        float spread = 6.2831853f;  // Full circle by default
+        glm::vec2 gravity = { 0.0f, 0.0f };
+        float startScale = 1.0f;
+        float endScale = 0.0f;      // Scale is interpolated over each particle's lifetime
+        float z = 0.0f;
+        BlendMode blend = BlendMode::Additive;
+    };
+
+	// One emitter's share of a frame snapshot: its live particles as instance data, drawn with one call
+    struct ParticleFrame {
+        WGPUBuffer instanceBuffer = nullptr; // Owned by the snapshot
+        WGPUTexture texture = nullptr;       // Referenced for as long as the snapshot is in flight
+        uint32_t instanceCount = 0;
+        BlendMode blend = BlendMode::Additive;
+        WGPURenderPipeline pipeline = nullptr; // Filled in by the GraphicsManager from the blend mode
+    };
+
+	// CPU particles for effects such as explosions and sparks. Each emitter owns a fixed pool of particles in
+	// structure-of-arrays form, allocated once at its capacity; spawning fills the next free slot and dying
+	// particles are swapped out, so there is no per-particle allocation. The update is a handful of SIMD passes
+	// over the arrays, and an emitter draws all its particles with one instanced call on the shared quad.
+    class ParticleSystem {
+    public:
+        ParticleSystem() = default;
+        ~ParticleSystem();
+
+        void Startup(WGPUDevice device);
+        void Shutdown();
+
+		// Main thread API (also what Lua calls)
+        int CreateEmitter(const std::string& textureName, uint32_t capacity, const EmitterConfig& config);
+        void Destroy(int emitter);
+        void SetConfig(int emitter, const EmitterConfig& config);
+        void SetPosition(int emitter, const glm::vec2& position);
+        void SetEmitting(int emitter, bool emitting);
+        void Burst(int emitter, uint32_t count);
+        void Clear(int emitter);
+        uint32_t GetCount(int emitter) const;
+
+		// Spawns from the emission rate and integrates every particle. Called once per tick.
+        void Tick(float dt);
+
+		// Frame snapshot hooks: Capture on the main thread, Draw on whichever thread renders
+        void Capture(std::vector<ParticleFrame>& frames, ResourceManager& resourceManager);
+        void Draw(WGPURenderPassEncoder renderPass, const std::vector<ParticleFrame>& frames,
+            WGPUBuffer projectionBuffer, uint64_t projectionSize, WGPUSampler sampler, WGPUBuffer quadBuffer);
+        static void Release(std::vector<ParticleFrame>& frames);
+
+    private:
+        struct Emitter {
+            std::string textureName;
+            EmitterConfig config;
+            glm::vec2 position = { 0.0f, 0.0f };
+            bool emitting = true;
+            float spawnDebt = 0.0f; // Fractional particles owed by the emission rate
+            uint32_t capacity = 0;
+            uint32_t count = 0;     // Live particles occupy [0, count)
+            std::minstd_rand random;
+
+            // Particle pool, one array per attribute
+            std::vector<float> x, y, velocityX, velocityY, age, inverseLifetime, lifeFraction, scale;
+        };
+
+        Emitter* Find(int emitter);
+        const Emitter* Find(int emitter) const;
+        static void Spawn(Emitter& emitter, uint32_t count);
+        static void Update(Emitter& emitter, float dt);
+
+        WGPUDevice m_device = nullptr;
+        std::vector<std::unique_ptr<Emitter>> m_emitters; // Destroyed emitters leave a null entry, so ids stay stable
+    };
+
+} // namespace enDjinn
@@ -0,0 +1,480 @@
+#include "SwarmSystem.h"
+#include "../assets/ResourceManager.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <array>
+#include <string_view>
+#include <utility>
+
+namespace {
+    template< typename T > constexpr const T* to_ptr(const T& val) { return &val; }
+    template< typename T, std::size_t N > constexpr const T* to_ptr(const T(&& arr)[N]) { return arr; }
+
+	// Per-swarm uniform block, shared by the compute and render pipelines ('SwarmParams' in the WGSL)
+    struct SwarmParams {
+        float stepSeconds;
+        uint32_t steps;
+        float z;
+        uint32_t count;
+        glm::vec2 aspect;
+        glm::vec2 padding; // Uniform buffers are sized in multiples of 16 bytes
+    };
+
+    constexpr uint32_t WORKGROUP_SIZE = 64;
+
+    constexpr const char* MOTION_WGSL = R"(
+        struct Motion {
+            position: vec2f,
+            velocity: vec2f,
+            acceleration: vec2f,
+            scale: vec2f,
+            age: f32,
+            lifetime: f32,
+        };
+
+        struct SwarmParams {
+            stepSeconds: f32,
+            steps: u32,
+            z: f32,
+            count: u32,
+            aspect: vec2f,
+        };
+
+        fn is_expired(m: Motion) -> bool {
+            return m.lifetime > 0.0 && m.age >= m.lifetime;
+        }
+    )";
+
+    constexpr const char* COMPUTE_WGSL = R"(
+        @group(0) @binding(0) var<uniform> params: SwarmParams;
+        @group(0) @binding(1) var<storage, read_write> motion: array<Motion>;
+
+        @compute @workgroup_size(64) fn integrate(@builtin(global_invocation_id) id: vec3u) {
+            if (id.x >= params.count) {
+                return;
+            }
+            var m = motion[id.x];
+            // Several ticks may have passed since the last frame; replay each one so motion is frame rate independent
+            for (var step = 0u; step < params.steps && !is_expired(m); step++) {
+                m.velocity += m.acceleration * params.stepSeconds;
+                m.position += m.velocity * params.stepSeconds;
+                m.age += params.stepSeconds;
+            }
+            motion[id.x] = m;
+        }
+    )";
+
+    constexpr const char* RENDER_WGSL = R"(
+        struct Uniforms {
+            projection: mat4x4f,
+        };
+
+        @group(0) @binding(0) var<uniform> uniforms: Uniforms;
+        @group(0) @binding(1) var texSampler: sampler;
+        @group(0) @binding(2) var texData: texture_2d<f32>;
+        @group(1) @binding(0) var<uniform> params: SwarmParams;
+        @group(1) @binding(1) var<storage, read> motion: array<Motion>;
+
+        struct VertexInput {
+            @location(0) position: vec2f,
+            @location(1) texcoords: vec2f,
+            @builtin(instance_index) instance: u32,
+        };
+
+        struct VertexOutput {
+            @builtin(position) position: vec4f,
+            @location(0) texcoords: vec2f,
+        };
+
+        @vertex fn vertex_shader_main(in: VertexInput) -> VertexOutput {
+            let m = motion[in.instance];
+            // Expired and never-spawned slots collapse to a zero-area quad
+            var scale = m.scale * params.aspect;
+            if (is_expired(m)) {
+                scale = vec2f(0.0);
+            }
+            var out: VertexOutput;
+            out.position = uniforms.projection * vec4f(scale * in.position + m.position, params.z, 1.0);
+            out.texcoords = in.texcoords;
+            return out;
+        }
+
+        @fragment fn fragment_shader_main(in: VertexOutput) -> @location(0) vec4f {
+            return textureSample(texData, texSampler, in.texcoords).rgba;
+        }
+    )";
+
+    WGPUBindGroupLayout CreateBindGroupLayout(WGPUDevice device, const char* label, const std::vector<WGPUBindGroupLayoutEntry>& entries) {
+        return wgpuDeviceCreateBindGroupLayout(device, to_ptr(WGPUBindGroupLayoutDescriptor{
+            .label = WGPUStringView(label, WGPU_STRLEN),
+            .entryCount = entries.size(),
+            .entries = entries.data()
+            }));
+    }
+
+    WGPUPipelineLayout CreatePipelineLayout(WGPUDevice device, const char* label, const std::vector<WGPUBindGroupLayout>& groups) {
+        return wgpuDeviceCreatePipelineLayout(device, to_ptr(WGPUPipelineLayoutDescriptor{
+            .label = WGPUStringView(label, WGPU_STRLEN),
+            .bindGroupLayoutCount = groups.size(),
+            .bindGroupLayouts = groups.data()
+            }));
+    }
+}
+
+namespace enDjinn {
+
+    SwarmSystem::~SwarmSystem() {
+        Shutdown();
+    }
+
+	// Startup method. Creates the layouts and requests the integrate and draw pipelines from the registry.
+    bool SwarmSystem::Startup(WGPUDevice device, WGPUQueue queue, PipelineRegistry& registry, WGPUTextureFormat surfaceFormat) {
+        m_device = device;
+        m_queue = queue;
+        m_registry = &registry;
+
+		// 1. Bind group and pipeline layouts
+        m_viewLayout = CreateBindGroupLayout(m_device, "Swarm View Layout", {
+            { .binding = 0, .visibility = WGPUShaderStage_Vertex, .buffer = { .type = WGPUBufferBindingType_Uniform } },
+            { .binding = 1, .visibility = WGPUShaderStage_Fragment, .sampler = { .type = WGPUSamplerBindingType_Filtering } },
+            { .binding = 2, .visibility = WGPUShaderStage_Fragment,
+              .texture = { .sampleType = WGPUTextureSampleType_Float, .viewDimension = WGPUTextureViewDimension_2D } }
+            });
+        m_drawLayout = CreateBindGroupLayout(m_device, "Swarm Draw Layout", {
+            { .binding = 0, .visibility = WGPUShaderStage_Vertex, .buffer = { .type = WGPUBufferBindingType_Uniform } },
+            { .binding = 1, .visibility = WGPUShaderStage_Vertex, .buffer = { .type = WGPUBufferBindingType_ReadOnlyStorage } }
+            });
+        m_computeLayout = CreateBindGroupLayout(m_device, "Swarm Compute Layout", {
+            { .binding = 0, .visibility = WGPUShaderStage_Compute, .buffer = { .type = WGPUBufferBindingType_Uniform } },
+            { .binding = 1, .visibility = WGPUShaderStage_Compute, .buffer = { .type = WGPUBufferBindingType_Storage } }
+            });
+        m_renderPipelineLayout = CreatePipelineLayout(m_device, "Swarm Render Pipeline Layout", { m_viewLayout, m_drawLayout });
+        m_computePipelineLayout = CreatePipelineLayout(m_device, "Swarm Compute Pipeline Layout", { m_computeLayout });
+
+		// 2. Pipelines. Only the quad is a vertex buffer; per-sprite data comes from the storage buffer.
+        ComputePipelineDesc computeDesc;
+        computeDesc.label = "Swarm Integrate Pipeline";
+        computeDesc.shaderSource = std::string(MOTION_WGSL) + COMPUTE_WGSL;
+        computeDesc.entryPoint = "integrate";
+        computeDesc.layout = m_computePipelineLayout;
+        m_computePipeline = m_registry->RequestCompute(computeDesc);
+
+        RenderPipelineDesc renderDesc;
+        renderDesc.label = "Swarm Render Pipeline";
+        renderDesc.shaderSource = std::string(MOTION_WGSL) + RENDER_WGSL;
+        renderDesc.vertexLayout = VertexLayout::Quad;
+        renderDesc.blend = BlendMode::Alpha; // Same over blending as regular sprites
+        renderDesc.format = surfaceFormat;
+        renderDesc.layout = m_renderPipelineLayout;
+        m_renderPipeline = m_registry->Request(renderDesc);
+
+        if (m_computePipeline == INVALID_PIPELINE || m_renderPipeline == INVALID_PIPELINE) {
+            spdlog::error("SwarmSystem: Failed to request pipelines.");
+            return false;
+        }
+        spdlog::info("SwarmSystem started up.");
+        return true;
+    }
+
+	// Shutdown method. Must run after the render thread has stopped, since snapshots reference the swarm buffers,
+	// and before the PipelineRegistry shuts down.
+    void SwarmSystem::Shutdown() {
+        for (std::unique_ptr<Swarm>& swarm : m_swarms) {
+            if (swarm->computeBindGroup) wgpuBindGroupRelease(swarm->computeBindGroup);
+            if (swarm->renderBindGroup) wgpuBindGroupRelease(swarm->renderBindGroup);
+            if (swarm->paramsBuffer) wgpuBufferRelease(swarm->paramsBuffer);
+            if (swarm->motionBuffer) wgpuBufferRelease(swarm->motionBuffer);
+        }
+        m_swarms.clear();
+        m_expiries = {};
+
+        // The pipelines belong to the registry; only the layouts are ours
+        for (WGPUPipelineLayout layout : { m_renderPipelineLayout, m_computePipelineLayout }) {
+            if (layout) wgpuPipelineLayoutRelease(layout);
+        }
+        for (WGPUBindGroupLayout layout : { m_viewLayout, m_drawLayout, m_computeLayout }) {
+            if (layout) wgpuBindGroupLayoutRelease(layout);
+        }
+        m_renderPipelineLayout = m_computePipelineLayout = nullptr;
+        m_viewLayout = m_drawLayout = m_computeLayout = nullptr;
+        m_registry = nullptr;
+        m_computePipeline = m_renderPipeline = INVALID_PIPELINE;
+        m_device = nullptr;
+        m_queue = nullptr;
+    }
+
+	// CreateSwarm method. Allocates the storage buffer once; 'capacity' is the most sprites alive at a time.
+    int SwarmSystem::CreateSwarm(const std::string& textureName, uint32_t capacity, float z) {
+        if (!m_device || capacity == 0) {
+            spdlog::error("SwarmSystem: Cannot create swarm '{}' (not started or zero capacity).", textureName);
+            return -1;
+        }
+
+        auto swarm = std::make_unique<Swarm>();
+        swarm->textureName = textureName;
+        swarm->capacity = capacity;
+        swarm->slotSpawnIds.assign(capacity, 0);
+        swarm->z = z;
+
+		// New buffers are zero-filled, which the shaders treat as empty (zero scale) slots
+        swarm->motionBuffer = wgpuDeviceCreateBuffer(m_device, to_ptr(WGPUBufferDescriptor{
+            .label = WGPUStringView("Swarm Motion Buffer", WGPU_STRLEN),
+            .usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Storage,
+            .size = sizeof(MotionState) * capacity
+            }));
+        swarm->paramsBuffer = wgpuDeviceCreateBuffer(m_device, to_ptr(WGPUBufferDescriptor{
+            .label = WGPUStringView("Swarm Params Buffer", WGPU_STRLEN),
+            .usage = WGPUBufferUsage_CopyDst | WGPUBufferUsage_Uniform,
+            .size = sizeof(SwarmParams)
+            }));
+        if (!swarm->motionBuffer || !swarm->paramsBuffer) {
+            spdlog::error("SwarmSystem: Failed to allocate buffers for swarm '{}'.", textureName);
+            if (swarm->motionBuffer) wgpuBufferRelease(swarm->motionBuffer);
+            if (swarm->paramsBuffer) wgpuBufferRelease(swarm->paramsBuffer);
+            return -1;
+        }
+
+		// The buffers never change, so both bind groups are built once
+        std::array<WGPUBindGroupEntry, 2> entries{};
+        entries[0] = { .binding = 0, .buffer = swarm->paramsBuffer, .size = sizeof(SwarmParams) };
+        entries[1] = { .binding = 1, .buffer = swarm->motionBuffer, .size = sizeof(MotionState) * capacity };
+
+        swarm->computeBindGroup = wgpuDeviceCreateBindGroup(m_device, to_ptr(WGPUBindGroupDescriptor{
+            .layout = m_computeLayout,
+            .entryCount = entries.size(),
+            .entries = entries.data()
+            }));
+        swarm->renderBindGroup = wgpuDeviceCreateBindGroup(m_device, to_ptr(WGPUBindGroupDescriptor{
+            .layout = m_drawLayout,
+            .entryCount = entries.size(),
+            .entries = entries.data()
+            }));
+
+        m_swarms.push_back(std::move(swarm));
+        spdlog::info("SwarmSystem: Created swarm {} ('{}', capacity {}).", m_swarms.size() - 1, textureName, capacity);
+        return static_cast<int>(m_swarms.size() - 1);
+    }
+
+	// Spawn method. Queues the initial state; it reaches the GPU with the next frame snapshot.
+    uint64_t SwarmSystem::Spawn(int swarmIndex, const MotionState& state) {
+        Swarm* swarm = Find(swarmIndex);
+        if (!swarm) return 0;
+
+        MotionState initial = state;
+        initial.age = 0.0f;
+        const uint32_t slot = swarm->nextSlot;
+        swarm->pendingSpawns.push_back({ slot, initial });
+        swarm->nextSlot = (slot + 1) % swarm->capacity;
+        swarm->spawned++;
+
+		// A full ring overwrites the oldest sprite; its pending expiry stops matching the slot and is skipped
+        const uint64_t spawnId = m_nextSpawnId++;
+        if (swarm->slotSpawnIds[slot] == 0) swarm->alive++;
+        swarm->slotSpawnIds[slot] = spawnId;
+        if (state.lifetime > 0.0f) {
+            m_expiries.push({ m_time + state.lifetime, swarmIndex, slot, spawnId });
+        }
+        return spawnId;
+    }
+
+	// Clear method. Empties the swarm on the GPU at the next frame and drops its pending expiry events.
+    void SwarmSystem::Clear(int swarmIndex) {
+        Swarm* swarm = Find(swarmIndex);
+        if (!swarm) return;
+
+        swarm->pendingSpawns.clear();
+        swarm->clearPending = true;
+        std::fill(swarm->slotSpawnIds.begin(), swarm->slotSpawnIds.end(), 0);
+        swarm->nextSlot = 0;
+        swarm->spawned = 0;
+        swarm->alive = 0;
+    }
+
+    void SwarmSystem::SetExpireCallback(int swarmIndex, ExpireCallback callback) {
+        if (Swarm* swarm = Find(swarmIndex)) {
+            swarm->onExpire = std::move(callback);
+        }
+    }
+
+    uint32_t SwarmSystem::GetLiveCount(int swarmIndex) const {
+        const Swarm* swarm = Find(swarmIndex);
+        return swarm ? swarm->alive : 0;
+    }
+
+	// Tick method. Lifetimes are known at spawn time and motion is deterministic, so expiry events
+	// are produced on the CPU without ever reading the storage buffer back.
+    void SwarmSystem::Tick(float dt) {
+        m_time += dt;
+        m_stepSeconds = dt;
+        m_pendingSteps++;
+
+		// 1. Collect everything that expired this tick
+        std::vector<std::pair<int, uint64_t>> expired;
+        while (!m_expiries.empty() && m_expiries.top().time <= m_time) {
+            Expiry expiry = m_expiries.top();
+            m_expiries.pop();
+
+			// Skip sprites that were overwritten by a later spawn or cleared since
+            Swarm* swarm = Find(expiry.swarm);
+            if (!swarm || swarm->slotSpawnIds[expiry.slot] != expiry.spawnId) continue;
+            swarm->slotSpawnIds[expiry.slot] = 0;
+            swarm->alive--;
+            if (swarm->onExpire) expired.push_back({ expiry.swarm, expiry.spawnId });
+        }
+
+		// 2. Group by swarm, keeping expiry order within each, so every swarm gets one call per tick
+        std::stable_sort(expired.begin(), expired.end(), [](const auto& lhs, const auto& rhs) { return lhs.first < rhs.first; });
+
+		// 3. Deliver after the queue is consistent, since callbacks usually spawn replacements
+        std::vector<uint64_t> spawnIds;
+        for (size_t begin = 0; begin < expired.size();) {
+            const int swarmIndex = expired[begin].first;
+            size_t end = begin;
+            spawnIds.clear();
+            for (; end < expired.size() && expired[end].first == swarmIndex; ++end) spawnIds.push_back(expired[end].second);
+            begin = end;
+
+            if (Swarm* swarm = Find(swarmIndex)) {
+                if (swarm->onExpire) swarm->onExpire(spawnIds);
+            }
+        }
+    }
+
+	// Capture method. Moves pending spawns and the accumulated step count into the frame snapshot.
+    void SwarmSystem::Capture(std::vector<SwarmFrame>& frames, ResourceManager& resourceManager) {
+		// Until the integrate pipeline has compiled, spawns and steps keep accumulating so no motion is lost
+        if (!m_registry || !m_registry->GetCompute(m_computePipeline)) return;
+
+        for (size_t i = 0; i < m_swarms.size(); ++i) {
+            Swarm& swarm = *m_swarms[i];
+            if (swarm.spawned == 0 && !swarm.clearPending) continue;
+
+            SwarmFrame& frame = frames.emplace_back();
+            frame.motionBuffer = swarm.motionBuffer;
+            frame.paramsBuffer = swarm.paramsBuffer;
+            frame.computeBindGroup = swarm.computeBindGroup;
+            frame.renderBindGroup = swarm.renderBindGroup;
+            frame.capacity = swarm.capacity;
+            frame.z = swarm.z;
+            frame.clear = std::exchange(swarm.clearPending, false);
+            frame.steps = m_pendingSteps;
+            frame.stepSeconds = m_stepSeconds;
+            frame.drawCount = static_cast<uint32_t>(std::min<uint64_t>(swarm.spawned, swarm.capacity));
+            frame.spawns.swap(swarm.pendingSpawns);
+            swarm.pendingSpawns.clear();
+
+			// The swarm still integrates without its texture; it just is not drawn this frame
+            const Texture* texture = resourceManager.GetTexture(swarm.textureName);
+            if (texture && texture->texture) {
+                wgpuTextureAddRef(texture->texture);
+                frame.texture = texture->texture;
+                if (texture->width < texture->height) {
+                    frame.aspect.x = static_cast<float>(texture->width) / texture->height;
+                }
+                else {
+                    frame.aspect.y = static_cast<float>(texture->height) / texture->width;
+                }
+            }
+        }
+        m_pendingSteps = 0;
+    }
+
+	// Encode method. Only touches the handles copied into the snapshot, never m_swarms, so the main thread may keep
+	// creating swarms meanwhile. Uploads spawns and parameters through the queue, then records one compute pass for all swarms.
+	// Queue writes land before the command buffer that follows them, so the pass sees this frame's spawns.
+    void SwarmSystem::Encode(WGPUCommandEncoder encoder, const std::vector<SwarmFrame>& frames) {
+        if (frames.empty()) return;
+
+        std::vector<MotionState> run;
+        for (const SwarmFrame& frame : frames) {
+			// 1. Clearing zeroes the whole buffer ahead of any spawns captured after it
+            if (frame.clear) {
+                std::vector<uint8_t> zeros(sizeof(MotionState) * frame.capacity, 0);
+                wgpuQueueWriteBuffer(m_queue, frame.motionBuffer, 0, zeros.data(), zeros.size());
+            }
+
+			// 2. Spawns fill consecutive slots, so coalesce them into as few writes as possible
+            for (size_t i = 0; i < frame.spawns.size();) {
+                const uint32_t firstSlot = frame.spawns[i].slot;
+                run.clear();
+                do {
+                    run.push_back(frame.spawns[i].state);
+                    ++i;
+                } while (i < frame.spawns.size() && frame.spawns[i].slot == firstSlot + run.size());
+                wgpuQueueWriteBuffer(m_queue, frame.motionBuffer, sizeof(MotionState) * firstSlot, run.data(), sizeof(MotionState) * run.size());
+            }
+
+			// 3. Parameters for both the integrate pass and the draw
+            SwarmParams params{ frame.stepSeconds, frame.steps, frame.z, frame.drawCount, frame.aspect, glm::vec2(0.0f) };
+            wgpuQueueWriteBuffer(m_queue, frame.paramsBuffer, 0, &params, sizeof(SwarmParams));
+        }
+
+		// 4. Integrate every swarm that has sprites and time to advance
+        WGPUComputePassEncoder computePass = wgpuCommandEncoderBeginComputePass(encoder, nullptr);
+        wgpuComputePassEncoderSetPipeline(computePass, m_registry->GetCompute(m_computePipeline));
+        for (const SwarmFrame& frame : frames) {
+            if (frame.steps == 0 || frame.drawCount == 0) continue;
+            wgpuComputePassEncoderSetBindGroup(computePass, 0, frame.computeBindGroup, 0, nullptr);
+            wgpuComputePassEncoderDispatchWorkgroups(computePass, (frame.drawCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+        }
+        wgpuComputePassEncoderEnd(computePass);
+        wgpuComputePassEncoderRelease(computePass);
+    }
+
+	// Draw method. One instanced draw per swarm, reading positions straight from the storage buffer.
+    void SwarmSystem::Draw(WGPURenderPassEncoder renderPass, const std::vector<SwarmFrame>& frames,
+        WGPUBuffer projectionBuffer, uint64_t projectionSize, WGPUSampler sampler, WGPUBuffer quadBuffer) {
+        WGPURenderPipeline pipeline = m_registry->Get(m_renderPipeline);
+        if (!pipeline) return; // Still compiling
+        bool pipelineSet = false;
+
+        for (const SwarmFrame& frame : frames) {
+            if (!frame.texture || frame.drawCount == 0) continue;
+
+            if (!pipelineSet) {
+                wgpuRenderPassEncoderSetPipeline(renderPass, pipeline);
+                wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, quadBuffer, 0, 4 * 4 * sizeof(float));
+                pipelineSet = true;
+            }
+
+            WGPUTextureView textureView = wgpuTextureCreateView(frame.texture, nullptr);
+            std::array<WGPUBindGroupEntry, 3> entries{};
+            entries[0] = { .binding = 0, .buffer = projectionBuffer, .size = projectionSize };
+            entries[1] = { .binding = 1, .sampler = sampler };
+            entries[2] = { .binding = 2, .textureView = textureView };
+            WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(m_device, to_ptr(WGPUBindGroupDescriptor{
+                .layout = m_viewLayout,
+                .entryCount = entries.size(),
+                .entries = entries.data()
+                }));
+            wgpuTextureViewRelease(textureView);
+
+            wgpuRenderPassEncoderSetBindGroup(renderPass, 0, bindGroup, 0, nullptr);
+            wgpuRenderPassEncoderSetBindGroup(renderPass, 1, frame.renderBindGroup, 0, nullptr);
+            wgpuRenderPassEncoderDraw(renderPass, 4, frame.drawCount, 0, 0);
+            wgpuBindGroupRelease(bindGroup);
+        }
+    }
+
+	// Release method. Drops the snapshot's texture references and empties it for reuse.
+    void SwarmSystem::Release(std::vector<SwarmFrame>& frames) {
+        for (SwarmFrame& frame : frames) {
+            if (frame.texture) wgpuTextureRelease(frame.texture);
+        }
+        frames.clear();
+    }
+
+    SwarmSystem::Swarm* SwarmSystem::Find(int swarm) {
+        if (swarm < 0 || static_cast<size_t>(swarm) >= m_swarms.size()) {
+            spdlog::warn("SwarmSystem: Unknown swarm {}.", swarm);
+            return nullptr;
+        }
+        return m_swarms[swarm].get();
+    }
+
+    const SwarmSystem::Swarm* SwarmSystem::Find(int swarm) const {
+        if (swarm < 0 || static_cast<size_t>(swarm) >= m_swarms.size()) return nullptr;
+        return m_swarms[swarm].get();
+    }
+
+} // namespace enDjinn
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+#include <glm/glm.hpp>
+#include "../managers/PipelineRegistry.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace enDjinn {
+
+    class ResourceManager;
+
+	// Per-sprite motion state as laid out in the GPU storage buffer (matches 'Motion' in the WGSL)
+    struct MotionState {
+        glm::vec2 position = { 0.0f, 0.0f };
+        glm::vec2 velocity = { 0.0f, 0.0f };
+        glm::vec2 acceleration = { 0.0f, 0.0f };
+        glm::vec2 scale = { 1.0f, 1.0f };
+        float age = 0.0f;
+        float lifetime = 0.0f; // 0 lives until cleared
+    };
+    static_assert(sizeof(MotionState) == 40, "MotionState must match the WGSL struct layout");
+
+	// One swarm's share of a frame snapshot: the spawns and simulation steps to apply before drawing
+    struct SwarmFrame {
+        struct SpawnWrite {
+            uint32_t slot;
+            MotionState state;
+        };
+
+        // The swarm's GPU objects live until SwarmSystem::Shutdown, so the snapshot copies the handles unreferenced
+        WGPUBuffer motionBuffer = nullptr;
+        WGPUBuffer paramsBuffer = nullptr;
+        WGPUBindGroup computeBindGroup = nullptr;
+        WGPUBindGroup renderBindGroup = nullptr;
+        uint32_t capacity = 0;
+        float z = 0.0f;
+
+        WGPUTexture texture = nullptr; // Referenced for as long as the snapshot is in flight
+        glm::vec2 aspect = { 1.0f, 1.0f };
+        bool clear = false;
+        uint32_t steps = 0;
+        float stepSeconds = 0.0f;
+        uint32_t drawCount = 0;
+        std::vector<SpawnWrite> spawns;
+    };
+
+	// GPU-driven sprite populations. Each swarm keeps its sprites in a storage buffer that a compute pass
+	// integrates every tick (semi-implicit Euler with constant acceleration); the vertex shader reads the buffer
+	// directly, so moving thousands of projectiles costs neither Lua time nor per-frame uploads.
+	// Lua only spawns sprites and receives batched expiry events.
+    class SwarmSystem {
+    public:
+        using ExpireCallback = std::function<void(const std::vector<uint64_t>& spawnIds)>;
+
+        SwarmSystem() = default;
+        ~SwarmSystem();
+
+        bool Startup(WGPUDevice device, WGPUQueue queue, PipelineRegistry& registry, WGPUTextureFormat surfaceFormat);
+        void Shutdown();
+
+		// Main thread API (also what Lua calls)
+        int CreateSwarm(const std::string& textureName, uint32_t capacity, float z);
+        uint64_t Spawn(int swarm, const MotionState& state); // Returns a spawn id, 0 on failure
+        void Clear(int swarm);
+        void SetExpireCallback(int swarm, ExpireCallback callback);
+        uint32_t GetLiveCount(int swarm) const;
+
+		// Advances the CPU-side clock, records one GPU step and fires expiry events
+        void Tick(float dt);
+
+		// Frame snapshot hooks: Capture on the main thread, the rest on whichever thread renders
+        void Capture(std::vector<SwarmFrame>& frames, ResourceManager& resourceManager);
+        void Encode(WGPUCommandEncoder encoder, const std::vector<SwarmFrame>& frames);
+        void Draw(WGPURenderPassEncoder renderPass, const std::vector<SwarmFrame>& frames,
+            WGPUBuffer projectionBuffer, uint64_t projectionSize, WGPUSampler sampler, WGPUBuffer quadBuffer);
+        static void Release(std::vector<SwarmFrame>& frames);
+
+    private:
+        struct Swarm {
+            std::string textureName;
+            uint32_t capacity = 0;
+            float z = 0.0f;
+            uint32_t nextSlot = 0;   // Spawns fill the ring round-robin, overwriting the oldest
+            uint64_t spawned = 0;
+            uint32_t alive = 0;      // Occupied slots, for GetLiveCount
+            bool clearPending = false;
+            std::vector<uint64_t> slotSpawnIds; // Per slot, the spawn living there (0: empty). Expiries of sprites that
+                                                // were overwritten or cleared no longer match and are dropped.
+            std::vector<SwarmFrame::SpawnWrite> pendingSpawns;
+            ExpireCallback onExpire;
+
+            WGPUBuffer motionBuffer = nullptr;
+            WGPUBuffer paramsBuffer = nullptr;
+            WGPUBindGroup computeBindGroup = nullptr;
+            WGPUBindGroup renderBindGroup = nullptr;
+        };
+
+        struct Expiry {
+            double time;
+            int swarm;
+            uint32_t slot;
+            uint64_t spawnId;
+            bool operator>(const Expiry& other) const { return time > other.time; }
+        };
+
+        Swarm* Find(int swarm);
+        const Swarm* Find(int swarm) const;
+
+        WGPUDevice m_device = nullptr;
+        WGPUQueue m_queue = nullptr;
+        PipelineRegistry* m_registry = nullptr;
+        PipelineHandle m_computePipeline = INVALID_PIPELINE; // Both compile asynchronously
+        PipelineHandle m_renderPipeline = INVALID_PIPELINE;
+
+        // Explicit layouts, so bind groups can be created before the pipelines have finished compiling
+        WGPUBindGroupLayout m_viewLayout = nullptr;    // Render group 0: projection, sampler, texture
+        WGPUBindGroupLayout m_drawLayout = nullptr;    // Render group 1: params, read-only motion
+        WGPUBindGroupLayout m_computeLayout = nullptr; // Compute group 0: params, read-write motion
+        WGPUPipelineLayout m_renderPipelineLayout = nullptr;
+        WGPUPipelineLayout m_computePipelineLayout = nullptr;
+
+        std::vector<std::unique_ptr<Swarm>> m_swarms;
+        uint32_t m_pendingSteps = 0;
+        float m_stepSeconds = 1.0f / 60.0f;
+        double m_time = 0.0;
+        uint64_t m_nextSpawnId = 1;
+        std::priority_queue<Expiry, std::vector<Expiry>, std::greater<Expiry>> m_expiries;
+    };
+
+} // namespace enDjinn
@@ -0,0 +1,591 @@
+#include "TextSystem.h"
+#include "../assets/ResourceManager.h"
+#include "../utils/Stats.h"
+#include "spdlog/spdlog.h"
+#define STB_TRUETYPE_IMPLEMENTATION
+#include "stb_truetype.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    template< typename T > constexpr const T* to_ptr(const T& val) { return &val; }
+
+    constexpr const char* TEXT_WGSL = R"(
+        struct Uniforms {
+            projection: mat4x4f,
+        };
+
+        struct Glyph {
+            min: vec2f,
+            max: vec2f,
+            uvRect: vec4f,
+            color: vec4f,
+            z: f32,
+        };
+
+        @group(0) @binding(0) var<uniform> uniforms: Uniforms;
+        @group(0) @binding(1) var texSampler: sampler;
+        @group(0) @binding(2) var texData: texture_2d<f32>;
+        @group(0) @binding(3) var<storage, read> glyphs: array<Glyph>;
+
+        struct VertexInput {
+            @location(0) position: vec2f,
+            @location(1) texcoords: vec2f,
+            @builtin(instance_index) instance: u32,
+        };
+
+        struct VertexOutput {
+            @builtin(position) position: vec4f,
+            @location(0) texcoords: vec2f,
+            @location(1) color: vec4f,
+        };
+
+        @vertex fn vertex_shader_main(in: VertexInput) -> VertexOutput {
+            let glyph = glyphs[in.instance];
+            // The shared quad spans -1..1; map it onto the glyph's corners
+            let corner = in.position * 0.5 + vec2f(0.5);
+            var out: VertexOutput;
+            out.position = uniforms.projection * vec4f(mix(glyph.min, glyph.max, corner), glyph.z, 1.0);
+            out.texcoords = glyph.uvRect.xy + in.texcoords * glyph.uvRect.zw;
+            out.color = glyph.color;
+            return out;
+        }
+
+        // Plain atlases store coverage in alpha
+        @fragment fn fragment_bitmap(in: VertexOutput) -> @location(0) vec4f {
+            let coverage = textureSample(texData, texSampler, in.texcoords).a;
+            return vec4f(in.color.rgb, in.color.a * coverage);
+        }
+
+        // Distance field atlases store the distance to the outline in alpha, 0.5 on the edge.
+        // Antialiasing over one screen pixel keeps edges crisp at any scale.
+        @fragment fn fragment_sdf(in: VertexOutput) -> @location(0) vec4f {
+            let distance = textureSample(texData, texSampler, in.texcoords).a;
+            let width = max(fwidth(distance), 0.0001);
+            let coverage = smoothstep(0.5 - width, 0.5 + width, distance);
+            return vec4f(in.color.rgb, in.color.a * coverage);
+        }
+    )";
+
+    // Distance field baking: texels of padding around each glyph, and the distance encoded on the edge
+    constexpr int SDF_PADDING = 4;
+    constexpr unsigned char SDF_ON_EDGE = 128;
+
+	// Expands single-channel coverage or distance to white RGBA, since atlases go through the regular texture path
+    std::vector<uint8_t> ToRgba(const std::vector<uint8_t>& alpha) {
+        std::vector<uint8_t> rgba(alpha.size() * 4, 255);
+        for (size_t i = 0; i < alpha.size(); ++i) {
+            rgba[i * 4 + 3] = alpha[i];
+        }
+        return rgba;
+    }
+}
+
+namespace enDjinn {
+
+    TextSystem::~TextSystem() {
+        Shutdown();
+    }
+
+	// Startup method. Creates the layout and requests the two pipeline variants from the registry.
+    bool TextSystem::Startup(WGPUDevice device, PipelineRegistry& registry, WGPUTextureFormat surfaceFormat) {
+        m_device = device;
+        m_registry = &registry;
+
+		// 1. Bind group and pipeline layouts
+        std::array<WGPUBindGroupLayoutEntry, 4> entries{};
+        entries[0] = { .binding = 0, .visibility = WGPUShaderStage_Vertex, .buffer = { .type = WGPUBufferBindingType_Uniform } };
+        entries[1] = { .binding = 1, .visibility = WGPUShaderStage_Fragment, .sampler = { .type = WGPUSamplerBindingType_Filtering } };
+        entries[2] = { .binding = 2, .visibility = WGPUShaderStage_Fragment,
+            .texture = { .sampleType = WGPUTextureSampleType_Float, .viewDimension = WGPUTextureViewDimension_2D } };
+        entries[3] = { .binding = 3, .visibility = WGPUShaderStage_Vertex, .buffer = { .type = WGPUBufferBindingType_ReadOnlyStorage } };
+        m_layout = wgpuDeviceCreateBindGroupLayout(m_device, to_ptr(WGPUBindGroupLayoutDescriptor{
+            .label = WGPUStringView("Text Layout", WGPU_STRLEN),
+            .entryCount = entries.size(),
+            .entries = entries.data()
+            }));
+        m_pipelineLayout = wgpuDeviceCreatePipelineLayout(m_device, to_ptr(WGPUPipelineLayoutDescriptor{
+            .label = WGPUStringView("Text Pipeline Layout", WGPU_STRLEN),
+            .bindGroupLayoutCount = 1,
+            .bindGroupLayouts = &m_layout
+            }));
+
+		// 2. Pipelines. Same shader module, one fragment entry point per atlas kind.
+        RenderPipelineDesc desc;
+        desc.label = "Text Bitmap Pipeline";
+        desc.shaderSource = TEXT_WGSL;
+        desc.fragmentEntry = "fragment_bitmap";
+        desc.vertexLayout = VertexLayout::Quad;
+        desc.blend = BlendMode::Alpha;
+        desc.format = surfaceFormat;
+        desc.layout = m_pipelineLayout;
+        m_bitmapPipeline = m_registry->Request(desc);
+
+        desc.label = "Text SDF Pipeline";
+        desc.fragmentEntry = "fragment_sdf";
+        m_sdfPipeline = m_registry->Request(desc);
+
+        if (m_bitmapPipeline == INVALID_PIPELINE || m_sdfPipeline == INVALID_PIPELINE) {
+            spdlog::error("TextSystem: Failed to request pipelines.");
+            return false;
+        }
+        spdlog::info("TextSystem started up.");
+        return true;
+    }
+
+	// Shutdown method. Must run after the render thread has stopped and before the PipelineRegistry shuts down.
+    void TextSystem::Shutdown() {
+        for (std::unique_ptr<Font>& font : m_fonts) {
+            if (font->glyphBuffer) wgpuBufferRelease(font->glyphBuffer);
+        }
+        m_fonts.clear();
+        m_fontsByName.clear();
+        m_texts.clear();
+
+        if (m_pipelineLayout) wgpuPipelineLayoutRelease(m_pipelineLayout);
+        if (m_layout) wgpuBindGroupLayoutRelease(m_layout);
+        m_pipelineLayout = nullptr;
+        m_layout = nullptr;
+        m_registry = nullptr;
+        m_bitmapPipeline = m_sdfPipeline = INVALID_PIPELINE;
+        m_device = nullptr;
+    }
+
+	// LoadFont method. Bakes printable ASCII from a TrueType file into an atlas.
+    int TextSystem::LoadFont(const std::string& name, const std::string& partialPath, float pixelHeight, bool sdf, ResourceManager& resourceManager) {
+        if (FindFont(name) >= 0) {
+            spdlog::warn("TextSystem: Font '{}' already loaded.", name);
+            return FindFont(name);
+        }
+
+		// 1. Read and parse the font file
+        std::ifstream file(resourceManager.ResolvePath(partialPath), std::ios::binary);
+        std::vector<unsigned char> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        stbtt_fontinfo info;
+        if (data.empty() || !stbtt_InitFont(&info, data.data(), stbtt_GetFontOffsetForIndex(data.data(), 0))) {
+            spdlog::error("TextSystem: Failed to load font '{}' from '{}'.", name, partialPath);
+            return -1;
+        }
+
+        auto font = std::make_unique<Font>();
+        font->name = name;
+        font->textureName = name;
+        font->sdf = sdf;
+
+        const float scale = stbtt_ScaleForPixelHeight(&info, pixelHeight);
+        int ascent = 0, descent = 0, lineGap = 0;
+        stbtt_GetFontVMetrics(&info, &ascent, &descent, &lineGap);
+        font->ascent = ascent * scale;
+        font->lineHeight = (ascent - descent + lineGap) * scale;
+
+		// 2. Bake the glyphs into a single-channel atlas
+        uint32_t atlasWidth = 0, atlasHeight = 0;
+        std::vector<uint8_t> atlas;
+        if (!sdf) {
+            // The packer reports failure when the glyphs don't fit, so grow the atlas until they do
+            std::array<stbtt_packedchar, CHAR_COUNT> packed{};
+            for (uint32_t size = 256; size <= 4096 && atlas.empty(); size *= 2) {
+                std::vector<uint8_t> pixels(size * size, 0);
+                stbtt_pack_context context;
+                if (!stbtt_PackBegin(&context, pixels.data(), size, size, 0, 1, nullptr)) break;
+                const int fitted = stbtt_PackFontRange(&context, data.data(), 0, pixelHeight, FIRST_CHAR, CHAR_COUNT, packed.data());
+                stbtt_PackEnd(&context);
+                if (fitted) {
+                    atlas = std::move(pixels);
+                    atlasWidth = atlasHeight = size;
+                }
+            }
+            if (atlas.empty()) {
+                spdlog::error("TextSystem: Font '{}' does not fit an atlas at {} px.", name, pixelHeight);
+                return -1;
+            }
+            for (uint32_t i = 0; i < CHAR_COUNT; ++i) {
+                const stbtt_packedchar& c = packed[i];
+                Glyph& glyph = font->glyphs[i];
+                glyph.uvRect = glm::vec4(c.x0 / static_cast<float>(atlasWidth), c.y0 / static_cast<float>(atlasHeight),
+                    (c.x1 - c.x0) / static_cast<float>(atlasWidth), (c.y1 - c.y0) / static_cast<float>(atlasHeight));
+                glyph.offset = glm::vec2(c.xoff, c.yoff);
+                glyph.size = glm::vec2(c.xoff2 - c.xoff, c.yoff2 - c.yoff);
+                glyph.advance = c.xadvance;
+            }
+        }
+        else {
+            // Distance fields are generated per glyph, then placed on shelves left to right
+            struct Bitmap {
+                unsigned char* pixels = nullptr;
+                int width = 0, height = 0, x = 0, y = 0;
+            };
+            std::array<Bitmap, CHAR_COUNT> bitmaps{};
+            uint64_t area = 0;
+            for (uint32_t i = 0; i < CHAR_COUNT; ++i) {
+                Bitmap& bitmap = bitmaps[i];
+                int xoff = 0, yoff = 0;
+                bitmap.pixels = stbtt_GetCodepointSDF(&info, scale, FIRST_CHAR + i, SDF_PADDING, SDF_ON_EDGE,
+                    static_cast<float>(SDF_ON_EDGE) / SDF_PADDING, &bitmap.width, &bitmap.height, &xoff, &yoff);
+                int advance = 0, bearing = 0;
+                stbtt_GetCodepointHMetrics(&info, FIRST_CHAR + i, &advance, &bearing);
+                font->glyphs[i].offset = glm::vec2(xoff, yoff);
+                font->glyphs[i].size = glm::vec2(bitmap.width, bitmap.height);
+                font->glyphs[i].advance = advance * scale;
+                area += static_cast<uint64_t>(bitmap.width + 1) * (bitmap.height + 1);
+            }
+
+            atlasWidth = 128;
+            while (static_cast<uint64_t>(atlasWidth) * atlasWidth < area * 2) atlasWidth *= 2;
+            int x = 0, y = 0, shelfHeight = 0;
+            for (Bitmap& bitmap : bitmaps) {
+                if (!bitmap.pixels) continue; // Blank glyphs such as the space only advance
+                if (x + bitmap.width > static_cast<int>(atlasWidth)) {
+                    x = 0;
+                    y += shelfHeight + 1;
+                    shelfHeight = 0;
+                }
+                bitmap.x = x;
+                bitmap.y = y;
+                x += bitmap.width + 1;
+                shelfHeight = std::max(shelfHeight, bitmap.height);
+            }
+            atlasHeight = std::max(4u, static_cast<uint32_t>(y + shelfHeight + 3) & ~3u);
+
+            atlas.assign(static_cast<size_t>(atlasWidth) * atlasHeight, 0);
+            for (uint32_t i = 0; i < CHAR_COUNT; ++i) {
+                Bitmap& bitmap = bitmaps[i];
+                if (!bitmap.pixels) continue;
+                for (int row = 0; row < bitmap.height; ++row) {
+                    std::copy_n(bitmap.pixels + row * bitmap.width, bitmap.width, atlas.begin() + (bitmap.y + row) * atlasWidth + bitmap.x);
+                }
+                font->glyphs[i].uvRect = glm::vec4(bitmap.x / static_cast<float>(atlasWidth), bitmap.y / static_cast<float>(atlasHeight),
+                    bitmap.width / static_cast<float>(atlasWidth), bitmap.height / static_cast<float>(atlasHeight));
+                stbtt_FreeSDF(bitmap.pixels, nullptr);
+            }
+        }
+
+		// 3. Kerning pairs, so layout never touches the font file again
+        font->kerning.resize(CHAR_COUNT * CHAR_COUNT);
+        for (uint32_t a = 0; a < CHAR_COUNT; ++a) {
+            for (uint32_t b = 0; b < CHAR_COUNT; ++b) {
+                font->kerning[a * CHAR_COUNT + b] = stbtt_GetCodepointKernAdvance(&info, FIRST_CHAR + a, FIRST_CHAR + b) * scale;
+            }
+        }
+
+		// 4. Upload the atlas. Headless runs keep the metrics and skip the texture.
+        const std::vector<uint8_t> rgba = ToRgba(atlas);
+        resourceManager.CreateTextureFromPixels(font->textureName, atlasWidth, atlasHeight, rgba.data());
+
+        spdlog::info("TextSystem: Loaded font '{}' ({} px, {}, {}x{} atlas).", name, pixelHeight, sdf ? "SDF" : "bitmap", atlasWidth, atlasHeight);
+        return AddFont(std::move(font));
+    }
+
+	// CreateGridFont method. For monospace atlases baked offline: cells left to right, top to bottom from firstChar.
+    int TextSystem::CreateGridFont(const std::string& name, const std::string& textureName, uint32_t columns, uint32_t rows,
+        uint32_t firstChar, ResourceManager& resourceManager) {
+        const Texture* texture = resourceManager.GetTexture(textureName);
+        if (!texture || columns == 0 || rows == 0) {
+            spdlog::error("TextSystem: Cannot create grid font '{}' from texture '{}'.", name, textureName);
+            return -1;
+        }
+        if (FindFont(name) >= 0) {
+            spdlog::warn("TextSystem: Font '{}' already loaded.", name);
+            return FindFont(name);
+        }
+
+        auto font = std::make_unique<Font>();
+        font->name = name;
+        font->textureName = textureName;
+
+        const glm::vec2 cell(static_cast<float>(texture->width) / columns, static_cast<float>(texture->height) / rows);
+        font->lineHeight = cell.y;
+        font->ascent = cell.y; // The baseline is the bottom of the cell
+        for (uint32_t i = 0; i < CHAR_COUNT; ++i) {
+            Glyph& glyph = font->glyphs[i];
+            glyph.advance = cell.x;
+            const uint32_t c = FIRST_CHAR + i;
+            if (c < firstChar || c - firstChar >= columns * rows) continue;
+
+            const uint32_t index = c - firstChar;
+            glyph.uvRect = glm::vec4(static_cast<float>(index % columns) / columns, static_cast<float>(index / columns) / rows,
+                1.0f / columns, 1.0f / rows);
+            glyph.offset = glm::vec2(0.0f, -cell.y);
+            glyph.size = cell;
+        }
+        return AddFont(std::move(font));
+    }
+
+    int TextSystem::FindFont(const std::string& name) const {
+        auto it = m_fontsByName.find(name);
+        return it != m_fontsByName.end() ? it->second : -1;
+    }
+
+	// CreateText method
+    int TextSystem::CreateText(int font, const std::string& string, const glm::vec2& position, float size) {
+        if (font < 0 || static_cast<size_t>(font) >= m_fonts.size()) {
+            spdlog::warn("TextSystem: Unknown font {}.", font);
+            return -1;
+        }
+
+        auto text = std::make_unique<Text>();
+        text->font = font;
+        text->string = string;
+        text->position = position;
+        text->size = size;
+        m_fonts[font]->dirty = true;
+
+        m_texts.push_back(std::move(text));
+        return static_cast<int>(m_texts.size()) - 1;
+    }
+
+    void TextSystem::Destroy(int text) {
+        if (Text* t = Find(text)) {
+            m_fonts[t->font]->dirty = true;
+            m_texts[text].reset();
+        }
+    }
+
+    void TextSystem::SetString(int text, const std::string& string) {
+        Text* t = Find(text);
+        if (!t || t->string == string) return;
+        t->string = string;
+        MarkDirty(*t, true);
+    }
+
+    void TextSystem::SetPosition(int text, const glm::vec2& position) {
+        Text* t = Find(text);
+        if (!t || t->position == position) return;
+        t->position = position;
+        MarkDirty(*t, false);
+    }
+
+    void TextSystem::SetSize(int text, float size) {
+        Text* t = Find(text);
+        if (!t || t->size == size) return;
+        t->size = size;
+        MarkDirty(*t, false);
+    }
+
+    void TextSystem::SetColor(int text, const glm::vec4& color) {
+        Text* t = Find(text);
+        if (!t || t->color == color) return;
+        t->color = color;
+        MarkDirty(*t, false);
+    }
+
+    void TextSystem::SetZ(int text, float z) {
+        Text* t = Find(text);
+        if (!t || t->z == z) return;
+        t->z = z;
+        MarkDirty(*t, false);
+    }
+
+    void TextSystem::SetAlign(int text, TextAlign align) {
+        Text* t = Find(text);
+        if (!t || t->align == align) return;
+        t->align = align;
+        MarkDirty(*t, true);
+    }
+
+    void TextSystem::SetVisible(int text, bool visible) {
+        Text* t = Find(text);
+        if (!t || t->visible == visible) return;
+        t->visible = visible;
+        MarkDirty(*t, false);
+    }
+
+    glm::vec2 TextSystem::Measure(int text) {
+        Text* t = Find(text);
+        if (!t) return glm::vec2(0.0f);
+        if (t->layoutDirty) Layout(*t);
+        return t->extent * (t->size / m_fonts[t->font]->lineHeight);
+    }
+
+	// Capture method. Rebuilds the glyph buffers of fonts whose texts changed, then references every non-empty one.
+    void TextSystem::Capture(std::vector<TextFrame>& frames, ResourceManager& resourceManager) {
+        if (!m_device) return;
+
+        uint32_t glyphs = 0;
+        for (std::unique_ptr<Font>& font : m_fonts) {
+            if (font->dirty) RebuildGlyphBuffer(*font);
+            if (!font->glyphBuffer || font->glyphCount == 0) continue;
+
+            const Texture* texture = resourceManager.GetTexture(font->textureName);
+            if (!texture || !texture->texture) continue;
+
+            wgpuBufferAddRef(font->glyphBuffer);
+            wgpuTextureAddRef(texture->texture);
+            TextFrame& frame = frames.emplace_back();
+            frame.glyphBuffer = font->glyphBuffer;
+            frame.texture = texture->texture;
+            frame.glyphCount = font->glyphCount;
+            frame.sdf = font->sdf;
+            glyphs += font->glyphCount;
+        }
+        Stats::Get().Set("text.glyphs", glyphs);
+    }
+
+	// Draw method. One bind group and one instanced draw per font.
+    void TextSystem::Draw(WGPURenderPassEncoder renderPass, const std::vector<TextFrame>& frames,
+        WGPUBuffer projectionBuffer, uint64_t projectionSize, WGPUSampler sampler, WGPUBuffer quadBuffer) {
+        WGPURenderPipeline currentPipeline = nullptr;
+
+        for (const TextFrame& frame : frames) {
+            WGPURenderPipeline pipeline = m_registry->Get(frame.sdf ? m_sdfPipeline : m_bitmapPipeline);
+            if (!pipeline) continue; // Still compiling
+            if (pipeline != currentPipeline) {
+                currentPipeline = pipeline;
+                wgpuRenderPassEncoderSetPipeline(renderPass, pipeline);
+                wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, quadBuffer, 0, 4 * 4 * sizeof(float));
+            }
+
+            WGPUTextureView textureView = wgpuTextureCreateView(frame.texture, nullptr);
+            std::array<WGPUBindGroupEntry, 4> entries{};
+            entries[0] = { .binding = 0, .buffer = projectionBuffer, .size = projectionSize };
+            entries[1] = { .binding = 1, .sampler = sampler };
+            entries[2] = { .binding = 2, .textureView = textureView };
+            entries[3] = { .binding = 3, .buffer = frame.glyphBuffer, .size = sizeof(GlyphInstance) * frame.glyphCount };
+            WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(m_device, to_ptr(WGPUBindGroupDescriptor{
+                .layout = m_layout,
+                .entryCount = entries.size(),
+                .entries = entries.data()
+                }));
+            wgpuTextureViewRelease(textureView);
+
+            wgpuRenderPassEncoderSetBindGroup(renderPass, 0, bindGroup, 0, nullptr);
+            wgpuRenderPassEncoderDraw(renderPass, 4, frame.glyphCount, 0, 0);
+            wgpuBindGroupRelease(bindGroup);
+        }
+    }
+
+	// Release method. Drops the snapshot's buffer and texture references.
+    void TextSystem::Release(std::vector<TextFrame>& frames) {
+        for (TextFrame& frame : frames) {
+            if (frame.glyphBuffer) wgpuBufferRelease(frame.glyphBuffer);
+            if (frame.texture) wgpuTextureRelease(frame.texture);
+        }
+        frames.clear();
+    }
+
+    int TextSystem::AddFont(std::unique_ptr<Font> font) {
+        const int index = static_cast<int>(m_fonts.size());
+        m_fontsByName[font->name] = index;
+        m_fonts.push_back(std::move(font));
+        return index;
+    }
+
+    TextSystem::Text* TextSystem::Find(int text) {
+        if (text < 0 || static_cast<size_t>(text) >= m_texts.size() || !m_texts[text]) {
+            spdlog::warn("TextSystem: Unknown text {}.", text);
+            return nullptr;
+        }
+        return m_texts[text].get();
+    }
+
+    const TextSystem::Text* TextSystem::Find(int text) const {
+        if (text < 0 || static_cast<size_t>(text) >= m_texts.size()) return nullptr;
+        return m_texts[text].get();
+    }
+
+    void TextSystem::MarkDirty(Text& text, bool relayout) {
+        if (relayout) text.layoutDirty = true;
+        m_fonts[text.font]->dirty = true;
+    }
+
+	// Layout method. Places glyphs in font pixels (y down from the top of the first line), one line at a time.
+    void TextSystem::Layout(Text& text) const {
+        const Font& font = *m_fonts[text.font];
+        text.layout.clear();
+        text.extent = glm::vec2(0.0f);
+
+        float penX = 0.0f;
+        float baseline = font.ascent;
+        size_t lineStart = 0;
+        int previous = -1;
+
+		// Shifts the finished line by its alignment
+        auto endLine = [&]() {
+            text.extent.x = std::max(text.extent.x, penX);
+            const float shift = text.align == TextAlign::Center ? -0.5f * penX : text.align == TextAlign::Right ? -penX : 0.0f;
+            for (size_t i = lineStart; i < text.layout.size(); ++i) {
+                text.layout[i].min.x += shift;
+                text.layout[i].max.x += shift;
+            }
+            lineStart = text.layout.size();
+        };
+
+        for (const char ch : text.string) {
+            if (ch == '\n') {
+                endLine();
+                penX = 0.0f;
+                baseline += font.lineHeight;
+                previous = -1;
+                continue;
+            }
+
+            // Characters outside printable ASCII draw as '?'
+            const uint32_t c = static_cast<unsigned char>(ch);
+            const int index = (c >= FIRST_CHAR && c < FIRST_CHAR + CHAR_COUNT) ? static_cast<int>(c - FIRST_CHAR) : '?' - FIRST_CHAR;
+            if (previous >= 0 && !font.kerning.empty()) penX += font.kerning[previous * CHAR_COUNT + index];
+
+            const Glyph& glyph = font.glyphs[index];
+            if (glyph.size.x > 0.0f && glyph.size.y > 0.0f) {
+                GlyphInstance& instance = text.layout.emplace_back();
+                instance.min = glm::vec2(penX + glyph.offset.x, baseline + glyph.offset.y);
+                instance.max = instance.min + glyph.size;
+                instance.uvRect = glyph.uvRect;
+            }
+            penX += glyph.advance;
+            previous = index;
+        }
+        endLine();
+        text.extent.y = baseline - font.ascent + font.lineHeight;
+        text.layoutDirty = false;
+    }
+
+	// RebuildGlyphBuffer method. Writes every visible text of the font into a fresh buffer; snapshots still in
+	// flight keep the previous one alive through their references.
+    void TextSystem::RebuildGlyphBuffer(Font& font) {
+        const int fontIndex = FindFont(font.name);
+        m_scratch.clear();
+        for (std::unique_ptr<Text>& textPtr : m_texts) {
+            if (!textPtr || textPtr->font != fontIndex || !textPtr->visible) continue;
+            Text& text = *textPtr;
+            if (text.layoutDirty) Layout(text);
+
+            // Font pixels to world units; pixel y grows down, world y grows up
+            const float scale = text.size / font.lineHeight;
+            for (const GlyphInstance& local : text.layout) {
+                GlyphInstance& glyph = m_scratch.emplace_back();
+                glyph.min = glm::vec2(text.position.x + local.min.x * scale, text.position.y - local.max.y * scale);
+                glyph.max = glm::vec2(text.position.x + local.max.x * scale, text.position.y - local.min.y * scale);
+                glyph.uvRect = local.uvRect;
+                glyph.color = text.color;
+                glyph.z = text.z;
+            }
+        }
+
+        if (font.glyphBuffer) wgpuBufferRelease(font.glyphBuffer);
+        font.glyphBuffer = nullptr;
+        font.glyphCount = static_cast<uint32_t>(m_scratch.size());
+        font.dirty = false;
+        if (m_scratch.empty()) return;
+
+        const uint64_t bufferSize = sizeof(GlyphInstance) * m_scratch.size();
+        font.glyphBuffer = wgpuDeviceCreateBuffer(m_device, to_ptr(WGPUBufferDescriptor{
+            .label = WGPUStringView("Text Glyph Buffer", WGPU_STRLEN),
+            .usage = WGPUBufferUsage_Storage,
+            .size = bufferSize,
+            .mappedAtCreation = true
+            }));
+        if (!font.glyphBuffer) {
+            font.glyphCount = 0;
+            return;
+        }
+        std::copy(m_scratch.begin(), m_scratch.end(), static_cast<GlyphInstance*>(wgpuBufferGetMappedRange(font.glyphBuffer, 0, bufferSize)));
+        wgpuBufferUnmap(font.glyphBuffer);
+
+        Stats& stats = Stats::Get();
+        stats.Add("text.buffer_uploads");
+        stats.Add("gpu.upload_bytes", static_cast<double>(bufferSize));
+    }
+
+} // namespace enDjinn
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+#include <glm/glm.hpp>
+#include "../managers/PipelineRegistry.h"
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace enDjinn {
+
+    class ResourceManager;
+
+	// One glyph quad as laid out in the GPU storage buffer (matches 'Glyph' in the WGSL)
+    struct GlyphInstance {
+        glm::vec2 min = { 0.0f, 0.0f }; // World-space corners: min is bottom-left, max is top-right
+        glm::vec2 max = { 0.0f, 0.0f };
+        glm::vec4 uvRect = { 0.0f, 0.0f, 0.0f, 0.0f };
+        glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+        float z = 0.0f;
+        float padding[3] = {};
+    };
+    static_assert(sizeof(GlyphInstance) == 64, "GlyphInstance must match the WGSL struct layout");
+
+    enum class TextAlign : uint8_t {
+        Left,
+        Center,
+        Right
+    };
+
+	// One font's share of a frame snapshot: every visible glyph of that font, drawn with one call
+    struct TextFrame {
+        WGPUBuffer glyphBuffer = nullptr; // Referenced for as long as the snapshot is in flight
+        WGPUTexture texture = nullptr;    // Referenced for as long as the snapshot is in flight
+        uint32_t glyphCount = 0;
+        bool sdf = false;
+    };
+
+	// Batched text. A font is an atlas texture plus glyph metrics, either baked from a TrueType file at load time
+	// (as plain coverage or as a signed distance field, which stays sharp at any size) or cut from a grid atlas
+	// baked offline. Strings are laid out once when they change; all glyphs of one font live in one storage buffer
+	// that is rebuilt only when one of its texts changes, and drawn with one instanced call on the shared quad.
+	//
+	// A text's position is the top of its first line, at the left edge, center or right edge depending on its
+	// alignment. Its size is the line height in world units. Text draws on top of everything else.
+    class TextSystem {
+    public:
+        static constexpr uint32_t FIRST_CHAR = 32;  // Fonts cover printable ASCII
+        static constexpr uint32_t CHAR_COUNT = 95;
+
+        TextSystem() = default;
+        ~TextSystem();
+
+        bool Startup(WGPUDevice device, PipelineRegistry& registry, WGPUTextureFormat surfaceFormat);
+        void Shutdown();
+
+		// Fonts. Both return a font id, or -1 on failure. The atlas is registered with the ResourceManager as the
+		// font's name; without a GPU (headless runs) the metrics still load, so layout works but nothing draws.
+        int LoadFont(const std::string& name, const std::string& partialPath, float pixelHeight, bool sdf, ResourceManager& resourceManager);
+        int CreateGridFont(const std::string& name, const std::string& textureName, uint32_t columns, uint32_t rows,
+            uint32_t firstChar, ResourceManager& resourceManager);
+        int FindFont(const std::string& name) const;
+
+		// Texts. Setters that do not change anything leave the cached layout and the font's glyph buffer untouched.
+        int CreateText(int font, const std::string& string, const glm::vec2& position, float size);
+        void Destroy(int text);
+        void SetString(int text, const std::string& string);
+        void SetPosition(int text, const glm::vec2& position);
+        void SetSize(int text, float size);
+        void SetColor(int text, const glm::vec4& color);
+        void SetZ(int text, float z);
+        void SetAlign(int text, TextAlign align);
+        void SetVisible(int text, bool visible);
+        glm::vec2 Measure(int text); // Width and height in world units
+
+		// Frame snapshot hooks: Capture on the main thread, Draw on whichever thread renders
+        void Capture(std::vector<TextFrame>& frames, ResourceManager& resourceManager);
+        void Draw(WGPURenderPassEncoder renderPass, const std::vector<TextFrame>& frames,
+            WGPUBuffer projectionBuffer, uint64_t projectionSize, WGPUSampler sampler, WGPUBuffer quadBuffer);
+        static void Release(std::vector<TextFrame>& frames);
+
+    private:
+		// Glyph metrics in atlas pixels, relative to the pen position on the baseline (y grows down)
+        struct Glyph {
+            glm::vec4 uvRect = { 0.0f, 0.0f, 0.0f, 0.0f };
+            glm::vec2 offset = { 0.0f, 0.0f }; // Top-left corner of the quad
+            glm::vec2 size = { 0.0f, 0.0f };
+            float advance = 0.0f;
+        };
+
+        struct Font {
+            std::string name;
+            std::string textureName;
+            bool sdf = false;
+            float lineHeight = 1.0f; // Pixels from one baseline to the next
+            float ascent = 0.0f;     // Pixels from the top of a line to its baseline
+            std::array<Glyph, CHAR_COUNT> glyphs{};
+            std::vector<float> kerning; // CHAR_COUNT x CHAR_COUNT pixel adjustments, empty for grid fonts
+
+            bool dirty = false;      // One of its texts changed since the glyph buffer was built
+            WGPUBuffer glyphBuffer = nullptr;
+            uint32_t glyphCount = 0;
+        };
+
+        struct Text {
+            int font = -1;
+            std::string string;
+            glm::vec2 position = { 0.0f, 0.0f };
+            float size = 1.0f;
+            glm::vec4 color = { 1.0f, 1.0f, 1.0f, 1.0f };
+            float z = 0.0f;
+            TextAlign align = TextAlign::Left;
+            bool visible = true;
+
+            // Cached layout in font pixels, relative to the text's position; rebuilt when the string or alignment changes
+            bool layoutDirty = true;
+            std::vector<GlyphInstance> layout;
+            glm::vec2 extent = { 0.0f, 0.0f };
+        };
+
+        int AddFont(std::unique_ptr<Font> font);
+        Text* Find(int text);
+        const Text* Find(int text) const;
+        void MarkDirty(Text& text, bool relayout);
+        void Layout(Text& text) const;
+        void RebuildGlyphBuffer(Font& font);
+
+        WGPUDevice m_device = nullptr;
+        PipelineRegistry* m_registry = nullptr;
+        PipelineHandle m_bitmapPipeline = INVALID_PIPELINE; // Both compile asynchronously
+        PipelineHandle m_sdfPipeline = INVALID_PIPELINE;
+        WGPUBindGroupLayout m_layout = nullptr; // Projection, sampler, atlas, glyphs
+        WGPUPipelineLayout m_pipelineLayout = nullptr;
+
+        std::vector<std::unique_ptr<Font>> m_fonts;
+        std::unordered_map<std::string, int> m_fontsByName;
+        std::vector<std::unique_ptr<Text>> m_texts; // Destroyed texts leave a null entry, so ids stay stable
+        std::vector<GlyphInstance> m_scratch;
+    };
+
+} // namespace enDjinn
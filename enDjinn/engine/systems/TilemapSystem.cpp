@@ -0,0 +1,276 @@
+#include "TilemapSystem.h"
+#include "../assets/ResourceManager.h"
+#include "../managers/GraphicsManager.h"
+#include "../utils/Stats.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+namespace {
+    template< typename T > constexpr const T* to_ptr(const T& val) { return &val; }
+}
+
+namespace enDjinn {
+
+    TilemapSystem::~TilemapSystem() {
+        Shutdown();
+    }
+
+    void TilemapSystem::Startup(WGPUDevice device) {
+        m_device = device;
+    }
+
+    void TilemapSystem::Shutdown() {
+        for (std::unique_ptr<Tilemap>& map : m_tilemaps) {
+            if (map) ReleaseChunks(*map);
+        }
+        m_tilemaps.clear();
+        m_device = nullptr;
+    }
+
+	// CreateTilemap method. Tiles start empty; GPU buffers are created when chunks first become visible,
+	// so headless runs can still build and query tilemaps.
+    int TilemapSystem::CreateTilemap(const std::string& tilesetName, uint32_t width, uint32_t height, float tileSize,
+        uint32_t tilesetColumns, uint32_t tilesetRows, const glm::vec2& origin) {
+        if (width == 0 || height == 0 || tilesetColumns == 0 || tilesetRows == 0 || tileSize <= 0.0f) {
+            spdlog::error("TilemapSystem: Cannot create a {}x{} tilemap with tileset '{}' (invalid size).",
+                width, height, tilesetName);
+            return -1;
+        }
+
+        auto map = std::make_unique<Tilemap>();
+        map->tilesetName = tilesetName;
+        map->width = width;
+        map->height = height;
+        map->tileSize = tileSize;
+        map->tilesetColumns = tilesetColumns;
+        map->tilesetRows = tilesetRows;
+        map->origin = origin;
+        map->chunksX = (width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        map->chunksY = (height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        map->tiles.assign(static_cast<size_t>(width) * height, 0);
+        map->chunks.resize(static_cast<size_t>(map->chunksX) * map->chunksY);
+
+        m_tilemaps.push_back(std::move(map));
+        return static_cast<int>(m_tilemaps.size()) - 1;
+    }
+
+    void TilemapSystem::Destroy(int tilemap) {
+        if (Tilemap* map = Find(tilemap)) {
+            ReleaseChunks(*map);
+            m_tilemaps[tilemap].reset();
+        }
+    }
+
+    bool TilemapSystem::SetTile(int tilemap, uint32_t x, uint32_t y, uint16_t tile) {
+        Tilemap* map = Find(tilemap);
+        if (!map || x >= map->width || y >= map->height) return false;
+
+        uint16_t& current = map->tiles[static_cast<size_t>(y) * map->width + x];
+        if (current != tile) {
+            current = tile;
+            MarkDirty(*map, x, y);
+        }
+        return true;
+    }
+
+    uint16_t TilemapSystem::GetTile(int tilemap, uint32_t x, uint32_t y) const {
+        const Tilemap* map = Find(tilemap);
+        if (!map || x >= map->width || y >= map->height) return 0;
+        return map->tiles[static_cast<size_t>(y) * map->width + x];
+    }
+
+    bool TilemapSystem::SetTiles(int tilemap, const std::vector<uint16_t>& tiles) {
+        Tilemap* map = Find(tilemap);
+        if (!map) return false;
+        if (tiles.size() != map->tiles.size()) {
+            spdlog::error("TilemapSystem: Expected {} tiles for tilemap {}, got {}.", map->tiles.size(), tilemap, tiles.size());
+            return false;
+        }
+
+        map->tiles = tiles;
+        for (Chunk& chunk : map->chunks) chunk.dirty = true;
+        return true;
+    }
+
+    void TilemapSystem::Fill(int tilemap, uint16_t tile) {
+        if (Tilemap* map = Find(tilemap)) {
+            std::fill(map->tiles.begin(), map->tiles.end(), tile);
+            for (Chunk& chunk : map->chunks) chunk.dirty = true;
+        }
+    }
+
+	// Capture method. Culls whole chunks against the view, rebuilds the visible dirty ones and references
+	// their buffers into the snapshot. Dirty chunks out of view wait until they scroll in.
+    void TilemapSystem::Capture(std::vector<TilemapFrame>& frames, ResourceManager& resourceManager, const glm::vec4& viewRect) {
+        uint32_t chunksDrawn = 0;
+        for (std::unique_ptr<Tilemap>& mapPtr : m_tilemaps) {
+            if (!mapPtr) continue;
+            Tilemap& map = *mapPtr;
+
+			// 1. Chunk range overlapping the view. Grid rows grow downwards from the origin.
+            const float chunkWorldSize = CHUNK_SIZE * map.tileSize;
+            const int minChunkX = static_cast<int>(std::floor((viewRect.x - map.origin.x) / chunkWorldSize));
+            const int maxChunkX = static_cast<int>(std::floor((viewRect.z - map.origin.x) / chunkWorldSize));
+            const int minChunkY = static_cast<int>(std::floor((map.origin.y - viewRect.w) / chunkWorldSize));
+            const int maxChunkY = static_cast<int>(std::floor((map.origin.y - viewRect.y) / chunkWorldSize));
+            if (maxChunkX < 0 || maxChunkY < 0 || minChunkX >= static_cast<int>(map.chunksX) || minChunkY >= static_cast<int>(map.chunksY)) {
+                continue;
+            }
+
+            const Texture* texture = resourceManager.GetTexture(map.tilesetName);
+            if (!texture || !texture->texture) continue;
+            const glm::vec2 textureSize(static_cast<float>(texture->width), static_cast<float>(texture->height));
+
+			// 2. Rebuild what changed and collect the chunks that have tiles
+            TilemapFrame frame;
+            for (uint32_t chunkY = std::max(minChunkY, 0); chunkY <= std::min<uint32_t>(maxChunkY, map.chunksY - 1); ++chunkY) {
+                for (uint32_t chunkX = std::max(minChunkX, 0); chunkX <= std::min<uint32_t>(maxChunkX, map.chunksX - 1); ++chunkX) {
+                    Chunk& chunk = map.chunks[static_cast<size_t>(chunkY) * map.chunksX + chunkX];
+                    if (chunk.dirty) RebuildChunk(map, chunkX, chunkY, textureSize);
+                    if (chunk.instanceCount == 0) continue;
+
+                    wgpuBufferAddRef(chunk.instanceBuffer);
+                    frame.chunks.push_back({ chunk.instanceBuffer, chunk.instanceCount });
+                }
+            }
+            if (frame.chunks.empty()) continue;
+
+            wgpuTextureAddRef(texture->texture);
+            frame.texture = texture->texture;
+            chunksDrawn += static_cast<uint32_t>(frame.chunks.size());
+            frames.push_back(std::move(frame));
+        }
+        Stats::Get().Add("tilemap.chunks_drawn", chunksDrawn);
+    }
+
+	// Draw method. One bind group per tilemap, one instanced draw per chunk.
+    void TilemapSystem::Draw(WGPURenderPassEncoder renderPass, const std::vector<TilemapFrame>& frames, WGPURenderPipeline pipeline,
+        WGPUBuffer projectionBuffer, uint64_t projectionSize, WGPUSampler sampler, WGPUBuffer quadBuffer) {
+        if (frames.empty() || !pipeline) return;
+
+        wgpuRenderPassEncoderSetPipeline(renderPass, pipeline);
+        wgpuRenderPassEncoderSetVertexBuffer(renderPass, 0, quadBuffer, 0, 4 * 4 * sizeof(float));
+        WGPUBindGroupLayout layout = wgpuRenderPipelineGetBindGroupLayout(pipeline, 0);
+
+        for (const TilemapFrame& frame : frames) {
+            WGPUTextureView textureView = wgpuTextureCreateView(frame.texture, nullptr);
+            std::array<WGPUBindGroupEntry, 3> entries{};
+            entries[0] = { .binding = 0, .buffer = projectionBuffer, .size = projectionSize };
+            entries[1] = { .binding = 1, .sampler = sampler };
+            entries[2] = { .binding = 2, .textureView = textureView };
+            WGPUBindGroup bindGroup = wgpuDeviceCreateBindGroup(m_device, to_ptr(WGPUBindGroupDescriptor{
+                .layout = layout,
+                .entryCount = entries.size(),
+                .entries = entries.data()
+                }));
+            wgpuTextureViewRelease(textureView);
+
+            wgpuRenderPassEncoderSetBindGroup(renderPass, 0, bindGroup, 0, nullptr);
+            for (const TilemapChunkDraw& chunk : frame.chunks) {
+                wgpuRenderPassEncoderSetVertexBuffer(renderPass, 1, chunk.instanceBuffer, 0, sizeof(InstanceData) * chunk.instanceCount);
+                wgpuRenderPassEncoderDraw(renderPass, 4, chunk.instanceCount, 0, 0);
+            }
+            wgpuBindGroupRelease(bindGroup);
+        }
+        wgpuBindGroupLayoutRelease(layout);
+    }
+
+	// Release method. Drops the snapshot's references.
+    void TilemapSystem::Release(std::vector<TilemapFrame>& frames) {
+        for (TilemapFrame& frame : frames) {
+            for (const TilemapChunkDraw& chunk : frame.chunks) wgpuBufferRelease(chunk.instanceBuffer);
+            if (frame.texture) wgpuTextureRelease(frame.texture);
+        }
+        frames.clear();
+    }
+
+    TilemapSystem::Tilemap* TilemapSystem::Find(int tilemap) {
+        if (tilemap < 0 || static_cast<size_t>(tilemap) >= m_tilemaps.size() || !m_tilemaps[tilemap]) {
+            spdlog::warn("TilemapSystem: Unknown tilemap {}.", tilemap);
+            return nullptr;
+        }
+        return m_tilemaps[tilemap].get();
+    }
+
+    const TilemapSystem::Tilemap* TilemapSystem::Find(int tilemap) const {
+        if (tilemap < 0 || static_cast<size_t>(tilemap) >= m_tilemaps.size()) return nullptr;
+        return m_tilemaps[tilemap].get();
+    }
+
+    void TilemapSystem::MarkDirty(Tilemap& map, uint32_t x, uint32_t y) {
+        map.chunks[static_cast<size_t>(y / CHUNK_SIZE) * map.chunksX + x / CHUNK_SIZE].dirty = true;
+    }
+
+	// RebuildChunk method. Writes the chunk's instances into a fresh buffer; snapshots still in flight keep the old one.
+    void TilemapSystem::RebuildChunk(Tilemap& map, uint32_t chunkX, uint32_t chunkY, const glm::vec2& textureSize) {
+        Chunk& chunk = map.chunks[static_cast<size_t>(chunkY) * map.chunksX + chunkX];
+        chunk.dirty = false;
+        if (chunk.instanceBuffer) wgpuBufferRelease(chunk.instanceBuffer);
+        chunk.instanceBuffer = nullptr;
+        chunk.instanceCount = 0;
+
+        const uint32_t firstX = chunkX * CHUNK_SIZE;
+        const uint32_t firstY = chunkY * CHUNK_SIZE;
+        const uint32_t endX = std::min(firstX + CHUNK_SIZE, map.width);
+        const uint32_t endY = std::min(firstY + CHUNK_SIZE, map.height);
+        const uint32_t cellCount = map.tilesetColumns * map.tilesetRows;
+
+		// 1. Count the drawable tiles; indices past the tileset draw nothing
+        uint32_t count = 0;
+        for (uint32_t y = firstY; y < endY; ++y) {
+            for (uint32_t x = firstX; x < endX; ++x) {
+                const uint16_t tile = map.tiles[static_cast<size_t>(y) * map.width + x];
+                if (tile != 0 && tile <= cellCount) ++count;
+            }
+        }
+        if (count == 0) return;
+
+		// 2. Fill the instances straight into mapped memory. Cells are inset by half a texel so filtering
+		// never samples the neighbouring cell.
+        const uint64_t bufferSize = sizeof(InstanceData) * count;
+        chunk.instanceBuffer = wgpuDeviceCreateBuffer(m_device, to_ptr(WGPUBufferDescriptor{
+            .label = WGPUStringView("Tilemap Chunk Buffer", WGPU_STRLEN),
+            .usage = WGPUBufferUsage_Vertex,
+            .size = bufferSize,
+            .mappedAtCreation = true
+            }));
+        if (!chunk.instanceBuffer) return;
+        InstanceData* instances = static_cast<InstanceData*>(wgpuBufferGetMappedRange(chunk.instanceBuffer, 0, bufferSize));
+
+        const glm::vec2 cell(1.0f / map.tilesetColumns, 1.0f / map.tilesetRows);
+        const glm::vec2 inset(0.5f / std::max(textureSize.x, 1.0f), 0.5f / std::max(textureSize.y, 1.0f));
+        const float halfTile = map.tileSize * 0.5f;
+        uint32_t written = 0;
+        for (uint32_t y = firstY; y < endY; ++y) {
+            for (uint32_t x = firstX; x < endX; ++x) {
+                const uint16_t tile = map.tiles[static_cast<size_t>(y) * map.width + x];
+                if (tile == 0 || tile > cellCount) continue;
+
+                const uint32_t index = tile - 1u;
+                InstanceData& instance = instances[written++];
+                instance.translation = glm::vec3(map.origin.x + (x + 0.5f) * map.tileSize, map.origin.y - (y + 0.5f) * map.tileSize, 0.0f);
+                instance.scale = glm::vec2(halfTile, halfTile);
+                instance.uvRect = glm::vec4((index % map.tilesetColumns) * cell.x + inset.x, (index / map.tilesetColumns) * cell.y + inset.y,
+                    cell.x - 2.0f * inset.x, cell.y - 2.0f * inset.y);
+            }
+        }
+        wgpuBufferUnmap(chunk.instanceBuffer);
+        chunk.instanceCount = count;
+
+        Stats& stats = Stats::Get();
+        stats.Add("tilemap.chunk_uploads");
+        stats.Add("gpu.upload_bytes", static_cast<double>(bufferSize));
+    }
+
+    void TilemapSystem::ReleaseChunks(Tilemap& map) {
+        for (Chunk& chunk : map.chunks) {
+            if (chunk.instanceBuffer) wgpuBufferRelease(chunk.instanceBuffer);
+            chunk.instanceBuffer = nullptr;
+            chunk.instanceCount = 0;
+            chunk.dirty = true;
+        }
+    }
+
+} // namespace enDjinn
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <webgpu/webgpu.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace enDjinn {
+
+    class ResourceManager;
+
+	// One visible chunk in a frame snapshot: an instance buffer drawn with one instanced call
+    struct TilemapChunkDraw {
+        WGPUBuffer instanceBuffer = nullptr; // Referenced for as long as the snapshot is in flight
+        uint32_t instanceCount = 0;
+    };
+
+	// One tilemap's share of a frame snapshot
+    struct TilemapFrame {
+        WGPUTexture texture = nullptr; // Referenced for as long as the snapshot is in flight
+        std::vector<TilemapChunkDraw> chunks;
+    };
+
+	// Grid-based levels. A tilemap is a grid of tile indices into a tileset texture cut into equal cells,
+	// split into CHUNK_SIZE x CHUNK_SIZE chunks. Each chunk keeps its sprite instances in a GPU buffer that is
+	// rebuilt only when one of its tiles changes; chunks outside the view are skipped whole, and every visible
+	// chunk is one instanced draw with the sprite pipeline. Tilemaps draw behind the ECS sprites.
+	//
+	// Tile 0 is empty; tiles 1..N are tileset cells numbered left to right, top to bottom. Grid coordinates
+	// start at 0 in the top-left corner, which sits at the tilemap's origin in world space.
+    class TilemapSystem {
+    public:
+        static constexpr uint32_t CHUNK_SIZE = 32;
+
+        TilemapSystem() = default;
+        ~TilemapSystem();
+
+        void Startup(WGPUDevice device);
+        void Shutdown();
+
+		// Main thread API (also what Lua calls)
+        int CreateTilemap(const std::string& tilesetName, uint32_t width, uint32_t height, float tileSize,
+            uint32_t tilesetColumns, uint32_t tilesetRows, const glm::vec2& origin);
+        void Destroy(int tilemap);
+        bool SetTile(int tilemap, uint32_t x, uint32_t y, uint16_t tile);
+        uint16_t GetTile(int tilemap, uint32_t x, uint32_t y) const;
+        bool SetTiles(int tilemap, const std::vector<uint16_t>& tiles); // Row-major, width * height
+        void Fill(int tilemap, uint16_t tile);
+
+		// Frame snapshot hooks: Capture on the main thread, Draw on whichever thread renders.
+		// viewRect is the visible world area as (minX, minY, maxX, maxY).
+        void Capture(std::vector<TilemapFrame>& frames, ResourceManager& resourceManager, const glm::vec4& viewRect);
+        void Draw(WGPURenderPassEncoder renderPass, const std::vector<TilemapFrame>& frames, WGPURenderPipeline pipeline,
+            WGPUBuffer projectionBuffer, uint64_t projectionSize, WGPUSampler sampler, WGPUBuffer quadBuffer);
+        static void Release(std::vector<TilemapFrame>& frames);
+
+    private:
+        struct Chunk {
+            WGPUBuffer instanceBuffer = nullptr;
+            uint32_t instanceCount = 0;
+            bool dirty = true;
+        };
+
+        struct Tilemap {
+            std::string tilesetName;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            float tileSize = 1.0f;
+            uint32_t tilesetColumns = 1;
+            uint32_t tilesetRows = 1;
+            glm::vec2 origin = { 0.0f, 0.0f };
+            uint32_t chunksX = 0;
+            uint32_t chunksY = 0;
+            std::vector<uint16_t> tiles;
+            std::vector<Chunk> chunks;
+        };
+
+        Tilemap* Find(int tilemap);
+        const Tilemap* Find(int tilemap) const;
+        void MarkDirty(Tilemap& map, uint32_t x, uint32_t y);
+        void RebuildChunk(Tilemap& map, uint32_t chunkX, uint32_t chunkY, const glm::vec2& textureSize);
+        static void ReleaseChunks(Tilemap& map);
+
+        WGPUDevice m_device = nullptr;
+        std::vector<std::unique_ptr<Tilemap>> m_tilemaps; // Destroyed maps leave a null entry, so ids stay stable
+    };
+
+} // namespace enDjinn
@@ -0,0 +1,632 @@
+#include "WorldSnapshot.h"
+#include "../managers/ScriptManager.h" // sol with the engine's safety settings
+#include "../assets/ResourceManager.h"
+#include "../assets/Sprite.h"
+#include "CollisionSystem.h"
+#include "../utils/Types.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace enDjinn {
+
+    namespace {
+        constexpr uint32_t SNAPSHOT_MAGIC = 0x574A4445; // "EDJW"
+        constexpr uint32_t SNAPSHOT_VERSION = 3; // 2: Sprite uvRect and animation, 3: colliders
+        constexpr int MAX_TABLE_DEPTH = 64;
+
+		// Layout: magic, version, assets (count, then name and path each), slot count, then per slot its generation
+		// and a live flag, the free slot stack, per component pool its name and (slot, value) pairs ending in slot 0,
+		// then the collider count and each collider's entity, settings and position.
+		// A value is a tag followed by its payload; a table is its key/value pairs ending in a Nil tag.
+        enum class ValueTag : uint8_t {
+            Nil,
+            False,
+            True,
+            Integer,
+            Number,
+            String,
+            Table,
+            TableRef, // A table written earlier, by id
+            Sprite,
+            Vec2,
+            Vec3,
+            Script
+        };
+
+        class Writer {
+        public:
+            explicit Writer(std::vector<uint8_t>& out) : m_out(out) {}
+
+            template <typename T>
+            void Put(const T& value) {
+                static_assert(std::is_trivially_copyable_v<T>, "Only plain data is written directly");
+                const size_t offset = m_out.size();
+                m_out.resize(offset + sizeof(T));
+                std::memcpy(m_out.data() + offset, &value, sizeof(T));
+            }
+
+            void PutString(std::string_view text) {
+                Put(static_cast<uint32_t>(text.size()));
+                m_out.insert(m_out.end(), text.begin(), text.end());
+            }
+
+            // Writes the Lua value at 'index'
+            void PutValue(lua_State* L, int index, int depth) {
+                index = lua_absindex(L, index);
+                switch (lua_type(L, index)) {
+                case LUA_TNIL:
+                    Put(ValueTag::Nil);
+                    return;
+                case LUA_TBOOLEAN:
+                    Put(lua_toboolean(L, index) ? ValueTag::True : ValueTag::False);
+                    return;
+                case LUA_TNUMBER:
+                    if (lua_isinteger(L, index)) {
+                        Put(ValueTag::Integer);
+                        Put(static_cast<int64_t>(lua_tointeger(L, index)));
+                    }
+                    else {
+                        Put(ValueTag::Number);
+                        Put(static_cast<double>(lua_tonumber(L, index)));
+                    }
+                    return;
+                case LUA_TSTRING: {
+                    size_t length = 0;
+                    const char* text = lua_tolstring(L, index, &length);
+                    Put(ValueTag::String);
+                    PutString(std::string_view(text, length));
+                    return;
+                }
+                case LUA_TTABLE:
+                    PutTable(L, index, depth);
+                    return;
+                case LUA_TUSERDATA:
+                    if (sol::stack::check<Sprite>(L, index)) {
+                        const Sprite& sprite = sol::stack::get<Sprite&>(L, index);
+                        Put(ValueTag::Sprite);
+                        PutString(sprite.textureName);
+                        Put(sprite.position);
+                        Put(sprite.scale);
+                        Put(sprite.z);
+                        Put(sprite.blend);
+                        Put(sprite.uvRect);
+                        Put(sprite.animation);
+                        return;
+                    }
+                    if (sol::stack::check<glm::vec2>(L, index)) {
+                        Put(ValueTag::Vec2);
+                        Put(sol::stack::get<glm::vec2&>(L, index));
+                        return;
+                    }
+                    if (sol::stack::check<glm::vec3>(L, index)) {
+                        Put(ValueTag::Vec3);
+                        Put(sol::stack::get<glm::vec3&>(L, index));
+                        return;
+                    }
+                    if (sol::stack::check<ScriptComponent>(L, index)) {
+                        Put(ValueTag::Script);
+                        PutString(sol::stack::get<ScriptComponent&>(L, index).name);
+                        return;
+                    }
+                    break;
+                default:
+                    break;
+                }
+                ++m_unsupported;
+                Put(ValueTag::Nil);
+            }
+
+            uint64_t GetUnsupportedCount() const { return m_unsupported; }
+
+        private:
+            // A table fits at 'depth' if it was written before (then it is a reference) or is within the depth limit
+            bool CanPutTable(lua_State* L, int index, int depth) const {
+                return m_tables.count(lua_topointer(L, index)) || (depth < MAX_TABLE_DEPTH && lua_checkstack(L, 3));
+            }
+
+            // Keys that cannot be written are skipped with their value: a Nil in key position ends the table
+            bool IsSupportedKey(lua_State* L, int index, int depth) const {
+                const int type = lua_type(L, index);
+                if (type == LUA_TTABLE) return CanPutTable(L, index, depth);
+                return type == LUA_TNUMBER || type == LUA_TSTRING || type == LUA_TBOOLEAN;
+            }
+
+            void PutTable(lua_State* L, int index, int depth) {
+                const void* table = lua_topointer(L, index);
+                if (auto it = m_tables.find(table); it != m_tables.end()) {
+                    Put(ValueTag::TableRef);
+                    Put(it->second);
+                    return;
+                }
+                if (!CanPutTable(L, index, depth)) {
+                    ++m_unsupported;
+                    Put(ValueTag::Nil);
+                    return;
+                }
+                m_tables.emplace(table, static_cast<uint32_t>(m_tables.size()));
+
+                Put(ValueTag::Table);
+                lua_pushnil(L);
+                while (lua_next(L, index) != 0) {
+                    if (IsSupportedKey(L, -2, depth + 1)) {
+                        PutValue(L, -2, depth + 1);
+                        PutValue(L, -1, depth + 1);
+                    }
+                    else {
+                        ++m_unsupported;
+                    }
+                    lua_pop(L, 1);
+                }
+                Put(ValueTag::Nil); // End of table
+            }
+
+            std::vector<uint8_t>& m_out;
+            std::unordered_map<const void*, uint32_t> m_tables; // Tables written so far -> id
+            uint64_t m_unsupported = 0;
+        };
+
+        class Reader {
+        public:
+            explicit Reader(const std::vector<uint8_t>& data) : m_data(data) {}
+
+            template <typename T>
+            bool Get(T& value) {
+                static_assert(std::is_trivially_copyable_v<T>, "Only plain data is read directly");
+                if (!m_ok || m_data.size() - m_position < sizeof(T)) return m_ok = false;
+                std::memcpy(&value, m_data.data() + m_position, sizeof(T));
+                m_position += sizeof(T);
+                return true;
+            }
+
+            bool GetString(std::string& text) {
+                std::string_view view;
+                if (!GetStringView(view)) return false;
+                text.assign(view);
+                return true;
+            }
+
+            // Pushes the next value onto the Lua stack. 'tablesIndex' holds the tables read so far, for TableRef.
+            bool PushValue(lua_State* L, int tablesIndex, int depth) {
+                ValueTag tag;
+                if (!Get(tag) || !lua_checkstack(L, 4)) return m_ok = false;
+
+                switch (tag) {
+                case ValueTag::Nil:
+                    lua_pushnil(L);
+                    return true;
+                case ValueTag::False:
+                case ValueTag::True:
+                    lua_pushboolean(L, tag == ValueTag::True);
+                    return true;
+                case ValueTag::Integer: {
+                    int64_t value = 0;
+                    if (!Get(value)) return false;
+                    lua_pushinteger(L, static_cast<lua_Integer>(value));
+                    return true;
+                }
+                case ValueTag::Number: {
+                    double value = 0.0;
+                    if (!Get(value)) return false;
+                    lua_pushnumber(L, static_cast<lua_Number>(value));
+                    return true;
+                }
+                case ValueTag::String: {
+                    std::string_view text;
+                    if (!GetStringView(text)) return false;
+                    lua_pushlstring(L, text.data(), text.size());
+                    return true;
+                }
+                case ValueTag::Table: {
+                    if (depth >= MAX_TABLE_DEPTH) return m_ok = false;
+                    lua_createtable(L, 0, 0);
+                    lua_pushvalue(L, -1);
+                    lua_rawseti(L, tablesIndex, ++m_tableCount);
+
+                    for (;;) {
+                        if (m_position >= m_data.size()) return m_ok = false;
+                        if (static_cast<ValueTag>(m_data[m_position]) == ValueTag::Nil) {
+                            ++m_position; // End of table
+                            return true;
+                        }
+                        if (!PushValue(L, tablesIndex, depth + 1) || !PushValue(L, tablesIndex, depth + 1)) return false;
+                        lua_rawset(L, -3);
+                    }
+                }
+                case ValueTag::TableRef: {
+                    uint32_t id = 0;
+                    if (!Get(id) || id >= m_tableCount) return m_ok = false;
+                    lua_rawgeti(L, tablesIndex, static_cast<lua_Integer>(id) + 1);
+                    return true;
+                }
+                case ValueTag::Sprite: {
+                    Sprite sprite;
+                    if (!GetString(sprite.textureName) || !Get(sprite.position) || !Get(sprite.scale) || !Get(sprite.z) || !Get(sprite.blend) ||
+                        !Get(sprite.uvRect) || !Get(sprite.animation)) return false;
+                    if (sprite.blend > BlendMode::Opaque) return m_ok = false;
+                    sol::stack::push(L, std::move(sprite));
+                    return true;
+                }
+                case ValueTag::Vec2: {
+                    glm::vec2 value;
+                    if (!Get(value)) return false;
+                    sol::stack::push(L, value);
+                    return true;
+                }
+                case ValueTag::Vec3: {
+                    glm::vec3 value;
+                    if (!Get(value)) return false;
+                    sol::stack::push(L, value);
+                    return true;
+                }
+                case ValueTag::Script: {
+                    ScriptComponent script;
+                    if (!GetString(script.name)) return false;
+                    sol::stack::push(L, std::move(script));
+                    return true;
+                }
+                }
+                return m_ok = false; // Unknown tag
+            }
+
+            bool Ok() const { return m_ok; }
+            bool AtEnd() const { return m_position == m_data.size(); }
+
+        private:
+            bool GetStringView(std::string_view& text) {
+                uint32_t length = 0;
+                if (!Get(length)) return false;
+                if (m_data.size() - m_position < length) return m_ok = false;
+                text = std::string_view(reinterpret_cast<const char*>(m_data.data() + m_position), length);
+                m_position += length;
+                return true;
+            }
+
+            const std::vector<uint8_t>& m_data;
+            size_t m_position = 0;
+            lua_Integer m_tableCount = 0;
+            bool m_ok = true;
+        };
+
+        double MillisecondsSince(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+    }
+
+	// Capture method. Reads the pools straight off the tables ECS.Export hands out, without copying them in Lua.
+    bool WorldSnapshot::Capture(sol::state& lua, const ResourceManager& resources, const CollisionSystem* collisions) {
+        const auto start = std::chrono::steady_clock::now();
+
+        sol::protected_function exportWorld = lua["ECS"]["Export"];
+        if (!exportWorld.valid()) {
+            spdlog::error("WorldSnapshot: ECS.Export not found. Has ecs.lua run?");
+            return false;
+        }
+        sol::protected_function_result result = exportWorld();
+        if (!result.valid()) {
+            sol::error err = result;
+            spdlog::error("WorldSnapshot: ECS.Export failed: {}", err.what());
+            return false;
+        }
+        sol::table world = result;
+
+        std::vector<uint8_t> data;
+        data.reserve(m_data.size()); // The previous capture is a good guess
+        Writer writer(data);
+        writer.Put(SNAPSHOT_MAGIC);
+        writer.Put(SNAPSHOT_VERSION);
+
+		// 1. Asset references
+        const std::vector<AssetRequest> assets = resources.GetLoadedAssets();
+        writer.Put(static_cast<uint32_t>(assets.size()));
+        for (const AssetRequest& asset : assets) {
+            writer.PutString(asset.name);
+            writer.PutString(asset.partialPath);
+        }
+
+		// 2. Entity slots
+        lua_State* L = lua.lua_state();
+        const int top = lua_gettop(L);
+        lua_checkstack(L, 8);
+        world.push(L);
+        const int worldIndex = lua_gettop(L);
+        lua_getfield(L, worldIndex, "generations");
+        const int generationsIndex = lua_gettop(L);
+        lua_getfield(L, worldIndex, "live");
+        const int liveIndex = lua_gettop(L);
+        lua_getfield(L, worldIndex, "freeSlots");
+        const int freeIndex = lua_gettop(L);
+        lua_getfield(L, worldIndex, "components");
+        const int componentsIndex = lua_gettop(L);
+        lua_getfield(L, worldIndex, "slotCount");
+        const uint32_t slotCount = static_cast<uint32_t>(lua_tointeger(L, -1));
+        lua_pop(L, 1);
+
+        writer.Put(slotCount);
+        uint32_t liveCount = 0;
+        for (uint32_t slot = 1; slot <= slotCount; ++slot) {
+            lua_rawgeti(L, generationsIndex, slot);
+            writer.Put(static_cast<int64_t>(lua_tointeger(L, -1)));
+            lua_rawgeti(L, liveIndex, slot);
+            const uint8_t live = lua_isnil(L, -1) ? 0 : 1;
+            writer.Put(live);
+            liveCount += live;
+            lua_pop(L, 2);
+        }
+
+        const uint32_t freeCount = static_cast<uint32_t>(lua_rawlen(L, freeIndex));
+        writer.Put(freeCount);
+        for (uint32_t i = 1; i <= freeCount; ++i) {
+            lua_rawgeti(L, freeIndex, i);
+            writer.Put(static_cast<uint32_t>(lua_tointeger(L, -1)));
+            lua_pop(L, 1);
+        }
+
+		// 3. Component pools, in name order so the same world always produces the same bytes
+        std::vector<std::string> names;
+        lua_pushnil(L);
+        while (lua_next(L, componentsIndex) != 0) {
+            if (lua_type(L, -2) == LUA_TSTRING) names.emplace_back(lua_tostring(L, -2));
+            lua_pop(L, 1);
+        }
+        std::sort(names.begin(), names.end());
+
+        writer.Put(static_cast<uint32_t>(names.size()));
+        uint64_t valueCount = 0;
+        for (const std::string& name : names) {
+            writer.PutString(name);
+            lua_getfield(L, componentsIndex, name.c_str());
+            const int poolIndex = lua_gettop(L);
+
+            lua_pushnil(L);
+            while (lua_next(L, poolIndex) != 0) {
+                if (lua_isinteger(L, -2)) {
+                    writer.Put(static_cast<uint32_t>(lua_tointeger(L, -2)));
+                    writer.PutValue(L, -1, 0);
+                    ++valueCount;
+                }
+                lua_pop(L, 1);
+            }
+            writer.Put(uint32_t(0)); // End of pool
+            lua_pop(L, 1);
+        }
+        lua_settop(L, top);
+
+		// 4. Colliders, by entity so the bytes do not depend on the order they were added in
+        std::vector<ColliderState> colliders;
+        if (collisions) colliders = collisions->GetColliders();
+        std::sort(colliders.begin(), colliders.end(), [](const ColliderState& lhs, const ColliderState& rhs) { return lhs.entity < rhs.entity; });
+        writer.Put(static_cast<uint32_t>(colliders.size()));
+        for (const ColliderState& collider : colliders) {
+            writer.Put(collider.entity);
+            writer.Put(collider.desc.shape);
+            writer.Put(collider.desc.offset);
+            writer.Put(collider.desc.halfExtents);
+            writer.Put(collider.desc.radius);
+            writer.Put(collider.desc.layer);
+            writer.Put(collider.desc.mask);
+            writer.Put(static_cast<uint8_t>(collider.desc.followSprite));
+            writer.Put(collider.position);
+        }
+
+        if (writer.GetUnsupportedCount() > 0) {
+            spdlog::warn("WorldSnapshot: {} values (functions, foreign userdata or tables nested too deeply) were stored as nil.",
+                writer.GetUnsupportedCount());
+        }
+        m_data = std::move(data);
+        spdlog::info("WorldSnapshot: Captured {} entities, {} components, {} colliders and {} assets ({} bytes) in {:.2f} ms.",
+            liveCount, valueCount, colliders.size(), assets.size(), m_data.size(), MillisecondsSince(start));
+        return true;
+    }
+
+	// Restore method. Builds the pools as plain tables here, then swaps them in with a single ECS.Import call.
+    bool WorldSnapshot::Restore(sol::state& lua, ResourceManager& resources, CollisionSystem* collisions) const {
+        const auto start = std::chrono::steady_clock::now();
+        if (m_data.empty()) {
+            spdlog::error("WorldSnapshot: Nothing to restore, the snapshot is empty.");
+            return false;
+        }
+
+        Reader reader(m_data);
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        if (!reader.Get(magic) || magic != SNAPSHOT_MAGIC || !reader.Get(version) || version != SNAPSHOT_VERSION) {
+            spdlog::error("WorldSnapshot: Data is not a version {} world snapshot.", SNAPSHOT_VERSION);
+            return false;
+        }
+
+		// 1. Load every referenced asset that isn't loaded yet, as one batch
+        uint32_t assetCount = 0;
+        reader.Get(assetCount);
+        std::unordered_set<std::string> loaded;
+        for (AssetRequest& asset : resources.GetLoadedAssets()) {
+            loaded.insert(std::move(asset.name));
+        }
+        std::vector<AssetRequest> missing;
+        for (uint32_t i = 0; i < assetCount && reader.Ok(); ++i) {
+            AssetRequest asset;
+            if (reader.GetString(asset.name) && reader.GetString(asset.partialPath) && !loaded.count(asset.name)) {
+                missing.push_back(std::move(asset));
+            }
+        }
+        if (!reader.Ok()) {
+            spdlog::error("WorldSnapshot: Snapshot is truncated (asset list).");
+            return false;
+        }
+        if (!missing.empty()) {
+            resources.LoadBatch(std::move(missing), "world snapshot");
+        }
+
+		// 2. Rebuild the ECS state as plain tables
+        lua_State* L = lua.lua_state();
+        const int top = lua_gettop(L);
+        auto fail = [&](const char* what) {
+            lua_settop(L, top);
+            spdlog::error("WorldSnapshot: Snapshot is corrupt ({}).", what);
+            return false;
+        };
+        if (!lua_checkstack(L, 16)) return fail("Lua stack");
+
+        uint32_t slotCount = 0;
+        if (!reader.Get(slotCount) || slotCount > (1u << ENTITY_SLOT_BITS) - 1) return fail("slot count");
+
+        lua_createtable(L, 0, 5);
+        const int worldIndex = lua_gettop(L);
+        lua_createtable(L, static_cast<int>(slotCount), 0);
+        const int generationsIndex = lua_gettop(L);
+        lua_createtable(L, static_cast<int>(slotCount), 0);
+        const int liveIndex = lua_gettop(L);
+
+        uint32_t liveCount = 0;
+        for (uint32_t slot = 1; slot <= slotCount; ++slot) {
+            int64_t generation = 0;
+            uint8_t live = 0;
+            if (!reader.Get(generation) || !reader.Get(live) || generation < 0) return fail("entity slots");
+            lua_pushinteger(L, generation);
+            lua_rawseti(L, generationsIndex, slot);
+            if (live) {
+                lua_pushinteger(L, (generation << ENTITY_SLOT_BITS) | slot);
+                lua_rawseti(L, liveIndex, slot);
+                ++liveCount;
+            }
+        }
+
+        uint32_t freeCount = 0;
+        if (!reader.Get(freeCount) || freeCount > slotCount) return fail("free slots");
+        lua_createtable(L, static_cast<int>(freeCount), 0);
+        const int freeIndex = lua_gettop(L);
+        for (uint32_t i = 1; i <= freeCount; ++i) {
+            uint32_t slot = 0;
+            if (!reader.Get(slot) || slot == 0 || slot > slotCount) return fail("free slots");
+            lua_pushinteger(L, slot);
+            lua_rawseti(L, freeIndex, i);
+        }
+
+        uint32_t poolCount = 0;
+        if (!reader.Get(poolCount)) return fail("component pools");
+        lua_createtable(L, 0, static_cast<int>(poolCount));
+        const int componentsIndex = lua_gettop(L);
+        lua_createtable(L, 0, 0);
+        const int tablesIndex = lua_gettop(L);
+
+        uint64_t valueCount = 0;
+        std::string name;
+        for (uint32_t pool = 0; pool < poolCount; ++pool) {
+            if (!reader.GetString(name)) return fail("component pools");
+            lua_createtable(L, static_cast<int>(slotCount), 0);
+            for (;;) {
+                uint32_t slot = 0;
+                if (!reader.Get(slot) || slot > slotCount) return fail("component values");
+                if (slot == 0) break; // End of pool
+                if (!reader.PushValue(L, tablesIndex, 0)) return fail("component values");
+                lua_rawseti(L, -2, slot);
+                ++valueCount;
+            }
+            lua_setfield(L, componentsIndex, name.c_str());
+        }
+
+        uint32_t colliderCount = 0;
+        if (!reader.Get(colliderCount)) return fail("colliders");
+        std::vector<ColliderState> colliders;
+        for (uint32_t i = 0; i < colliderCount; ++i) {
+            ColliderState collider;
+            uint8_t followSprite = 0;
+            if (!reader.Get(collider.entity) || !reader.Get(collider.desc.shape) || !reader.Get(collider.desc.offset) ||
+                !reader.Get(collider.desc.halfExtents) || !reader.Get(collider.desc.radius) || !reader.Get(collider.desc.layer) ||
+                !reader.Get(collider.desc.mask) || !reader.Get(followSprite) || !reader.Get(collider.position)) return fail("colliders");
+            if (collider.desc.shape > ColliderShape::Circle) return fail("colliders");
+            collider.desc.followSprite = followSprite != 0;
+            colliders.push_back(collider);
+        }
+        if (!reader.AtEnd()) return fail("trailing data");
+
+        lua_pushinteger(L, slotCount);
+        lua_setfield(L, worldIndex, "slotCount");
+        lua_pushvalue(L, generationsIndex);
+        lua_setfield(L, worldIndex, "generations");
+        lua_pushvalue(L, liveIndex);
+        lua_setfield(L, worldIndex, "live");
+        lua_pushvalue(L, freeIndex);
+        lua_setfield(L, worldIndex, "freeSlots");
+        lua_pushvalue(L, componentsIndex);
+        lua_setfield(L, worldIndex, "components");
+        sol::table world(L, worldIndex);
+        lua_settop(L, top);
+
+		// 3. Swap the world in
+        sol::protected_function importWorld = lua["ECS"]["Import"];
+        if (!importWorld.valid()) {
+            spdlog::error("WorldSnapshot: ECS.Import not found. Has ecs.lua run?");
+            return false;
+        }
+        sol::protected_function_result result = importWorld(world);
+        if (!result.valid()) {
+            sol::error err = result;
+            spdlog::error("WorldSnapshot: ECS.Import failed: {}", err.what());
+            return false;
+        }
+
+		// 4. Replace the colliders, so entities destroyed since the capture get theirs back
+        if (collisions) collisions->SetColliders(colliders);
+
+        spdlog::info("WorldSnapshot: Restored {} entities, {} components and {} colliders in {:.2f} ms.",
+            liveCount, valueCount, colliders.size(), MillisecondsSince(start));
+        return true;
+    }
+
+	// SaveToFile method. Writes next to the destination first, so a crash mid-save never leaves half a file.
+    bool WorldSnapshot::SaveToFile(const std::filesystem::path& path) const {
+        if (m_data.empty()) {
+            spdlog::error("WorldSnapshot: Nothing to save to '{}', the snapshot is empty.", path.string());
+            return false;
+        }
+
+        std::error_code ec;
+        if (path.has_parent_path()) {
+            std::filesystem::create_directories(path.parent_path(), ec);
+        }
+
+        std::filesystem::path temporary = path;
+        temporary += ".tmp";
+        {
+            std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char*>(m_data.data()), static_cast<std::streamsize>(m_data.size()));
+            if (!file) {
+                spdlog::error("WorldSnapshot: Failed to write '{}'.", temporary.string());
+                return false;
+            }
+        }
+        std::filesystem::rename(temporary, path, ec);
+        if (ec) {
+            spdlog::error("WorldSnapshot: Failed to move the snapshot to '{}': {}", path.string(), ec.message());
+            return false;
+        }
+        return true;
+    }
+
+    bool WorldSnapshot::LoadFromFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if (!file) {
+            spdlog::error("WorldSnapshot: Failed to open '{}'.", path.string());
+            return false;
+        }
+
+        const std::streamsize size = file.tellg();
+        std::vector<uint8_t> data(static_cast<size_t>(std::max<std::streamsize>(size, 0)));
+        file.seekg(0);
+        if (!file.read(reinterpret_cast<char*>(data.data()), size)) {
+            spdlog::error("WorldSnapshot: Failed to read '{}'.", path.string());
+            return false;
+        }
+        m_data = std::move(data);
+        return true;
+    }
+
+} // namespace enDjinn
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace sol {
+    class state;
+}
+
+namespace enDjinn {
+
+    class ResourceManager;
+    class CollisionSystem;
+
+	// A binary image of the whole Lua ECS: every entity slot and generation, every component value, the
+	// colliders (which live natively, outside the ECS) and the textures and sounds that were loaded. Capture walks
+	// the component pools once; Restore rebuilds them in bulk through ECS.Import and replaces every collider, so
+	// loading a level or restarting one runs no per-entity script code.
+	//
+	// Component values may be nil, booleans, numbers, strings, plain tables (shared and cyclic references are
+	// kept, metatables are not) and the Sprite, vec2, vec3 and script usertypes. Anything else, such as
+	// functions, is stored as nil with a warning. Data is in host byte order.
+    class WorldSnapshot {
+    public:
+        // Without a CollisionSystem, the snapshot holds no colliders
+        bool Capture(sol::state& lua, const ResourceManager& resources, const CollisionSystem* collisions = nullptr);
+        // Loads any assets the world references that are not loaded yet, then replaces the ECS contents and,
+        // given a CollisionSystem, its colliders
+        bool Restore(sol::state& lua, ResourceManager& resources, CollisionSystem* collisions = nullptr) const;
+
+        bool SaveToFile(const std::filesystem::path& path) const;
+        bool LoadFromFile(const std::filesystem::path& path);
+
+        bool IsEmpty() const { return m_data.empty(); }
+        size_t GetSize() const { return m_data.size(); }
+
+    private:
+        std::vector<uint8_t> m_data;
+    };
+
+} // namespace enDjinn
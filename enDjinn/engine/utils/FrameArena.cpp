@@ -0,0 +1,65 @@
+#include "FrameArena.h"
+#include "Stats.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace enDjinn {
+
+	// do_allocate method. Aligns within the current block, moving on to the next (or a new) block when it is full.
+    void* LinearArena::do_allocate(size_t bytes, size_t alignment) {
+        while (m_block < m_blocks.size()) {
+            Block& block = m_blocks[m_block];
+            const uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+            const uintptr_t aligned = (base + m_offset + alignment - 1) & ~(static_cast<uintptr_t>(alignment) - 1);
+            const size_t end = static_cast<size_t>(aligned - base) + bytes;
+            if (end <= block.size) {
+                m_used += end - m_offset;
+                m_offset = end;
+                return reinterpret_cast<void*>(aligned);
+            }
+            ++m_block;
+            m_offset = 0;
+        }
+
+		// Out of blocks: add one at least twice as large as the last, with room for the alignment
+        const size_t previous = m_blocks.empty() ? m_initialCapacity / 2 : m_blocks.back().size;
+        const size_t size = std::max(previous * 2, bytes + alignment);
+        m_blocks.push_back({ std::make_unique<std::byte[]>(size), size });
+        m_block = m_blocks.size() - 1;
+        m_offset = 0;
+        return do_allocate(bytes, alignment);
+    }
+
+	// Reset method. A frame that spilled into several blocks leaves one block big enough for all of it.
+    void LinearArena::Reset() {
+        if (m_blocks.size() > 1) {
+            const size_t capacity = GetCapacity();
+            m_blocks.clear();
+            m_blocks.push_back({ std::make_unique<std::byte[]>(capacity), capacity });
+        }
+        m_block = 0;
+        m_offset = 0;
+        m_used = 0;
+    }
+
+    size_t LinearArena::GetCapacity() const {
+        size_t capacity = 0;
+        for (const Block& block : m_blocks) capacity += block.size;
+        return capacity;
+    }
+
+    FrameArena& FrameArena::Get() {
+        static FrameArena arena;
+        return arena;
+    }
+
+    void FrameArena::BeginFrame() {
+        Stats& stats = Stats::Get();
+        stats.Set("memory.frame_arena_bytes", static_cast<double>(m_arenas[m_current].GetUsed()));
+
+        m_current = (m_current + 1) % BUFFER_COUNT;
+        m_arenas[m_current].Reset();
+        stats.Set("memory.frame_arena_capacity", static_cast<double>(m_arenas[m_current].GetCapacity()));
+    }
+
+} // namespace enDjinn
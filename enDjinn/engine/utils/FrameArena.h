@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+namespace enDjinn {
+
+	// Bump allocator behind a std::pmr interface. Allocation moves a pointer forward; deallocation does nothing and
+	// Reset rewinds everything at once. When a frame outgrows the memory it spills into extra blocks, and the next
+	// Reset merges them into one block of the combined size, so after the first few frames it stops allocating.
+	// Not thread-safe.
+    class LinearArena : public std::pmr::memory_resource {
+    public:
+        explicit LinearArena(size_t initialCapacity = 64 * 1024) : m_initialCapacity(initialCapacity) {}
+
+        void Reset();
+        size_t GetUsed() const { return m_used; }
+        size_t GetCapacity() const;
+
+    protected:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void*, size_t, size_t) override {}
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    private:
+        struct Block {
+            std::unique_ptr<std::byte[]> memory;
+            size_t size = 0;
+        };
+
+        size_t m_initialCapacity;
+        std::vector<Block> m_blocks;
+        size_t m_block = 0;  // Block being allocated from
+        size_t m_offset = 0; // Into that block
+        size_t m_used = 0;   // Bytes handed out since the last Reset, alignment padding included
+    };
+
+	// Per-frame temporaries for the main thread, e.g. std::pmr::vector<T> list(FrameArena::Get().Resource()).
+	// Double-buffered: BeginFrame switches to the other arena, so memory taken during one frame stays valid
+	// through the next one (while its snapshot may still be in flight) and is reused the frame after.
+	// Containers must not outlive that, and only the main thread may allocate from it.
+    class FrameArena {
+    public:
+        static constexpr size_t BUFFER_COUNT = 2;
+
+        static FrameArena& Get();
+
+		// Called once per tick, before anything allocates for it
+        void BeginFrame();
+        std::pmr::memory_resource* Resource() { return &m_arenas[m_current]; }
+
+    private:
+        std::array<LinearArena, BUFFER_COUNT> m_arenas;
+        size_t m_current = 0;
+    };
+
+} // namespace enDjinn
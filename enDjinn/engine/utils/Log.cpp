@@ -0,0 +1,38 @@
+#include "Log.h"
+#include "spdlog/async.h"
+#include "spdlog/sinks/stdout_color_sinks.h"
+
+namespace enDjinn {
+    static constexpr const char* ASYNC_LOGGER_NAME = "enDjinn";
+    static constexpr const char* SYNC_LOGGER_NAME = "enDjinn-sync";
+
+	// Startup method implementation
+    void Log::Startup(size_t queueSize) {
+        if (spdlog::get(ASYNC_LOGGER_NAME)) return;
+
+		// 1. One background thread drains the queue and writes to the console
+        spdlog::init_thread_pool(queueSize, 1);
+        auto sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+        auto logger = std::make_shared<spdlog::async_logger>(ASYNC_LOGGER_NAME, sink, spdlog::thread_pool(),
+            spdlog::async_overflow_policy::overrun_oldest);
+
+		// 2. Let through everything the build kept; errors are flushed right away so they are not lost on a crash
+        logger->set_level(static_cast<spdlog::level::level_enum>(ENDJINN_LOG_LEVEL));
+        logger->flush_on(spdlog::level::err);
+        spdlog::set_default_logger(logger);
+    }
+
+	// Shutdown method implementation
+    void Log::Shutdown() {
+        std::shared_ptr<spdlog::logger> logger = spdlog::get(ASYNC_LOGGER_NAME);
+        if (!logger) return;
+
+        logger->flush();
+        auto sync = std::make_shared<spdlog::logger>(SYNC_LOGGER_NAME, logger->sinks().begin(), logger->sinks().end());
+        sync->set_level(logger->level());
+        spdlog::drop(SYNC_LOGGER_NAME);
+        spdlog::set_default_logger(sync);
+        spdlog::drop(ASYNC_LOGGER_NAME);
+    }
+
+} // namespace enDjinn
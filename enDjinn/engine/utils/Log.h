@@ -0,0 +1,98 @@
+#pragma once
+
+#include "spdlog/spdlog.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+
+// Compile-time log levels, numbered like spdlog::level. Calls below ENDJINN_LOG_LEVEL are discarded by the
+// compiler, arguments included, so trace and debug logging costs nothing in builds that strip it.
+// The build sets ENDJINN_LOG_LEVEL from the CMake option of the same name.
+#define ENDJINN_LOG_LEVEL_TRACE 0
+#define ENDJINN_LOG_LEVEL_DEBUG 1
+#define ENDJINN_LOG_LEVEL_INFO 2
+#define ENDJINN_LOG_LEVEL_WARN 3
+#define ENDJINN_LOG_LEVEL_ERROR 4
+#define ENDJINN_LOG_LEVEL_CRITICAL 5
+#define ENDJINN_LOG_LEVEL_OFF 6
+
+#ifndef ENDJINN_LOG_LEVEL
+#define ENDJINN_LOG_LEVEL ENDJINN_LOG_LEVEL_INFO
+#endif
+
+namespace enDjinn {
+
+	// Engine logging setup. Startup replaces the default spdlog logger with an asynchronous one, so every
+	// spdlog call (and the macros below) only queues the message; sink formatting and console I/O happen on
+	// a background thread. When the queue is full the oldest messages are dropped instead of blocking the caller.
+    class Log {
+    public:
+        static void Startup(size_t queueSize = 8192);
+        // Flushes what is queued and switches back to a synchronous logger, so logging during teardown still works
+        static void Shutdown();
+    };
+
+	// Per call site limiter behind the ENDJINN_*_EVERY macros. Lets one message through per interval and
+	// counts the ones it drops, so the next message that gets through can report them. Lock-free.
+    class LogRateLimiter {
+    public:
+        bool Allow(int64_t intervalMs, uint64_t& suppressed) {
+            const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+            int64_t last = m_lastEmitMs.load(std::memory_order_relaxed);
+            if ((last != NEVER && now - last < intervalMs) ||
+                !m_lastEmitMs.compare_exchange_strong(last, now, std::memory_order_relaxed)) {
+                m_suppressed.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            suppressed = m_suppressed.exchange(0, std::memory_order_relaxed);
+            return true;
+        }
+
+    private:
+        static constexpr int64_t NEVER = INT64_MIN;
+        std::atomic<int64_t> m_lastEmitMs{ NEVER };
+        std::atomic<uint64_t> m_suppressed{ 0 };
+    };
+
+    template <typename... Args>
+    void LogRateLimited(spdlog::level::level_enum level, uint64_t suppressed, spdlog::format_string_t<Args...> format, Args&&... args) {
+        if (suppressed == 0) {
+            spdlog::log(level, format, std::forward<Args>(args)...);
+        }
+        else {
+            spdlog::log(level, "{} ({} similar messages suppressed)", fmt::format(format, std::forward<Args>(args)...), suppressed);
+        }
+    }
+
+} // namespace enDjinn
+
+#define ENDJINN_LOG(logLevel, ...) \
+    do { \
+        if constexpr ((logLevel) >= ENDJINN_LOG_LEVEL) { \
+            ::spdlog::log(static_cast< ::spdlog::level::level_enum>(logLevel), __VA_ARGS__); \
+        } \
+    } while (0)
+
+// At most one message per intervalMs from this call site. Use on per-frame and per-entity paths.
+#define ENDJINN_LOG_EVERY(logLevel, intervalMs, ...) \
+    do { \
+        if constexpr ((logLevel) >= ENDJINN_LOG_LEVEL) { \
+            static ::enDjinn::LogRateLimiter endjinnRateLimiter; \
+            uint64_t endjinnSuppressed = 0; \
+            if (endjinnRateLimiter.Allow((intervalMs), endjinnSuppressed)) { \
+                ::enDjinn::LogRateLimited(static_cast< ::spdlog::level::level_enum>(logLevel), endjinnSuppressed, __VA_ARGS__); \
+            } \
+        } \
+    } while (0)
+
+#define ENDJINN_TRACE(...) ENDJINN_LOG(ENDJINN_LOG_LEVEL_TRACE, __VA_ARGS__)
+#define ENDJINN_DEBUG(...) ENDJINN_LOG(ENDJINN_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define ENDJINN_INFO(...) ENDJINN_LOG(ENDJINN_LOG_LEVEL_INFO, __VA_ARGS__)
+#define ENDJINN_WARN(...) ENDJINN_LOG(ENDJINN_LOG_LEVEL_WARN, __VA_ARGS__)
+#define ENDJINN_ERROR(...) ENDJINN_LOG(ENDJINN_LOG_LEVEL_ERROR, __VA_ARGS__)
+
+#define ENDJINN_INFO_EVERY(intervalMs, ...) ENDJINN_LOG_EVERY(ENDJINN_LOG_LEVEL_INFO, intervalMs, __VA_ARGS__)
+#define ENDJINN_WARN_EVERY(intervalMs, ...) ENDJINN_LOG_EVERY(ENDJINN_LOG_LEVEL_WARN, intervalMs, __VA_ARGS__)
+#define ENDJINN_ERROR_EVERY(intervalMs, ...) ENDJINN_LOG_EVERY(ENDJINN_LOG_LEVEL_ERROR, intervalMs, __VA_ARGS__)
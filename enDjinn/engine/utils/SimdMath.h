@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+
+// Pick the widest instruction set the compiler was told it may use. MSVC on x64 always has SSE2.
+#if defined(__AVX2__) || defined(__AVX__)
+#define ENDJINN_SIMD_AVX 1
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define ENDJINN_SIMD_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define ENDJINN_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace enDjinn::simd {
+
+	// Name of the code path compiled in, for logs and benchmarks
+    inline const char* InstructionSet() {
+#if defined(ENDJINN_SIMD_AVX)
+        return "AVX";
+#elif defined(ENDJINN_SIMD_SSE)
+        return "SSE2";
+#elif defined(ENDJINN_SIMD_NEON)
+        return "NEON";
+#else
+        return "scalar";
+#endif
+    }
+
+	// out[i] = a[i] * b[i]. Arrays may be unaligned; 'out' may alias 'a' or 'b'.
+    inline void Multiply(const float* a, const float* b, float* out, size_t count) {
+        size_t i = 0;
+#if defined(ENDJINN_SIMD_AVX)
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        }
+#elif defined(ENDJINN_SIMD_SSE)
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        }
+#elif defined(ENDJINN_SIMD_NEON)
+        for (; i + 4 <= count; i += 4) {
+            vst1q_f32(out + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+        }
+#endif
+        for (; i < count; ++i) {
+            out[i] = a[i] * b[i];
+        }
+    }
+
+	// inout[i] += a[i] * scale, e.g. integrating positions from velocities
+    inline void AddScaled(float* inout, const float* a, float scale, size_t count) {
+        size_t i = 0;
+#if defined(ENDJINN_SIMD_AVX)
+        const __m256 s = _mm256_set1_ps(scale);
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(inout + i, _mm256_add_ps(_mm256_loadu_ps(inout + i), _mm256_mul_ps(_mm256_loadu_ps(a + i), s)));
+        }
+#elif defined(ENDJINN_SIMD_SSE)
+        const __m128 s = _mm_set1_ps(scale);
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(inout + i, _mm_add_ps(_mm_loadu_ps(inout + i), _mm_mul_ps(_mm_loadu_ps(a + i), s)));
+        }
+#elif defined(ENDJINN_SIMD_NEON)
+        const float32x4_t s = vdupq_n_f32(scale);
+        for (; i + 4 <= count; i += 4) {
+            vst1q_f32(inout + i, vmlaq_f32(vld1q_f32(inout + i), vld1q_f32(a + i), s));
+        }
+#endif
+        for (; i < count; ++i) {
+            inout[i] += a[i] * scale;
+        }
+    }
+
+	// out[i] = a[i] * scale + offset, e.g. interpolating between two values. 'out' may alias 'a'.
+    inline void ScaleAdd(const float* a, float scale, float offset, float* out, size_t count) {
+        size_t i = 0;
+#if defined(ENDJINN_SIMD_AVX)
+        const __m256 s = _mm256_set1_ps(scale);
+        const __m256 o = _mm256_set1_ps(offset);
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(a + i), s), o));
+        }
+#elif defined(ENDJINN_SIMD_SSE)
+        const __m128 s = _mm_set1_ps(scale);
+        const __m128 o = _mm_set1_ps(offset);
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_ps(out + i, _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + i), s), o));
+        }
+#elif defined(ENDJINN_SIMD_NEON)
+        const float32x4_t s = vdupq_n_f32(scale);
+        const float32x4_t o = vdupq_n_f32(offset);
+        for (; i + 4 <= count; i += 4) {
+            vst1q_f32(out + i, vmlaq_f32(o, vld1q_f32(a + i), s));
+        }
+#endif
+        for (; i < count; ++i) {
+            out[i] = a[i] * scale + offset;
+        }
+    }
+
+} // namespace enDjinn::simd
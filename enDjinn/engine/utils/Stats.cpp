@@ -0,0 +1,195 @@
+#include "Stats.h"
+#include "spdlog/spdlog.h"
+#include "spdlog/fmt/fmt.h"
+#include <algorithm>
+
+namespace enDjinn {
+
+    Stats& Stats::Get() {
+        static Stats stats;
+        return stats;
+    }
+
+    void Stats::Add(std::string_view name, double amount) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_stats.find(name);
+        if (it == m_stats.end()) it = m_stats.emplace(std::string(name), Stat{}).first;
+        it->second.counter = true;
+        it->second.pending += amount;
+    }
+
+    void Stats::Set(std::string_view name, double value) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_stats.find(name);
+        if (it == m_stats.end()) it = m_stats.emplace(std::string(name), Stat{}).first;
+        it->second.counter = false;
+        it->second.value = value;
+    }
+
+    Stats::SamplerId Stats::AddSampler(Sampler sampler) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const SamplerId id = m_nextSamplerId++;
+        m_samplers.emplace_back(id, std::move(sampler));
+        ++m_samplerGeneration;
+        return id;
+    }
+
+    void Stats::RemoveSampler(SamplerId id) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (std::erase_if(m_samplers, [id](const auto& entry) { return entry.first == id; })) ++m_samplerGeneration;
+    }
+
+	// EndFrame method implementation
+    void Stats::EndFrame() {
+		// 1. Samplers report through Set, so they run without the lock held, from a copy that is only
+		// refreshed when samplers were added or removed since the last frame
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_samplerCacheGeneration != m_samplerGeneration) {
+                m_samplerCache = m_samplers;
+                m_samplerCacheGeneration = m_samplerGeneration;
+            }
+        }
+        for (auto& [id, sampler] : m_samplerCache) {
+            sampler(*this);
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+		// 2. Publish this frame's counters and start the next frame from zero
+        for (auto& [name, stat] : m_stats) {
+            if (!stat.counter) continue;
+            stat.value = stat.pending;
+            stat.pending = 0.0;
+        }
+
+		// 3. Frame time since the previous EndFrame
+        const auto now = std::chrono::steady_clock::now();
+        double frameMs = 0.0;
+        if (m_hasLastFrame) {
+            frameMs = std::chrono::duration<double, std::milli>(now - m_lastFrameEnd).count();
+            if (m_frameTimes.size() < m_frameWindow) {
+                m_frameTimes.push_back(frameMs);
+            }
+            else {
+                m_frameTimes[m_nextFrameTime] = frameMs;
+            }
+            m_nextFrameTime = (m_nextFrameTime + 1) % m_frameWindow;
+        }
+        m_lastFrameEnd = now;
+        m_hasLastFrame = true;
+        ++m_frameIndex;
+
+        if (m_csv.is_open()) WriteCsvRow(frameMs);
+    }
+
+    double Stats::GetValue(std::string_view name) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_stats.find(name);
+        return it != m_stats.end() ? it->second.value : 0.0;
+    }
+
+    std::vector<std::pair<std::string, double>> Stats::GetAll() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<std::pair<std::string, double>> all;
+        all.reserve(m_stats.size());
+        for (const auto& [name, stat] : m_stats) {
+            all.emplace_back(name, stat.value);
+        }
+        return all;
+    }
+
+    FrameTimeSummary Stats::GetFrameTimes() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return SummarizeFrameTimes();
+    }
+
+	// SummarizeFrameTimes method. Nearest-rank percentiles over a sorted copy of the window.
+    FrameTimeSummary Stats::SummarizeFrameTimes() const {
+        FrameTimeSummary summary;
+        if (m_frameTimes.empty()) return summary;
+
+        std::vector<double> sorted = m_frameTimes;
+        std::sort(sorted.begin(), sorted.end());
+        auto percentile = [&sorted](double p) {
+            const size_t rank = static_cast<size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5);
+            return sorted[std::min(rank, sorted.size() - 1)];
+        };
+
+        double total = 0.0;
+        for (double ms : sorted) total += ms;
+        summary.p50 = percentile(0.50);
+        summary.p95 = percentile(0.95);
+        summary.p99 = percentile(0.99);
+        summary.average = total / static_cast<double>(sorted.size());
+        summary.max = sorted.back();
+        summary.samples = sorted.size();
+        return summary;
+    }
+
+    uint64_t Stats::GetFrameIndex() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_frameIndex;
+    }
+
+    void Stats::SetFrameWindow(size_t frames) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_frameWindow = std::max<size_t>(frames, 1);
+        m_frameTimes.clear();
+        m_nextFrameTime = 0;
+    }
+
+    bool Stats::StartCsv(const std::filesystem::path& path) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_csv.is_open()) m_csv.close();
+
+        m_csv.open(path, std::ios::trunc);
+        if (!m_csv) {
+            spdlog::error("Stats: Failed to open '{}' for CSV output.", path.string());
+            return false;
+        }
+        m_csvColumns.clear();
+        m_csvHeaderWritten = false;
+        spdlog::info("Stats: Recording frame statistics to '{}'.", path.string());
+        return true;
+    }
+
+    void Stats::StopCsv() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_csv.is_open()) m_csv.close();
+    }
+
+	// WriteCsvRow method. Caller holds m_mutex.
+    void Stats::WriteCsvRow(double frameMs) {
+        if (!m_csvHeaderWritten) {
+            m_csv << "frame,frame_ms";
+            for (const auto& [name, stat] : m_stats) {
+                m_csvColumns.push_back(name);
+                m_csv << ',' << name;
+            }
+            m_csv << '\n';
+            m_csvHeaderWritten = true;
+        }
+
+        m_csv << m_frameIndex << ',' << frameMs;
+        for (const std::string& column : m_csvColumns) {
+            auto it = m_stats.find(column);
+            m_csv << ',' << (it != m_stats.end() ? it->second.value : 0.0);
+        }
+        m_csv << '\n';
+    }
+
+    std::string Stats::FormatSummary() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const FrameTimeSummary frames = SummarizeFrameTimes();
+        auto value = [this](std::string_view name) {
+            auto it = m_stats.find(name);
+            return it != m_stats.end() ? it->second.value : 0.0;
+        };
+
+        return fmt::format("{:.2f} ms p50, {:.2f} p95, {:.2f} p99 | {:.0f} draws, {:.0f} instances | {:.1f} MB textures | Lua {:.0f} KB | {:.0f} voices",
+            frames.p50, frames.p95, frames.p99, value("gpu.draw_calls"), value("gpu.instances"),
+            value("textures.resident_bytes") / (1024.0 * 1024.0), value("lua.heap_bytes") / 1024.0, value("audio.voices"));
+    }
+
+} // namespace enDjinn
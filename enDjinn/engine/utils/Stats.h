@@ -0,0 +1,96 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace enDjinn {
+
+	// Frame time distribution over the rolling window, in milliseconds
+    struct FrameTimeSummary {
+        double p50 = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+        double average = 0.0;
+        double max = 0.0;
+        size_t samples = 0;
+    };
+
+	// Engine-wide statistics registry. Counters (Add) accumulate during a frame and are published and reset by
+	// EndFrame; gauges (Set) keep their last value. Samplers run at EndFrame for values that are cheaper to read
+	// once per frame than to report as they change, such as the Lua heap. Safe to report from any thread.
+    class Stats {
+    public:
+        using Sampler = std::function<void(Stats&)>;
+        using SamplerId = uint32_t;
+
+        static Stats& Get();
+
+        void Add(std::string_view name, double amount = 1.0);
+        void Set(std::string_view name, double value);
+
+        SamplerId AddSampler(Sampler sampler);
+        void RemoveSampler(SamplerId id);
+
+		// Closes a frame: runs the samplers, publishes the counters, records the time since the previous
+		// EndFrame in the rolling window and appends a CSV row when recording. Called once per engine tick.
+        void EndFrame();
+
+		// Last published value, or 0 for a stat that was never reported
+        double GetValue(std::string_view name) const;
+        std::vector<std::pair<std::string, double>> GetAll() const; // Sorted by name
+        FrameTimeSummary GetFrameTimes() const;
+        uint64_t GetFrameIndex() const;
+        void SetFrameWindow(size_t frames);
+
+		// CSV recording, one row per frame. The columns are the stats known when the first row is written.
+        bool StartCsv(const std::filesystem::path& path);
+        void StopCsv();
+
+		// Compact one-line summary, used by the overlay
+        std::string FormatSummary() const;
+        void SetOverlayEnabled(bool enabled) { m_overlayEnabled = enabled; }
+        bool IsOverlayEnabled() const { return m_overlayEnabled; }
+
+    private:
+        struct Stat {
+            double pending = 0.0; // Counter total for the frame in progress
+            double value = 0.0;   // Published value
+            bool counter = false;
+        };
+
+        FrameTimeSummary SummarizeFrameTimes() const; // Caller holds m_mutex
+        void WriteCsvRow(double frameMs);
+
+        mutable std::mutex m_mutex;
+        std::map<std::string, Stat, std::less<>> m_stats;
+        std::vector<std::pair<SamplerId, Sampler>> m_samplers;
+        SamplerId m_nextSamplerId = 1;
+        uint64_t m_samplerGeneration = 0; // Bumped when samplers are added or removed
+        std::vector<std::pair<SamplerId, Sampler>> m_samplerCache; // What EndFrame runs; EndFrame's thread only
+        uint64_t m_samplerCacheGeneration = 0;
+
+        std::vector<double> m_frameTimes; // Ring buffer of the last m_frameWindow frame times
+        size_t m_frameWindow = 600;
+        size_t m_nextFrameTime = 0;
+        std::chrono::steady_clock::time_point m_lastFrameEnd;
+        bool m_hasLastFrame = false;
+        uint64_t m_frameIndex = 0;
+
+        std::ofstream m_csv;
+        std::vector<std::string> m_csvColumns;
+        bool m_csvHeaderWritten = false;
+
+        std::atomic<bool> m_overlayEnabled{ false };
+    };
+
+} // namespace enDjinn
@@ -0,0 +1,172 @@
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <exception>
+
+namespace enDjinn {
+
+	// Add method. Dependencies must already have been added, which also rules out cycles.
+    TaskGraph::TaskId TaskGraph::Add(std::string name, std::function<bool()> work, std::vector<TaskId> dependencies, Affinity affinity) {
+        const TaskId id = m_tasks.size();
+        Task& task = m_tasks.emplace_back();
+        task.name = std::move(name);
+        task.work = std::move(work);
+        task.affinity = affinity;
+
+        for (TaskId dependency : dependencies) {
+            if (dependency >= id) {
+                spdlog::error("TaskGraph: Task '{}' depends on unknown task {}.", task.name, dependency);
+                continue;
+            }
+            m_tasks[dependency].dependents.push_back(id);
+            task.dependencyCount++;
+        }
+        return id;
+    }
+
+	// Run method
+    bool TaskGraph::Run(ThreadPool& pool) {
+        m_start = std::chrono::steady_clock::now();
+        m_finished = 0;
+        m_mainThreadQueue.clear();
+
+		// 1. Reset the bookkeeping and start every task without dependencies
+        std::vector<TaskId> roots;
+        for (TaskId id = 0; id < m_tasks.size(); ++id) {
+            Task& task = m_tasks[id];
+            task.state = State::Pending;
+            task.remaining = task.dependencyCount;
+            task.dependencyFailed = false;
+            if (task.remaining == 0) roots.push_back(id);
+        }
+        for (TaskId id : roots) {
+            Dispatch(id, pool);
+        }
+
+		// 2. Run main thread tasks as they become ready, until everything has finished
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_changed.wait(lock, [this]() { return !m_mainThreadQueue.empty() || m_finished == m_tasks.size(); });
+            if (m_mainThreadQueue.empty()) break;
+
+            TaskId id = m_mainThreadQueue.front();
+            m_mainThreadQueue.pop_front();
+            lock.unlock();
+            Execute(id, pool);
+            lock.lock();
+        }
+
+        m_totalMs = ElapsedMs();
+        return std::all_of(m_tasks.begin(), m_tasks.end(), [](const Task& task) { return task.state == State::Succeeded; });
+    }
+
+    void TaskGraph::Dispatch(TaskId id, ThreadPool& pool) {
+        if (m_tasks[id].affinity == Affinity::MainThread) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_mainThreadQueue.push_back(id);
+            m_changed.notify_all();
+        }
+        else {
+            pool.Submit([this, id, &pool]() { Execute(id, pool); });
+        }
+    }
+
+    void TaskGraph::Execute(TaskId id, ThreadPool& pool) {
+        Task& task = m_tasks[id];
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            task.state = State::Running;
+            task.startMs = ElapsedMs();
+        }
+
+        bool succeeded = false;
+        try {
+            succeeded = task.work();
+        }
+        catch (const std::exception& e) {
+            spdlog::error("TaskGraph: Task '{}' threw: {}", task.name, e.what());
+        }
+        if (!succeeded) {
+            spdlog::error("TaskGraph: Task '{}' failed.", task.name);
+        }
+        Complete(id, succeeded, pool);
+    }
+
+	// Complete method. Releases dependents, skipping (transitively) the ones that depend on a failure.
+    void TaskGraph::Complete(TaskId id, bool succeeded, ThreadPool& pool) {
+        std::vector<TaskId> ready;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            std::vector<std::pair<TaskId, State>> finished = { { id, succeeded ? State::Succeeded : State::Failed } };
+
+            while (!finished.empty()) {
+                auto [doneId, doneState] = finished.back();
+                finished.pop_back();
+
+                Task& done = m_tasks[doneId];
+                if (doneState != State::Skipped) done.durationMs = ElapsedMs() - done.startMs;
+                done.state = doneState;
+                m_finished++;
+
+                for (TaskId dependentId : done.dependents) {
+                    Task& dependent = m_tasks[dependentId];
+                    if (doneState != State::Succeeded) dependent.dependencyFailed = true;
+                    if (--dependent.remaining > 0) continue;
+
+                    if (dependent.dependencyFailed) {
+                        spdlog::warn("TaskGraph: Skipping '{}' because a dependency failed.", dependent.name);
+                        finished.push_back({ dependentId, State::Skipped });
+                    }
+                    else {
+                        ready.push_back(dependentId);
+                    }
+                }
+            }
+            // Notify under the lock: once the last task is done, Run may return and destroy the graph
+            m_changed.notify_all();
+        }
+
+        for (TaskId readyId : ready) {
+            Dispatch(readyId, pool);
+        }
+    }
+
+    double TaskGraph::ElapsedMs() const {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_start).count();
+    }
+
+    std::vector<TaskGraph::TaskTiming> TaskGraph::GetTimings() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<TaskTiming> timings;
+        timings.reserve(m_tasks.size());
+        for (const Task& task : m_tasks) {
+            const bool ran = task.state == State::Succeeded || task.state == State::Failed;
+            timings.push_back({ task.name, task.startMs, task.durationMs, task.affinity == Affinity::MainThread, ran, task.state == State::Succeeded });
+        }
+        return timings;
+    }
+
+	// LogTimings method. One line per task in start order, then the wall time against the summed task time.
+    void TaskGraph::LogTimings(const std::string& title) const {
+        std::vector<TaskTiming> timings = GetTimings();
+        std::sort(timings.begin(), timings.end(), [](const TaskTiming& a, const TaskTiming& b) {
+            return a.ran != b.ran ? a.ran : a.startMs < b.startMs; // Skipped tasks last
+            });
+
+        double summedMs = 0.0;
+        spdlog::info("{} timings:", title);
+        for (const TaskTiming& timing : timings) {
+            if (!timing.ran) {
+                spdlog::info("  {:<20} skipped", timing.name);
+                continue;
+            }
+            summedMs += timing.durationMs;
+            spdlog::info("  {:<20} {:>8.2f} ms  (starts at {:>8.2f} ms, {}){}", timing.name, timing.durationMs, timing.startMs,
+                timing.mainThread ? "main thread" : "worker", timing.succeeded ? "" : "  FAILED");
+        }
+        spdlog::info("  {:<20} {:>8.2f} ms  ({:.2f} ms of work, {:.1f}x overlap)", "total", m_totalMs, summedMs,
+            m_totalMs > 0.0 ? summedMs / m_totalMs : 1.0);
+    }
+
+} // namespace enDjinn
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace enDjinn {
+
+    class ThreadPool;
+
+	// A one-shot dependency graph of named tasks. Independent tasks run concurrently on the ThreadPool;
+	// tasks pinned to the main thread (window creation, anything GLFW) run on the thread that calls Run.
+	// A task that fails or throws causes everything depending on it to be skipped.
+    class TaskGraph {
+    public:
+        using TaskId = size_t;
+
+        enum class Affinity {
+            Any,
+            MainThread
+        };
+
+        struct TaskTiming {
+            std::string name;
+            double startMs = 0.0;    // Relative to the start of Run
+            double durationMs = 0.0;
+            bool mainThread = false;
+            bool ran = false;
+            bool succeeded = false;
+        };
+
+        TaskId Add(std::string name, std::function<bool()> work, std::vector<TaskId> dependencies = {}, Affinity affinity = Affinity::Any);
+
+		// Runs every task and returns once all have finished or been skipped. Must be called on the main thread.
+		// Returns true if every task succeeded.
+        bool Run(ThreadPool& pool);
+
+        std::vector<TaskTiming> GetTimings() const;
+        double GetTotalMs() const { return m_totalMs; }
+        void LogTimings(const std::string& title) const;
+
+    private:
+        enum class State {
+            Pending,
+            Running,
+            Succeeded,
+            Failed,
+            Skipped
+        };
+
+        struct Task {
+            std::string name;
+            std::function<bool()> work;
+            std::vector<TaskId> dependents;
+            size_t dependencyCount = 0;
+            Affinity affinity = Affinity::Any;
+            State state = State::Pending;
+            size_t remaining = 0;
+            bool dependencyFailed = false;
+            double startMs = 0.0;
+            double durationMs = 0.0;
+        };
+
+        void Dispatch(TaskId id, ThreadPool& pool);
+        void Execute(TaskId id, ThreadPool& pool);
+        void Complete(TaskId id, bool succeeded, ThreadPool& pool);
+        double ElapsedMs() const;
+
+        std::vector<Task> m_tasks;
+        std::chrono::steady_clock::time_point m_start;
+        double m_totalMs = 0.0;
+
+        mutable std::mutex m_mutex;
+        std::condition_variable m_changed;
+        std::deque<TaskId> m_mainThreadQueue;
+        size_t m_finished = 0;
+    };
+
+} // namespace enDjinn
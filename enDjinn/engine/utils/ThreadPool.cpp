@@ -0,0 +1,104 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+
+namespace enDjinn {
+
+    ThreadPool::ThreadPool(unsigned int threadCount) {
+        if (threadCount == 0) {
+            unsigned int hardware = std::thread::hardware_concurrency();
+            threadCount = hardware > 1 ? hardware - 1 : 1;
+        }
+
+        m_workers.reserve(threadCount);
+        for (unsigned int i = 0; i < threadCount; ++i) {
+            m_workers.emplace_back([this]() { WorkerLoop(); });
+        }
+    }
+
+	// Destructor. Finishes the queued jobs, then joins every worker.
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread& worker : m_workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool& ThreadPool::Get() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    void ThreadPool::Enqueue(std::function<void()> job) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push_back(std::move(job));
+        }
+        m_wake.notify_one();
+    }
+
+    void ThreadPool::WorkerLoop() {
+        for (;;) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wake.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+                if (m_jobs.empty()) return; // Only reached when stopping
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+            }
+            job();
+        }
+    }
+
+    void ThreadPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+        if (count == 0) return;
+        grain = std::max<size_t>(grain, 1);
+
+        const size_t chunkCount = (count + grain - 1) / grain;
+        if (chunkCount == 1) {
+            body(0, count);
+            return;
+        }
+
+		// Chunks are claimed from a shared counter, so helpers that start late simply find nothing left.
+		// The state is shared because a helper may still be running after the caller has returned.
+        struct SharedState {
+            std::atomic<size_t> nextChunk{ 0 };
+            std::atomic<size_t> doneChunks{ 0 };
+            std::mutex mutex;
+            std::condition_variable done;
+        };
+        auto state = std::make_shared<SharedState>();
+
+        auto runChunks = [state, &body, count, grain, chunkCount]() {
+            for (;;) {
+                size_t chunk = state->nextChunk.fetch_add(1);
+                if (chunk >= chunkCount) return;
+
+                size_t begin = chunk * grain;
+                body(begin, std::min(begin + grain, count));
+
+                if (state->doneChunks.fetch_add(1) + 1 == chunkCount) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    state->done.notify_all();
+                }
+            }
+        };
+
+		// 'body' is only touched while chunks remain, and the caller waits for all of them below
+        size_t helpers = std::min<size_t>(m_workers.size(), chunkCount - 1);
+        for (size_t i = 0; i < helpers; ++i) {
+            Enqueue(runChunks);
+        }
+        runChunks();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->done.wait(lock, [&state, chunkCount]() { return state->doneChunks.load() == chunkCount; });
+    }
+
+} // namespace enDjinn
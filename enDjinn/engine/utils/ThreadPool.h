@@ -0,0 +1,56 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace enDjinn {
+
+	// Fixed-size pool of worker threads shared by the engine for background and data-parallel work.
+    class ThreadPool {
+    public:
+		// threadCount == 0 picks one worker per hardware thread, minus the calling thread
+        explicit ThreadPool(unsigned int threadCount = 0);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+		// Queues a callable and returns a future for its result
+        template<typename F>
+        auto Submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+            using Result = std::invoke_result_t<std::decay_t<F>>;
+            auto packaged = std::make_shared<std::packaged_task<Result()>>(std::forward<F>(task));
+            std::future<Result> future = packaged->get_future();
+            Enqueue([packaged]() { (*packaged)(); });
+            return future;
+        }
+
+		// Splits [0, count) into chunks of at most 'grain' items and runs body(begin, end) on each.
+		// The calling thread works on chunks too, so this is safe to call from inside a pool task.
+        void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+        unsigned int GetThreadCount() const { return static_cast<unsigned int>(m_workers.size()); }
+
+		// The engine-wide pool, created on first use
+        static ThreadPool& Get();
+
+    private:
+        void Enqueue(std::function<void()> job);
+        void WorkerLoop();
+
+        std::vector<std::thread> m_workers;
+        std::deque<std::function<void()>> m_jobs;
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        bool m_stopping = false;
+    };
+
+} // namespace enDjinn
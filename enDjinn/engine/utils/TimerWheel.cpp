@@ -0,0 +1,61 @@
+#include "TimerWheel.h"
+#include <algorithm>
+
+namespace enDjinn {
+
+    void TimerWheel::Schedule(uint64_t id, uint64_t delayTicks) {
+        Insert(Timer{ id, m_now + std::max<uint64_t>(delayTicks, 1) });
+        ++m_count;
+    }
+
+	// Insert method. A timer goes to the lowest level whose span still reaches its expiry. Its slot there is the
+	// expiry's digit at that level, so the slot comes round (and cascades) exactly when the timer is due.
+    void TimerWheel::Insert(const Timer& timer) {
+        const uint64_t delta = timer.expiry - m_now;
+        for (uint32_t level = 0; level < LEVEL_COUNT; ++level) {
+            if (delta < (uint64_t(1) << (SLOT_BITS * (level + 1)))) {
+                const uint64_t slot = (timer.expiry >> (SLOT_BITS * level)) & (SLOT_COUNT - 1);
+                m_slots[level][slot].push_back(timer);
+                return;
+            }
+        }
+
+		// Beyond the top level: park it in the top slot that comes round last and re-file it from there
+        const uint32_t top = LEVEL_COUNT - 1;
+        const uint64_t slot = ((m_now >> (SLOT_BITS * top)) + SLOT_COUNT - 1) & (SLOT_COUNT - 1);
+        m_slots[top][slot].push_back(timer);
+    }
+
+	// Cascade method. Re-files the slot of 'level' that the current tick just entered; its timers land lower down.
+    void TimerWheel::Cascade(uint32_t level) {
+        const uint64_t slot = (m_now >> (SLOT_BITS * level)) & (SLOT_COUNT - 1);
+        m_cascade.clear();
+        m_cascade.swap(m_slots[level][slot]);
+        for (const Timer& timer : m_cascade) Insert(timer);
+    }
+
+	// Advance method implementation
+    void TimerWheel::Advance(std::vector<uint64_t>& fired) {
+        ++m_now;
+
+		// 1. When a level wraps, pull the next slot of the level above down. Higher levels go first, since their
+		// timers may land in a lower slot that is about to cascade too.
+        uint32_t wrapped = 0;
+        while (wrapped + 1 < LEVEL_COUNT && (m_now & ((uint64_t(1) << (SLOT_BITS * (wrapped + 1))) - 1)) == 0) ++wrapped;
+        for (uint32_t level = wrapped; level > 0; --level) Cascade(level);
+
+		// 2. Everything in the current level-0 slot expires now
+        std::vector<Timer>& due = m_slots[0][m_now & (SLOT_COUNT - 1)];
+        for (const Timer& timer : due) fired.push_back(timer.id);
+        m_count -= due.size();
+        due.clear();
+    }
+
+    void TimerWheel::Clear() {
+        for (auto& level : m_slots) {
+            for (std::vector<Timer>& slot : level) slot.clear();
+        }
+        m_count = 0;
+    }
+
+} // namespace enDjinn
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace enDjinn {
+
+	// Hierarchical timer wheel keyed by simulation tick. Level 0 has one slot per tick for the next 64 ticks, each
+	// level above covers 64 times the span of the one below, and an entry moves down a level whenever the wheel
+	// below it wraps around. Scheduling and expiring are O(1) per timer no matter how many timers are waiting, and
+	// a tick on which nothing expires only touches one empty slot. Timers carry a caller-defined id and cannot be
+	// cancelled; callers ignore ids that went stale instead.
+    class TimerWheel {
+    public:
+        static constexpr uint32_t SLOT_BITS = 6;
+        static constexpr uint32_t SLOT_COUNT = 1u << SLOT_BITS;
+        static constexpr uint32_t LEVEL_COUNT = 5; // 2^30 ticks, about 200 days at 60 Hz; longer delays are re-filed
+
+		// Fires 'id' on the Advance that reaches now + delay. A delay of 0 counts as 1.
+        void Schedule(uint64_t id, uint64_t delayTicks);
+
+		// Moves to the next tick and appends the ids that expire on it to 'fired'
+        void Advance(std::vector<uint64_t>& fired);
+
+        uint64_t GetTick() const { return m_now; }
+        size_t GetCount() const { return m_count; }
+        void Clear();
+
+    private:
+        struct Timer {
+            uint64_t id;
+            uint64_t expiry;
+        };
+
+        void Insert(const Timer& timer);
+        void Cascade(uint32_t level);
+
+        uint64_t m_now = 0;
+        size_t m_count = 0;
+        std::array<std::array<std::vector<Timer>, SLOT_COUNT>, LEVEL_COUNT> m_slots;
+        std::vector<Timer> m_cascade; // Scratch, so cascading does not allocate
+    };
+
+} // namespace enDjinn
@@ -1,4 +1,5 @@
 #include "glm/glm.hpp"
+#include <cstdint>
 #include <string>
 
 #pragma once
@@ -8,6 +9,10 @@ typedef glm::vec3 vec3;
 typedef glm::vec4 vec4;
 
 namespace enDjinn {
+	// Lua ECS entity handle: slot in the low 24 bits, generation above them (see ecs.lua)
+    using EntityId = int64_t;
+    constexpr int ENTITY_SLOT_BITS = 24; // Must match SLOT_BITS in ecs.lua
+
     enum KeyCode : int {
         // Alphanumeric keys
         KEY_SPACE = GLFW_KEY_SPACE,
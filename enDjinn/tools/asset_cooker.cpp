@@ -0,0 +1,249 @@
+// asset_cooker: converts the loose asset tree into a single pack file that ResourceManager can map.
+// Usage: asset_cooker <asset_root> <output.pak>
+//
+// Images are decoded to RGBA8 with a full sRGB-correct mip chain, sounds are decoded to float PCM,
+// and Lua scripts are compiled to bytecode. Anything else in the tree is ignored.
+
+#include "assets/AssetPack.h"
+#include "spdlog/spdlog.h"
+#include "soloud_wav.h"
+#include <lua.hpp>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+using namespace enDjinn;
+namespace fs = std::filesystem;
+
+namespace {
+
+	// One cooked asset waiting to be written
+    struct CookedAsset {
+        std::string key;
+        PackEntry entry{};
+        std::vector<uint8_t> payload;
+    };
+
+    std::string LowerExtension(const fs::path& path) {
+        std::string ext = path.extension().string();
+        for (char& c : ext) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        return ext;
+    }
+
+	// sRGB <-> linear conversion so mips are averaged in linear light
+    float SrgbToLinear(uint8_t value) {
+        float c = value / 255.0f;
+        return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+    }
+
+    uint8_t LinearToSrgb(float value) {
+        float c = value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        return static_cast<uint8_t>(std::clamp(c * 255.0f + 0.5f, 0.0f, 255.0f));
+    }
+
+	// Box-filters one RGBA8 level into the next. Odd edges clamp, so 1xN levels are handled too.
+    std::vector<uint8_t> Downsample(const uint8_t* src, uint32_t width, uint32_t height) {
+        const uint32_t dstWidth = std::max(1u, width / 2);
+        const uint32_t dstHeight = std::max(1u, height / 2);
+        std::vector<uint8_t> dst(size_t(dstWidth) * dstHeight * 4);
+
+        for (uint32_t y = 0; y < dstHeight; ++y) {
+            for (uint32_t x = 0; x < dstWidth; ++x) {
+                const uint32_t x0 = std::min(x * 2, width - 1), x1 = std::min(x * 2 + 1, width - 1);
+                const uint32_t y0 = std::min(y * 2, height - 1), y1 = std::min(y * 2 + 1, height - 1);
+                const uint8_t* p[4] = {
+                    src + (size_t(y0) * width + x0) * 4, src + (size_t(y0) * width + x1) * 4,
+                    src + (size_t(y1) * width + x0) * 4, src + (size_t(y1) * width + x1) * 4,
+                };
+
+                uint8_t* out = dst.data() + (size_t(y) * dstWidth + x) * 4;
+                for (int c = 0; c < 3; ++c) {
+                    float sum = SrgbToLinear(p[0][c]) + SrgbToLinear(p[1][c]) + SrgbToLinear(p[2][c]) + SrgbToLinear(p[3][c]);
+                    out[c] = LinearToSrgb(sum * 0.25f);
+                }
+                // Alpha is linear already
+                out[3] = static_cast<uint8_t>((p[0][3] + p[1][3] + p[2][3] + p[3][3] + 2) / 4);
+            }
+        }
+        return dst;
+    }
+
+    bool CookImage(const fs::path& file, CookedAsset& asset) {
+        int width, height, channels;
+        unsigned char* pixels = stbi_load(file.generic_string().c_str(), &width, &height, &channels, 4);
+        if (!pixels) {
+            spdlog::error("asset_cooker: Failed to decode image '{}': {}", file.generic_string(), stbi_failure_reason());
+            return false;
+        }
+
+        uint32_t mipCount = 1;
+        while (((uint32_t)width >> mipCount) > 0 || ((uint32_t)height >> mipCount) > 0) ++mipCount;
+
+        asset.payload.assign(pixels, pixels + size_t(width) * height * 4);
+        stbi_image_free(pixels);
+
+		// Append each level after the previous one
+        uint64_t levelOffset = 0;
+        for (uint32_t level = 1; level < mipCount; ++level) {
+            const uint32_t w = std::max(1u, (uint32_t)width >> (level - 1));
+            const uint32_t h = std::max(1u, (uint32_t)height >> (level - 1));
+            std::vector<uint8_t> next = Downsample(asset.payload.data() + levelOffset, w, h);
+            levelOffset += PackMipSize(width, height, level - 1);
+            asset.payload.insert(asset.payload.end(), next.begin(), next.end());
+        }
+
+        asset.entry.type = static_cast<uint32_t>(PackAssetType::Image);
+        asset.entry.width = (uint32_t)width;
+        asset.entry.height = (uint32_t)height;
+        asset.entry.mipCount = mipCount;
+        return true;
+    }
+
+    bool CookSound(const fs::path& file, CookedAsset& asset) {
+        SoLoud::Wav wav;
+        SoLoud::result result = wav.load(file.generic_string().c_str());
+        if (result != SoLoud::SO_NO_ERROR) {
+            spdlog::error("asset_cooker: Failed to decode sound '{}' (SoLoud error {}).", file.generic_string(), result);
+            return false;
+        }
+
+        const size_t bytes = size_t(wav.mSampleCount) * wav.mChannels * sizeof(float);
+        asset.payload.resize(bytes);
+        std::memcpy(asset.payload.data(), wav.mData, bytes);
+
+        asset.entry.type = static_cast<uint32_t>(PackAssetType::Sound);
+        asset.entry.width = wav.mChannels;
+        asset.entry.height = static_cast<uint32_t>(wav.mBaseSamplerate);
+        return true;
+    }
+
+    int WriteBytecode(lua_State*, const void* data, size_t size, void* userdata) {
+        auto* out = static_cast<std::vector<uint8_t>*>(userdata);
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        out->insert(out->end(), bytes, bytes + size);
+        return 0;
+    }
+
+    bool CookScript(const fs::path& file, CookedAsset& asset) {
+        lua_State* L = luaL_newstate();
+        if (luaL_loadfile(L, file.generic_string().c_str()) != LUA_OK) {
+            spdlog::error("asset_cooker: Failed to compile '{}': {}", file.generic_string(), lua_tostring(L, -1));
+            lua_close(L);
+            return false;
+        }
+
+        lua_dump(L, WriteBytecode, &asset.payload, 0);
+        lua_close(L);
+
+        asset.entry.type = static_cast<uint32_t>(PackAssetType::Script);
+        return true;
+    }
+
+    uint64_t AlignUp(uint64_t value) {
+        return (value + PACK_ALIGNMENT - 1) & ~(PACK_ALIGNMENT - 1);
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        spdlog::error("Usage: asset_cooker <asset_root> <output.pak>");
+        return 1;
+    }
+
+    const fs::path root = argv[1];
+    const fs::path output = argv[2];
+    if (!fs::is_directory(root)) {
+        spdlog::error("asset_cooker: '{}' is not a directory.", root.string());
+        return 1;
+    }
+
+	// 1. Cook every recognised file under the root
+    std::vector<CookedAsset> assets;
+    bool failed = false;
+    for (const fs::directory_entry& dirEntry : fs::recursive_directory_iterator(root)) {
+        if (!dirEntry.is_regular_file()) continue;
+
+        const fs::path& file = dirEntry.path();
+        const std::string ext = LowerExtension(file);
+
+        CookedAsset asset;
+        asset.key = AssetPack::MakeKey(fs::relative(file, root).generic_string());
+
+        bool cooked = false;
+        if (ext == ".jpg" || ext == ".jpeg" || ext == ".png" || ext == ".bmp" || ext == ".tga") {
+            cooked = CookImage(file, asset);
+        }
+        else if (ext == ".wav" || ext == ".ogg" || ext == ".mp3" || ext == ".flac") {
+            cooked = CookSound(file, asset);
+        }
+        else if (ext == ".lua") {
+            cooked = CookScript(file, asset);
+        }
+        else {
+            continue;
+        }
+
+        if (!cooked) {
+            failed = true;
+            continue;
+        }
+        spdlog::info("asset_cooker: Cooked '{}' ({} bytes).", asset.key, asset.payload.size());
+        assets.push_back(std::move(asset));
+    }
+
+	// 2. Lay out the file: header, entry table, string table, then aligned payloads
+    std::string stringTable;
+    for (CookedAsset& asset : assets) {
+        asset.entry.nameOffset = static_cast<uint32_t>(stringTable.size());
+        asset.entry.nameLength = static_cast<uint32_t>(asset.key.size());
+        stringTable += asset.key;
+    }
+
+    PackHeader header{};
+    header.magic = PACK_MAGIC;
+    header.version = PACK_VERSION;
+    header.entryCount = static_cast<uint32_t>(assets.size());
+    header.stringTableSize = static_cast<uint32_t>(stringTable.size());
+
+    uint64_t offset = AlignUp(sizeof(PackHeader) + assets.size() * sizeof(PackEntry) + stringTable.size());
+    for (CookedAsset& asset : assets) {
+        asset.entry.dataOffset = offset;
+        asset.entry.dataSize = asset.payload.size();
+        offset = AlignUp(offset + asset.payload.size());
+    }
+
+	// 3. Write it out
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        spdlog::error("asset_cooker: Cannot open '{}' for writing.", output.string());
+        return 1;
+    }
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const CookedAsset& asset : assets) {
+        out.write(reinterpret_cast<const char*>(&asset.entry), sizeof(PackEntry));
+    }
+    out.write(stringTable.data(), stringTable.size());
+
+    for (const CookedAsset& asset : assets) {
+        const uint64_t pad = asset.entry.dataOffset - static_cast<uint64_t>(out.tellp());
+        static const char zeros[PACK_ALIGNMENT] = {};
+        out.write(zeros, static_cast<std::streamsize>(pad));
+        out.write(reinterpret_cast<const char*>(asset.payload.data()), asset.payload.size());
+    }
+
+    if (!out) {
+        spdlog::error("asset_cooker: Failed while writing '{}'.", output.string());
+        return 1;
+    }
+
+    spdlog::info("asset_cooker: Wrote {} assets to '{}' ({} bytes).", assets.size(), output.string(), offset);
+    return failed ? 1 : 0;
+}
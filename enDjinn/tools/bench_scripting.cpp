@@ -0,0 +1,235 @@
+// bench_scripting: measures what the Lua bindings registered by ScriptManager cost per call.
+// Usage: bench_scripting [calls] [path/to/ecs.lua]
+//
+// Every binding and ECS query pattern runs 'calls' times (2,000,000 by default) in a bare ScriptManager, with no
+// window and no audio device. Each line reports the time per call and the heap allocations per call, both Lua's
+// (through the state's allocator) and C++'s (through operator new). Benchmarks looped in Lua have the empty loop's
+// time subtracted. Configure one build with ENDJINN_SOL_SAFETIES ON and one with it OFF to see what sol2's
+// checks cost.
+
+#include "managers/ScriptManager.h"
+#include "spdlog/spdlog.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace enDjinn;
+
+namespace {
+
+    std::atomic<uint64_t> g_nativeAllocations{ 0 };
+    std::atomic<uint64_t> g_luaAllocations{ 0 };
+    lua_Alloc g_luaAlloc = nullptr;
+
+	// Forwards to the state's own allocator, counting every call that hands out new memory
+    void* CountingLuaAlloc(void* userData, void* ptr, size_t oldSize, size_t newSize) {
+        if (newSize > 0 && (!ptr || newSize > oldSize)) g_luaAllocations.fetch_add(1, std::memory_order_relaxed);
+        return g_luaAlloc(userData, ptr, oldSize, newSize);
+    }
+
+    constexpr int ENTITY_COUNT = 10000; // Every other entity also has a Velocity, for the two-component view
+
+    struct Measurement {
+        double ns = 0.0;
+        double luaAllocations = 0.0;
+        double nativeAllocations = 0.0;
+    };
+
+	// Runs 'run' once to warm up (interned strings, sol's metatables, ECS views), then times 'iterations' runs.
+	// Each run covers 'itemsPerRun' calls, so the results are per call.
+    Measurement Measure(uint64_t iterations, uint64_t itemsPerRun, const std::function<void(uint64_t)>& run) {
+        run(iterations / 10 + 1);
+
+        const uint64_t luaBefore = g_luaAllocations.load(std::memory_order_relaxed);
+        const uint64_t nativeBefore = g_nativeAllocations.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+        run(iterations);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+
+        const double calls = static_cast<double>(iterations * itemsPerRun);
+        Measurement result;
+        result.ns = std::chrono::duration<double, std::nano>(elapsed).count() / calls;
+        result.luaAllocations = (g_luaAllocations.load(std::memory_order_relaxed) - luaBefore) / calls;
+        result.nativeAllocations = (g_nativeAllocations.load(std::memory_order_relaxed) - nativeBefore) / calls;
+        return result;
+    }
+
+    void Report(const char* name, const Measurement& m) {
+        std::printf("%-56s %10.1f %12.3f %12.3f\n", name, m.ns, m.luaAllocations, m.nativeAllocations);
+    }
+
+	// A benchmark looped in Lua: 'setup' runs once, 'body' once per iteration. One iteration covers 'itemsPerRun'
+	// calls (entities, for the ForEach benchmarks).
+    struct LuaBenchmark {
+        const char* name;
+        const char* setup;
+        const char* body;
+        uint64_t itemsPerRun = 1;
+    };
+
+    bool RunLuaBenchmark(sol::state& lua, const LuaBenchmark& bench, uint64_t calls, double loopNs, Measurement* out = nullptr) {
+        const std::string source = std::string(bench.setup) +
+            "\nreturn function(n)\n    for i = 1, n do\n        " + bench.body + "\n    end\nend\n";
+        sol::load_result chunk = lua.load(source, bench.name);
+        if (!chunk.valid()) {
+            sol::error err = chunk;
+            spdlog::error("bench_scripting: '{}' does not compile: {}", bench.name, err.what());
+            return false;
+        }
+        sol::protected_function_result made = sol::protected_function(chunk)();
+        if (!made.valid()) {
+            sol::error err = made;
+            spdlog::error("bench_scripting: setup of '{}' failed: {}", bench.name, err.what());
+            return false;
+        }
+        sol::protected_function loop = made;
+
+        bool ok = true;
+        const uint64_t iterations = std::max<uint64_t>(1, calls / bench.itemsPerRun);
+        Measurement m = Measure(iterations, bench.itemsPerRun, [&](uint64_t n) {
+            sol::protected_function_result result = loop(n);
+            if (ok && !result.valid()) {
+                sol::error err = result;
+                spdlog::error("bench_scripting: '{}' failed: {}", bench.name, err.what());
+                ok = false;
+            }
+            });
+        m.ns = std::max(0.0, m.ns - loopNs / bench.itemsPerRun);
+        if (out) *out = m;
+        else Report(bench.name, m);
+        return ok;
+    }
+
+} // namespace
+
+// Counted so allocations made by sol and the bindings show up per call
+void* operator new(std::size_t size) {
+    g_nativeAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size ? size : 1)) return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+
+int main(int argc, char** argv) {
+    const uint64_t calls = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+    const std::string ecsPath = argc > 2 ? argv[2] : "engine/assets/scripts/ecs.lua";
+    if (calls == 0) {
+        spdlog::error("Usage: bench_scripting [calls] [path/to/ecs.lua]");
+        return 1;
+    }
+
+	// 1. A bare ScriptManager with the bindings under test. None of the managers needs a window or a device: the
+	// InputManager reports injected keys only, and PlaySound returns before touching SoLoud when it never started.
+    ScriptManager scriptManager;
+    scriptManager.Startup();
+    InputManager inputManager(nullptr);
+    ResourceManager resourceManager(nullptr);
+    SoundManager soundManager(resourceManager);
+    scriptManager.ExposeInputManager(&inputManager);
+    scriptManager.ExposeSoundManager(&soundManager);
+    inputManager.InjectKey(KeyCode::KEY_W, true); // IsKeyPressed takes its 'pressed' path
+
+    if (!scriptManager.LoadScript("ECS", ecsPath)) return 1;
+    sol::protected_function_result ecsResult = (*scriptManager.GetScript("ECS"))();
+    if (!ecsResult.valid()) {
+        sol::error err = ecsResult;
+        spdlog::error("bench_scripting: ECS script failed: {}", err.what());
+        return 1;
+    }
+
+	// 2. The world the ECS benchmarks query
+    sol::state& lua = scriptManager.GetLuaState();
+    lua["ENTITY_COUNT"] = ENTITY_COUNT;
+    lua.script(R"(
+        for i = 1, ENTITY_COUNT do
+            local e = ECS.CreateEntity()
+            local sprite = Sprite.new()
+            sprite.textureName = "bench_texture"
+            sprite.position = vec2.new(i, i)
+            sprite.z = i % 7
+            ECS.Components.Sprite[e] = sprite
+            if i % 2 == 0 then ECS.Components.Velocity[e] = { x = 1.0, y = 0.0 } end
+            BENCH_ENTITY = e
+        end
+    )");
+
+	// 3. From here on, count the Lua state's allocations too
+    void* allocData = nullptr;
+    g_luaAlloc = lua_getallocf(lua.lua_state(), &allocData);
+    lua_setallocf(lua.lua_state(), CountingLuaAlloc, allocData);
+
+    std::printf("enDjinn scripting benchmarks: %llu calls each, SOL_ALL_SAFETIES_ON=%d\n",
+        static_cast<unsigned long long>(calls), SOL_ALL_SAFETIES_ON);
+
+    Measurement loop;
+    if (!RunLuaBenchmark(lua, { "empty Lua loop", "", "" }, calls, 0.0, &loop)) return 1;
+    std::printf("empty Lua loop: %.2f ns per iteration, subtracted from the Lua-looped results\n\n", loop.ns);
+    std::printf("%-56s %10s %12s %12s\n", "benchmark", "ns/call", "lua allocs", "c++ allocs");
+
+	// 4. Bindings and ECS patterns driven from Lua
+    const std::vector<LuaBenchmark> luaBenchmarks = {
+        { "IsKeyPressed(KEYBOARD.W)", "", "IsKeyPressed(KEYBOARD.W)" },
+        { "IsKeyPressed(W), locals hoisted", "local IsKeyPressed, W = IsKeyPressed, KEYBOARD.W", "IsKeyPressed(W)" },
+        { "vec2.new(x, y)", "", "local v = vec2.new(i, i)" },
+        { "vec2 field read + write", "local v = vec2.new(0, 0)", "v.x = v.x + 1" },
+        { "vec3.new(x, y, z)", "", "local v = vec3.new(i, i, i)" },
+        { "vec3 field read + write", "local v = vec3.new(0, 0, 0)", "v.z = v.z + 1" },
+        { "Sprite.new()", "", "local s = Sprite.new()" },
+        { "Sprite.z read + write", "local s = Sprite.new()", "s.z = s.z + 1" },
+        { "Sprite.position.x write (member by reference)", "local s = Sprite.new()", "s.position.x = i" },
+        { "Sprite.position = vec2.new(x, y)", "local s = Sprite.new()", "s.position = vec2.new(i, i)" },
+        { "SoundManager_PlaySound(name), 4th overload",
+            "local name = 'bench_sound'", "SoundManager_PlaySound(name)" },
+        { "SoundManager_PlaySound(name, vol, pan, loop), 1st overload",
+            "local name = 'bench_sound'", "SoundManager_PlaySound(name, 1.0, 0.0, 0)" },
+        { "ECS.Components.Sprite[e] read, pool hoisted",
+            "local sprites, e = ECS.Components.Sprite, BENCH_ENTITY", "local s = sprites[e]" },
+        { "ECS.Components.Sprite[e].z write, full path",
+            "local e = BENCH_ENTITY", "ECS.Components.Sprite[e].z = i" },
+        { "ECS.ForEach({Sprite}), Lua callback, per entity",
+            "local q, visited = { 'Sprite' }, 0\nlocal function cb(e) visited = visited + 1 end",
+            "ECS.ForEach(q, cb)", ENTITY_COUNT },
+        { "ECS.ForEach({Sprite, Velocity}) view, per entity",
+            "local q, visited = { 'Sprite', 'Velocity' }, 0\nlocal function cb(e) visited = visited + 1 end",
+            "ECS.ForEach(q, cb)", ENTITY_COUNT / 2 },
+        { "ECS.ForEach({Sprite}) + component write, per entity",
+            "local q, sprites = { 'Sprite' }, ECS.Components.Sprite\nlocal function cb(e) local s = sprites[e]; s.z = s.z end",
+            "ECS.ForEach(q, cb)", ENTITY_COUNT },
+    };
+    for (const LuaBenchmark& bench : luaBenchmarks) {
+        if (!RunLuaBenchmark(lua, bench, calls, loop.ns)) return 1;
+    }
+
+	// 5. ECS.ForEach calling back into C++, the way the renderer and the script system query it
+    sol::protected_function ecsForEach = lua["ECS"]["ForEach"];
+    const sol::table& spriteQuery = scriptManager.GetComponentQuery("Sprite");
+    const uint64_t passes = std::max<uint64_t>(1, calls / ENTITY_COUNT);
+    uint64_t visited = 0;
+
+    Report("ECS.ForEach({Sprite}) into C++, handle only, per entity", Measure(passes, ENTITY_COUNT, [&](uint64_t n) {
+        for (uint64_t pass = 0; pass < n; ++pass) {
+            ecsForEach(spriteQuery, [&](EntityId) { ++visited; });
+        }
+        }));
+
+    Report("ECS.ForEach({Sprite}) into C++ + Sprite* lookup, per entity", Measure(passes, ENTITY_COUNT, [&](uint64_t n) {
+        for (uint64_t pass = 0; pass < n; ++pass) {
+            ecsForEach(spriteQuery, [&](EntityId entity) {
+                sol::optional<Sprite*> sprite = lua["ECS"]["Components"]["Sprite"][entity];
+                if (sprite && *sprite) ++visited;
+                });
+        }
+        }));
+
+    lua_setallocf(lua.lua_state(), g_luaAlloc, allocData);
+    spdlog::info("bench_scripting: done ({} C++ callbacks).", visited);
+    return 0;
+}